@@ -6,6 +6,9 @@
 // Variável externa (declarada no ast.h)
 Programa* raiz_ast = NULL;
 
+// Linha corrente do analisador léxico (Flex), registrada em cada nó
+extern int yylineno;
+
 // Macro auxiliar para alocação de memória e tratamento de erro
 #define ALLOC(type) (type*)safe_malloc(sizeof(type))
 
@@ -28,6 +31,8 @@ IdList* adiciona_id(IdList* lista, char* nome) {
     IdList *novo = ALLOC(IdList);
     novo->nome = strdup(nome);
     novo->prox = NULL;
+    novo->morta = 0;
+    novo->posicao = -1;
     
     if (lista == NULL) {
         return novo;
@@ -41,7 +46,26 @@ IdList* adiciona_id(IdList* lista, char* nome) {
     return lista;
 }
 
-static void idlist_free(IdList* lista) {
+Decl* empilha_decl(Decl* lista, Decl* novo) {
+    if (novo == NULL) {
+        return lista;
+    }
+    novo->prox = lista;
+    return novo;
+}
+
+Decl* inverte_decls(Decl* lista) {
+    Decl *invertida = NULL;
+    while (lista != NULL) {
+        Decl *prox = lista->prox;
+        lista->prox = invertida;
+        invertida = lista;
+        lista = prox;
+    }
+    return invertida;
+}
+
+void idlist_free(IdList* lista) {
     IdList *temp;
     while (lista != NULL) {
         temp = lista;
@@ -96,7 +120,7 @@ ParamDecl* adiciona_param_decl(ParamDecl* lista, ParamDecl* novo) {
     return lista;
 }
 
-static void paramdecl_free(ParamDecl* lista) {
+void paramdecl_free(ParamDecl* lista) {
     ParamDecl *temp;
     while (lista != NULL) {
         temp = lista;
@@ -122,6 +146,52 @@ Decl* adiciona_decl(Decl* lista, Decl* novo) {
     return lista;
 }
 
+// ======================================================================
+// HASH ESTRUTURAL
+// ======================================================================
+// Cada nó guarda, ao ser construído, um hash da sua subárvore (tipos,
+// operadores, constantes e nomes), usado como chave pelo cache de
+// compilação. As linhas entram só onde o código gerado as usa: a de cada
+// comando (cmd_linha) entra no hash do pai, relativa à do pai, e a do
+// corpo de uma sub-rotina relativa à da declaração; assim uma sub-rotina
+// tem o mesmo hash em qualquer posição do arquivo. O hash é o da árvore
+// vinda do parser: a reordenação das expressões não o atualiza.
+
+static uint64_t mistura(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+static uint64_t hash_nome(uint64_t h, const char* nome) {
+    uint64_t f = 0xcbf29ce484222325ull; // FNV-1a
+    for (; *nome; nome++) f = (f ^ (unsigned char)*nome) * 0x100000001b3ull;
+    return mistura(h, f);
+}
+
+static uint64_t hash_ids(uint64_t h, const IdList* ids) {
+    for (; ids != NULL; ids = ids->prox) h = hash_nome(h, ids->nome);
+    return mistura(h, 0xff);
+}
+
+static uint64_t hash_exprs(uint64_t h, const Expr* lista) {
+    for (; lista != NULL; lista = lista->prox) h = mistura(h, lista->hash);
+    return mistura(h, 0xff);
+}
+
+// Comando filho com a sua linha relativa à linha `base` do pai
+static uint64_t hash_filho(uint64_t h, const Comando* c, int base) {
+    if (c == NULL) return mistura(h, 0);
+    h = mistura(h, c->hash);
+    return mistura(h, (uint32_t)(cmd_linha(c) - base));
+}
+
+int cmd_linha(const Comando* c) {
+    if (c->tipo == CMD_IF) return c->u.cond.cond->linha;
+    if (c->tipo == CMD_WHILE) return c->u.loop.cond->linha;
+    return c->linha;
+}
+
 // ======================================================================
 // 1. CONSTRUTORES DE NÓS
 // ======================================================================
@@ -134,6 +204,9 @@ Expr* expr_num(int valor) {
     e->tipo_semantico = T_INT;
     e->u.ival = valor;
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = mistura(mistura(EXPR_NUM, 0), (uint32_t)valor);
     return e;
 }
 
@@ -143,6 +216,9 @@ Expr* expr_bool(int valor) {
     e->tipo_semantico = T_BOOL;
     e->u.ival = (valor != 0); // Armazena 1 para TRUE, 0 para FALSE
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = mistura(mistura(EXPR_BOOL, 0), e->u.ival);
     return e;
 }
 
@@ -152,6 +228,9 @@ Expr* expr_id(char* nome) {
     e->tipo_semantico = T_VOID; // Tipo inferido na análise semântica
     e->u.id = strdup(nome);
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = hash_nome(mistura(EXPR_VAR, 0), nome);
     return e;
 }
 
@@ -163,6 +242,9 @@ Expr* expr_bin(int op, Expr* esq, Expr* dir) {
     e->u.bin.esq = esq;
     e->u.bin.dir = dir;
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = mistura(mistura(mistura(mistura(EXPR_BIN, 0), op), esq->hash), dir->hash);
     return e;
 }
 
@@ -173,6 +255,9 @@ Expr* expr_un(int op, Expr* arg) {
     e->u.un.op = op;
     e->u.un.arg = arg;
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = mistura(mistura(mistura(EXPR_UN, 0), op), arg->hash);
     return e;
 }
 
@@ -183,6 +268,9 @@ Expr* expr_call_func(char* nome, Expr* args_lista) {
     e->u.func.nome = strdup(nome);
     e->u.func.args_lista = args_lista;
     e->prox = NULL;
+    e->original = NULL;
+    e->linha = yylineno;
+    e->hash = hash_exprs(hash_nome(mistura(EXPR_CALL_FUNC, 0), nome), args_lista);
     return e;
 }
 
@@ -194,6 +282,10 @@ Comando* cmd_atrib(char* nome_var, Expr* expr) {
     c->u.atrib.nome_var = strdup(nome_var);
     c->u.atrib.expr = expr;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = mistura(hash_nome(mistura(CMD_ATRIB, 1), nome_var), expr->hash);
     return c;
 }
 
@@ -204,6 +296,12 @@ Comando* cmd_if(Expr* cond, Comando* then_cmd, Comando* else_cmd) {
     c->u.cond.then_cmd = then_cmd;
     c->u.cond.else_cmd = else_cmd; // Pode ser NULL
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = mistura(mistura(CMD_IF, 1), cond->hash);
+    c->hash = hash_filho(c->hash, then_cmd, cond->linha);
+    c->hash = hash_filho(c->hash, else_cmd, cond->linha);
     return c;
 }
 
@@ -213,6 +311,10 @@ Comando* cmd_while(Expr* cond, Comando* body) {
     c->u.loop.cond = cond;
     c->u.loop.body = body;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = hash_filho(mistura(mistura(CMD_WHILE, 1), cond->hash), body, cond->linha);
     return c;
 }
 
@@ -222,6 +324,10 @@ Comando* cmd_read(IdList* lista_id) {
 
     c->u.leitura.lista_id = lista_id;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = hash_ids(mistura(CMD_READ, 1), lista_id);
     return c;
 }
 
@@ -230,6 +336,10 @@ Comando* cmd_write(Expr* lista_exp) {
     c->tipo = CMD_WRITE;
     c->u.escrita.lista_exp = lista_exp;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = hash_exprs(mistura(CMD_WRITE, 1), lista_exp);
     return c;
 }
 
@@ -239,6 +349,10 @@ Comando* cmd_call_proc(char* nome, Expr* args_lista) {
     c->u.proc_call.nome = strdup(nome);
     c->u.proc_call.args_lista = args_lista;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = hash_exprs(hash_nome(mistura(CMD_CALL_PROC, 1), nome), args_lista);
     return c;
 }
 
@@ -247,17 +361,35 @@ Comando* cmd_composto(Bloco* bloco) {
     c->tipo = CMD_COMPOSTO;
     c->u.composto = bloco;
     c->prox = NULL;
+    c->original = NULL;
+    c->copia = 0;
+    c->linha = yylineno;
+    c->hash = hash_filho(mistura(mistura(CMD_COMPOSTO, 1), bloco->hash), bloco->comandos, c->linha);
     return c;
 }
 
 // --------------------- DECLARAÇÕES (Decl) ---------------------
 
+// Cabeçalho, variáveis e comandos, com a linha do corpo relativa à da
+// declaração (as sub-rotinas aninhadas não entram: cada uma tem o seu)
+static uint64_t hash_subrotina(const Decl* d) {
+    uint64_t h = hash_nome(mistura(d->tipo, 2), d->u.subrot.nome);
+    h = mistura(h, d->u.subrot.tipo_retorno);
+    for (const ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox)
+        h = mistura(hash_ids(h, p->ids), p->tipo_param);
+    h = mistura(h, d->u.subrot.bloco->hash);
+    return hash_filho(h, d->u.subrot.bloco->comandos, d->linha);
+}
+
 Decl* decl_var(IdList* lista_id, TipoSemantico tipo) {
     Decl *d = ALLOC(Decl);
     d->tipo = DECL_VAR;
     d->u.var.ids = lista_id;
     d->u.var.tipo_var = tipo;
     d->prox = NULL;
+    d->linha = yylineno;
+    d->morta = d->memoizada = 0;
+    d->hash = mistura(hash_ids(mistura(DECL_VAR, 2), lista_id), tipo);
     return d;
 }
 
@@ -269,6 +401,9 @@ Decl* decl_procedure(char* nome, ParamDecl* params, Bloco* bloco) {
     d->u.subrot.bloco = bloco;
     d->u.subrot.tipo_retorno = T_VOID; // Procedimentos são sempre VOID
     d->prox = NULL;
+    d->linha = yylineno;
+    d->morta = d->memoizada = 0;
+    d->hash = hash_subrotina(d);
     return d;
 }
 
@@ -280,6 +415,9 @@ Decl* decl_function(char* nome, ParamDecl* params, TipoSemantico tipo_retorno, B
     d->u.subrot.bloco = bloco;
     d->u.subrot.tipo_retorno = tipo_retorno;
     d->prox = NULL;
+    d->linha = yylineno;
+    d->morta = d->memoizada = 0;
+    d->hash = hash_subrotina(d);
     return d;
 }
 
@@ -298,6 +436,13 @@ Bloco* criar_bloco(Decl* decls_var, Decl* decls_subrotinas, Comando* comandos) {
     b->decls_var = decls_var;
     b->decls_subrotinas = decls_subrotinas;
     b->comandos = comandos;
+    b->desenrolamento = 0;
+    b->subexpressoes = 0;
+
+    b->hash = mistura(0, 3);
+    for (const Decl *d = decls_var; d != NULL; d = d->prox) b->hash = mistura(b->hash, d->hash);
+    for (const Comando *c = comandos; c != NULL; c = c->prox)
+        b->hash = hash_filho(b->hash, c, cmd_linha(comandos));
     return b;
 }
 
@@ -317,16 +462,12 @@ Programa* criar_programa(char* nome, Bloco* bloco_principal) {
 // 2. FUNÇÕES DE LIBERAÇÃO DE MEMÓRIA
 // ======================================================================
 
-// Funções internas de liberação
-static void decl_free_internal(Decl* d);
-static void bloco_free(Bloco* b);
-
-
 void expr_free(Expr* e) {
     if (e == NULL) return;
     
     // Libera a lista encadeada (argumentos ou lista_exp)
     expr_free(e->prox);
+    expr_free(e->original);
     
     switch (e->tipo) {
         case EXPR_VAR:
@@ -361,6 +502,7 @@ void cmd_free(Comando* c) {
     
     // Libera o próximo comando na lista
     cmd_free(c->prox);
+    cmd_free(c->original);
     
     switch (c->tipo) {
         case CMD_ATRIB:
@@ -396,11 +538,11 @@ void cmd_free(Comando* c) {
     free(c);
 }
 
-static void decl_free_internal(Decl* d) {
+void decl_free(Decl* d) {
     if (d == NULL) return;
     
     // Libera a próxima declaração na lista
-    decl_free_internal(d->prox);
+    decl_free(d->prox);
     
     switch (d->tipo) {
         case DECL_VAR:
@@ -419,11 +561,11 @@ static void decl_free_internal(Decl* d) {
     free(d);
 }
 
-static void bloco_free(Bloco* b) {
+void bloco_free(Bloco* b) {
     if (b == NULL) return;
     
-    decl_free_internal(b->decls_var);
-    decl_free_internal(b->decls_subrotinas);
+    decl_free(b->decls_var);
+    decl_free(b->decls_subrotinas);
     cmd_free(b->comandos);
     
     free(b);
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 // ----------------------------------------------------------------------
 // 1. Tipos de Informação de Suporte (Semântica)
@@ -58,6 +59,9 @@ struct Expr {
         
     } u;
     Expr* prox; // Usado para encadear listas de argumentos (lista_exp)
+    int linha;  // Linha do código-fonte (mensagens de erro)
+    uint64_t hash; // Hash estrutural da subárvore (ver "HASH ESTRUTURAL" em ast.c)
+    Expr* original; // Constante da avaliação parcial: a chamada que ela substituiu
 };
 
 
@@ -69,6 +73,8 @@ struct Expr {
 typedef struct IdList {
     char* nome;
     struct IdList* prox;
+    int morta;  // Variável declarada que nunca é lida (eliminacao.h)
+    int posicao; // Local: posição compartilhada no registro (vivacidade.h); -1: a da declaração
 } IdList;
 
 struct ParamDecl {
@@ -110,6 +116,10 @@ struct Comando {
         
     } u;
     struct Comando* prox; // Para encadear na lista de comandos (comando_lista)
+    int linha;            // Linha do código-fonte (mensagens de erro)
+    uint64_t hash;        // Hash estrutural da subárvore
+    struct Comando* original; // Principal avaliado (avaliacao_parcial.h): os comandos substituídos
+    int copia;            // Composto repetido pelo desenrolamento: a análise não informa os erros (desenrolamento.h)
 };
 
 
@@ -126,6 +136,10 @@ typedef enum {
 struct Decl {
     TipoDecl tipo;
     Decl* prox; // Lista de declarações (var ou sub-rotinas)
+    int linha;  // Linha do código-fonte (mensagens de erro)
+    uint64_t hash; // Sub-rotinas: hash estrutural da declaração inteira
+    int morta;     // Sub-rotina inalcançável a partir do principal (eliminacao.h)
+    int memoizada; // Função com tabela de memoização na execução (memoizacao.h)
     
     union {
         struct { // DECL_VAR
@@ -151,6 +165,9 @@ struct Bloco {
     Decl* decls_var;
     Decl* decls_subrotinas;
     Comando* comandos; // Lista encadeada de comandos
+    uint64_t hash;     // Das variáveis e dos comandos (não das sub-rotinas)
+    int desenrolamento; // Fator dos laços transformados nos comandos (desenrolamento.h); 0: nenhum
+    uint64_t subexpressoes; // Marca das subexpressões reaproveitadas nos comandos (subexpressoes.h); 0: nenhuma
 };
 
 
@@ -194,6 +211,9 @@ Decl* decl_var(IdList* lista_id, TipoSemantico tipo);
 Decl* decl_procedure(char* nome, ParamDecl* params, Bloco* bloco);
 Decl* decl_function(char* nome, ParamDecl* params, TipoSemantico tipo_retorno, Bloco* bloco);
 Decl* adiciona_decl(Decl* lista, Decl* novo);
+// Para listas longas: empilha em O(1) e inverte uma vez ao final
+Decl* empilha_decl(Decl* lista, Decl* novo);
+Decl* inverte_decls(Decl* lista);
 
 // Sub-estruturas
 ParamDecl* param_decl(IdList* ids, TipoSemantico tipo);
@@ -203,9 +223,17 @@ Bloco* criar_bloco(Decl* decls_var, Decl* decls_subrotinas, Comando* comandos);
 // Raiz
 Programa* criar_programa(char* nome, Bloco* bloco_principal);
 
+// Linha a que o código de um comando é atribuído. O nó de if/while só é
+// criado ao fim do corpo, então vale a linha da condição.
+int cmd_linha(const Comando* c);
+
 // Funções de Liberação de Memória
 void expr_free(Expr* e);
 void cmd_free(Comando* c);
+void decl_free(Decl* d); // A lista inteira, a partir de d
+void idlist_free(IdList* lista);
+void paramdecl_free(ParamDecl* lista);
+void bloco_free(Bloco* b);
 void prog_free(Programa* p);
 void ast_free(Programa* raiz_ast);
 
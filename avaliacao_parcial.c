@@ -0,0 +1,471 @@
+#include "avaliacao_parcial.h"
+#include "parser.tab.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* av_malloc(size_t tam) {
+    void *ptr = calloc(1, tam > 0 ? tam : 1);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para a avaliação parcial");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static uint64_t mistura(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+// Símbolo de `nome` dentro de `s` (NULL: no programa principal)
+static Simbolo* resolve(TabelaSimbolos* ts, Simbolo* s, const char* nome) {
+    if (s != NULL) {
+        Simbolo *v = ts_busca_escopo(s->escopo, nome);
+        if (v != NULL) return v;
+    }
+    return ts_busca_escopo(ts->global, nome);
+}
+
+static Comando* corpo(const Simbolo* s) {
+    if (s->corpo != NULL) return s->corpo;
+    return s->decl != NULL ? s->decl->u.subrot.bloco->comandos : NULL;
+}
+
+// ======================================================================
+// PUREZA
+// ======================================================================
+
+static int e_subrotina(const Simbolo* v) {
+    return v->categoria == CAT_FUNCAO || v->categoria == CAT_PROCEDIMENTO;
+}
+
+// Chamada de `v` a partir de `s`; acumula em *h o hash da avaliação do
+// chamado
+static int chamada_pura(Simbolo* s, Simbolo* v, CategoriaSimbolo cat, uint64_t* h) {
+    if (v == NULL || v->categoria != cat) return 0;
+    if (v == s) return 1;
+    *h = mistura(*h, v->hash_avaliacao);
+    return v->pura;
+}
+
+static int pura_exprs(TabelaSimbolos* ts, Simbolo* s, const Expr* e, uint64_t* h) {
+    for (; e != NULL; e = e->prox) {
+        Simbolo *v;
+        switch (e->tipo) {
+            case EXPR_NUM:
+            case EXPR_BOOL:
+                break;
+            case EXPR_VAR:
+                v = resolve(ts, s, e->u.id);
+                if (v == NULL) return 0;
+                if (e_subrotina(v)) {
+                    if (v->num_params != 0 || !chamada_pura(s, v, CAT_FUNCAO, h)) return 0;
+                } else if (v->nivel != NIVEL_LOCAL) {
+                    return 0;
+                }
+                break;
+            case EXPR_CALL_FUNC:
+                if (!chamada_pura(s, resolve(ts, s, e->u.func.nome), CAT_FUNCAO, h)) return 0;
+                if (!pura_exprs(ts, s, e->u.func.args_lista, h)) return 0;
+                break;
+            case EXPR_BIN:
+                if (!pura_exprs(ts, s, e->u.bin.esq, h) || !pura_exprs(ts, s, e->u.bin.dir, h)) return 0;
+                break;
+            case EXPR_UN:
+                if (!pura_exprs(ts, s, e->u.un.arg, h)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+static int pura_cmds(TabelaSimbolos* ts, Simbolo* s, const Comando* c, uint64_t* h) {
+    for (; c != NULL; c = c->prox) {
+        Simbolo *v;
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                v = resolve(ts, s, c->u.atrib.nome_var);
+                if (v == NULL || (v != s && v->nivel != NIVEL_LOCAL)) return 0;
+                if (!pura_exprs(ts, s, c->u.atrib.expr, h)) return 0;
+                break;
+            case CMD_IF:
+                if (!pura_exprs(ts, s, c->u.cond.cond, h) || !pura_cmds(ts, s, c->u.cond.then_cmd, h)
+                    || !pura_cmds(ts, s, c->u.cond.else_cmd, h))
+                    return 0;
+                break;
+            case CMD_WHILE:
+                if (!pura_exprs(ts, s, c->u.loop.cond, h) || !pura_cmds(ts, s, c->u.loop.body, h)) return 0;
+                break;
+            case CMD_READ:
+            case CMD_WRITE:
+                return 0;
+            case CMD_CALL_PROC:
+                if (!chamada_pura(s, resolve(ts, s, c->u.proc_call.nome), CAT_PROCEDIMENTO, h)) return 0;
+                if (!pura_exprs(ts, s, c->u.proc_call.args_lista, h)) return 0;
+                break;
+            case CMD_COMPOSTO:
+                if (!pura_cmds(ts, s, c->u.composto->comandos, h)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+void avaliacao_declara(TabelaSimbolos* ts, Simbolo* s) {
+    const Bloco *b = s->decl->u.subrot.bloco;
+    uint64_t h = mistura(mistura(mistura(0, s->decl->hash), b->desenrolamento), b->subexpressoes);
+    s->pura = pura_cmds(ts, s, s->decl->u.subrot.bloco->comandos, &h);
+    s->hash_avaliacao = s->pura ? h : 0;
+}
+
+void avaliacao_guarda_corpo(Simbolo* s) {
+    if (!s->pura || s->decl == NULL || s->corpo != NULL) return;
+    s->corpo = s->decl->u.subrot.bloco->comandos;
+    s->decl->u.subrot.bloco->comandos = NULL;
+}
+
+// ======================================================================
+// INTERPRETADOR
+// ======================================================================
+
+typedef struct {
+    TabelaSimbolos* ts;
+    long combustivel;
+    int profundidade;
+
+    // Só no programa principal: as globais e o que foi escrito
+    int* globais;
+    char* globais_def;
+    int* escritas;
+    int num_escritas;
+} Avaliador;
+
+// Registro de uma sub-rotina em avaliação (s == NULL no principal)
+typedef struct {
+    Simbolo* s;
+    int* vals;      // Parâmetros, locais e, por último, o retorno
+    char* def;      // Posições já atribuídas
+} Quadro;
+
+static int avalia_expr(Avaliador* av, Quadro* q, const Expr* e, int* v);
+static int executa(Avaliador* av, Quadro* q, const Comando* c);
+
+// Posição de `v`, parâmetro ou local de q->s, no registro
+static int posicao(const Quadro* q, const Simbolo* v) {
+    int n = q->s->num_params;
+    return v->categoria == CAT_PARAMETRO ? v->deslocamento + n + 2 : n + v->deslocamento;
+}
+
+static int* variavel(Avaliador* av, Quadro* q, const Simbolo* v, char** def) {
+    if (v->categoria != CAT_VARIAVEL && v->categoria != CAT_PARAMETRO) return NULL;
+    if (v->nivel == NIVEL_LOCAL) {
+        if (q->s == NULL) return NULL;
+        int k = posicao(q, v);
+        *def = &q->def[k];
+        return &q->vals[k];
+    }
+    if (q->s != NULL || av->globais == NULL) return NULL;
+    *def = &av->globais_def[v->deslocamento];
+    return &av->globais[v->deslocamento];
+}
+
+static int chama(Avaliador* av, Quadro* q, Simbolo* s, const Expr* args, int* retorno) {
+    Comando *cmds = corpo(s);
+    if (!s->pura || cmds == NULL || --av->combustivel < 0) return 0;
+    if (av->profundidade >= AVALIACAO_MAX_PROFUNDIDADE) return 0;
+
+    int tam = s->num_params + s->num_locais + 1;
+    Quadro novo = { s, av_malloc(tam * sizeof(int)), av_malloc(tam) };
+    int n = 0, ok = 1;
+    for (const Expr *a = args; a != NULL && ok; a = a->prox, n++) {
+        if (n >= s->num_params) ok = 0;
+        else ok = avalia_expr(av, q, a, &novo.vals[n]);
+        if (ok) novo.def[n] = 1;
+    }
+    ok = ok && n == s->num_params;
+
+    if (ok) {
+        av->profundidade++;
+        ok = executa(av, &novo, cmds);
+        av->profundidade--;
+    }
+    if (ok && s->categoria == CAT_FUNCAO) {
+        ok = novo.def[tam - 1];
+        *retorno = novo.vals[tam - 1];
+    }
+    free(novo.vals);
+    free(novo.def);
+    return ok;
+}
+
+// A aritmética da MEPA é a de `int`, com estouro circular
+static int binario(int op, int a, int b, int* v) {
+    switch (op) {
+        case '+': *v = (int)((unsigned)a + (unsigned)b); return 1;
+        case '-': *v = (int)((unsigned)a - (unsigned)b); return 1;
+        case '*': *v = (int)((unsigned)a * (unsigned)b); return 1;
+        case DIV:
+            if (b == 0 || (a == INT_MIN && b == -1)) return 0;
+            *v = a / b;
+            return 1;
+        case AND: *v = a && b; return 1;
+        case OR: *v = a || b; return 1;
+        case IGUAL: *v = a == b; return 1;
+        case DIF: *v = a != b; return 1;
+        case MENOR: *v = a < b; return 1;
+        case MENOR_IGUAL: *v = a <= b; return 1;
+        case MAIOR: *v = a > b; return 1;
+        case MAIOR_IGUAL: *v = a >= b; return 1;
+        default: return 0;
+    }
+}
+
+static int avalia_expr(Avaliador* av, Quadro* q, const Expr* e, int* v) {
+    Simbolo *s;
+    int a, b;
+    char *def;
+    int *pos;
+
+    if (e->original != NULL) return avalia_expr(av, q, e->original, v);
+
+    switch (e->tipo) {
+        case EXPR_NUM:
+        case EXPR_BOOL:
+            *v = e->u.ival;
+            return 1;
+
+        case EXPR_VAR:
+            s = resolve(av->ts, q->s, e->u.id);
+            if (s == NULL) return 0;
+            if (s->categoria == CAT_FUNCAO) return chama(av, q, s, NULL, v);
+            pos = variavel(av, q, s, &def);
+            if (pos == NULL || !*def) return 0;
+            *v = *pos;
+            return 1;
+
+        case EXPR_CALL_FUNC:
+            s = resolve(av->ts, q->s, e->u.func.nome);
+            if (s == NULL || s->categoria != CAT_FUNCAO) return 0;
+            return chama(av, q, s, e->u.func.args_lista, v);
+
+        case EXPR_BIN:
+            // Os dois lados, sempre, como na MEPA
+            return avalia_expr(av, q, e->u.bin.esq, &a) && avalia_expr(av, q, e->u.bin.dir, &b)
+                   && binario(e->u.bin.op, a, b, v);
+
+        case EXPR_UN:
+            if (!avalia_expr(av, q, e->u.un.arg, &a)) return 0;
+            *v = e->u.un.op == NOT ? 1 - a : (int)(0u - (unsigned)a);
+            return 1;
+    }
+    return 0;
+}
+
+static int atribui(Avaliador* av, Quadro* q, const char* nome, int valor) {
+    Simbolo *s = resolve(av->ts, q->s, nome);
+    if (s == NULL) return 0;
+    if (s->morta) return 1;     // Variável eliminada: a atribuição não é feita
+    if (s->categoria == CAT_FUNCAO) {
+        if (s != q->s) return 0;
+        int k = s->num_params + s->num_locais;
+        q->vals[k] = valor;
+        q->def[k] = 1;
+        return 1;
+    }
+    char *def;
+    int *pos = variavel(av, q, s, &def);
+    if (pos == NULL) return 0;
+    *pos = valor;
+    *def = 1;
+    return 1;
+}
+
+static int executa(Avaliador* av, Quadro* q, const Comando* c) {
+    int v;
+    for (; c != NULL; c = c->prox) {
+        if (--av->combustivel < 0) return 0;
+
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                if (!avalia_expr(av, q, c->u.atrib.expr, &v) || !atribui(av, q, c->u.atrib.nome_var, v))
+                    return 0;
+                break;
+
+            case CMD_IF:
+                if (!avalia_expr(av, q, c->u.cond.cond, &v)) return 0;
+                if (!executa(av, q, v ? c->u.cond.then_cmd : c->u.cond.else_cmd)) return 0;
+                break;
+
+            case CMD_WHILE:
+                for (;;) {
+                    if (!avalia_expr(av, q, c->u.loop.cond, &v)) return 0;
+                    if (!v) break;
+                    if (!executa(av, q, c->u.loop.body) || --av->combustivel < 0) return 0;
+                }
+                break;
+
+            case CMD_READ:
+                return 0;
+
+            case CMD_WRITE:
+                if (q->s != NULL || av->escritas == NULL) return 0;
+                for (const Expr *e = c->u.escrita.lista_exp; e != NULL; e = e->prox) {
+                    if (av->num_escritas == AVALIACAO_MAX_ESCRITAS || !avalia_expr(av, q, e, &v)) return 0;
+                    av->escritas[av->num_escritas++] = v;
+                }
+                break;
+
+            case CMD_CALL_PROC: {
+                Simbolo *s = resolve(av->ts, q->s, c->u.proc_call.nome);
+                if (s == NULL || s->categoria != CAT_PROCEDIMENTO) return 0;
+                if (!chama(av, q, s, c->u.proc_call.args_lista, &v)) return 0;
+            } break;
+
+            case CMD_COMPOSTO:
+                if (!executa(av, q, c->u.composto->comandos)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+// ======================================================================
+// SUBSTITUIÇÃO
+// ======================================================================
+
+// Sem variáveis nem chamadas (as avaliáveis já foram substituídas)
+static int constante(const Expr* e) {
+    switch (e->tipo) {
+        case EXPR_NUM:
+        case EXPR_BOOL: return 1;
+        case EXPR_BIN: return constante(e->u.bin.esq) && constante(e->u.bin.dir);
+        case EXPR_UN: return constante(e->u.un.arg);
+        default: return 0;
+    }
+}
+
+// Avalia a chamada `e` de `f`, com argumentos constantes, e a troca pelo
+// resultado
+static int substitui(TabelaSimbolos* ts, Simbolo* f, Expr* e, const Expr* args) {
+    for (const Expr *a = args; a != NULL; a = a->prox)
+        if (!constante(a)) return 0;
+
+    Avaliador av = { .ts = ts, .combustivel = AVALIACAO_COMBUSTIVEL };
+    Quadro q = { NULL, NULL, NULL };
+    int v;
+    if (!chama(&av, &q, f, args, &v)) return 0;
+
+    Expr *original = av_malloc(sizeof(Expr));
+    *original = *e;
+    original->prox = NULL;
+    e->tipo = f->tipo == T_BOOL ? EXPR_BOOL : EXPR_NUM;
+    e->u.ival = v;
+    e->original = original;
+    return 1;
+}
+
+// ----------------------------------------------------------------------
+// Passe: as chamadas são trocadas no pos, depois dos argumentos
+// ----------------------------------------------------------------------
+
+struct AvaliacaoParcial {
+    TabelaSimbolos* ts;
+    Simbolo* subrot;        // NULL no principal
+    int substituicoes;
+};
+
+AvaliacaoParcial* avaliacao_cria(void) {
+    AvaliacaoParcial *av = av_malloc(sizeof(AvaliacaoParcial));
+    av->substituicoes = 0;
+    return av;
+}
+
+void avaliacao_libera(AvaliacaoParcial* av) {
+    free(av);
+}
+
+static void av_inicio(void* estado, TabelaSimbolos* ts, Simbolo* s) {
+    AvaliacaoParcial *av = estado;
+    av->ts = ts;
+    av->subrot = s;
+}
+
+static void av_pos_var(void* estado, Expr* e) {
+    AvaliacaoParcial *av = estado;
+    Simbolo *f = resolve(av->ts, av->subrot, e->u.id);
+    if (f != NULL && f->categoria == CAT_FUNCAO && f->pura && f->num_params == 0)
+        av->substituicoes += substitui(av->ts, f, e, NULL);
+}
+
+static void av_pos_chamada(void* estado, Expr* e) {
+    AvaliacaoParcial *av = estado;
+    Simbolo *f = resolve(av->ts, av->subrot, e->u.func.nome);
+    if (f != NULL && f->categoria == CAT_FUNCAO && f->pura)
+        av->substituicoes += substitui(av->ts, f, e, e->u.func.args_lista);
+}
+
+const Passe passe_avaliacao = {
+    .nome = "avaliação parcial",
+    .exige_sem_erros = 1,
+    .inicio = av_inicio,
+    .pos_expr = { [EXPR_VAR] = av_pos_var, [EXPR_CALL_FUNC] = av_pos_chamada },
+};
+
+static int dobra(TabelaSimbolos* ts, Simbolo* s, Comando* comandos) {
+    AvaliacaoParcial av = { .substituicoes = 0 };
+    Percurso p;
+    percurso_inicia(&p, PERCURSO_SEPARADO);
+    percurso_adiciona(&p, &passe_avaliacao, &av);
+    if (s != NULL)
+        percorre_subrotina(&p, ts, s);
+    else
+        percorre_principal(&p, ts, comandos);
+    return av.substituicoes;
+}
+
+int avalia_subrotina(TabelaSimbolos* ts, Simbolo* s) {
+    return dobra(ts, s, NULL);
+}
+
+// Executa o principal inteiro; se terminar, o primeiro comando vira a
+// escrita do que foi impresso e os comandos originais ficam pendurados nele
+int avaliacao_executa_principal(TabelaSimbolos* ts, Comando* comandos) {
+    if (comandos == NULL) return 0;
+    int num_globais = ts->global->prox_deslocamento;
+    Avaliador av = { .ts = ts, .combustivel = AVALIACAO_COMBUSTIVEL_PRINCIPAL };
+    av.globais = av_malloc(num_globais * sizeof(int));
+    av.globais_def = av_malloc(num_globais);
+    av.escritas = av_malloc(AVALIACAO_MAX_ESCRITAS * sizeof(int));
+    Quadro q = { NULL, NULL, NULL };
+
+    int ok = executa(&av, &q, comandos);
+    if (ok) {
+        Comando *original = av_malloc(sizeof(Comando));
+        *original = *comandos;
+
+        Expr *lista = NULL, *ultima = NULL;
+        for (int k = 0; k < av.num_escritas; k++) {
+            Expr *e = expr_num(av.escritas[k]);
+            e->linha = comandos->linha;
+            if (ultima) ultima->prox = e; else lista = e;
+            ultima = e;
+        }
+        comandos->tipo = CMD_WRITE;
+        comandos->u.escrita.lista_exp = lista;
+        comandos->prox = NULL;
+        comandos->original = original;
+    }
+    free(av.globais);
+    free(av.globais_def);
+    free(av.escritas);
+    return ok;
+}
+
+int avalia_principal(TabelaSimbolos* ts, Comando* comandos) {
+    if (comandos == NULL) return 0;
+    int n = dobra(ts, NULL, comandos);
+    return n + avaliacao_executa_principal(ts, comandos);
+}
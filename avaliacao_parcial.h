@@ -0,0 +1,65 @@
+#ifndef AVALIACAO_PARCIAL_H
+#define AVALIACAO_PARCIAL_H
+
+#include "ast.h"
+#include "tabela_simbolos.h"
+#include "percurso.h"
+
+// Avaliação parcial: chamadas de funções puras com argumentos constantes
+// (`dobro(20)`, `soma(3, 4)`) são interpretadas na AST durante a
+// compilação e substituídas pelo resultado. Uma sub-rotina é pura se não
+// tem read nem write, só atribui aos seus parâmetros, às suas locais e ao
+// próprio retorno, não lê globais e só chama sub-rotinas puras (ou a si
+// mesma); isso é decidido na declaração, sem depender da análise do corpo.
+//
+// Cada avaliação tem um combustível (comandos executados e chamadas
+// feitas); se acabar, se a recursão for funda demais ou se a execução
+// falharia (divisão por zero, variável lida antes de atribuída), a chamada
+// fica como está e é feita em tempo de execução. O resultado é o da MEPA,
+// inclusive no estouro de inteiros.
+//
+// A constante que substitui uma chamada guarda a chamada em `original`: o
+// cache de compilação tira dela as dependências (o corpo das funções
+// avaliadas), e o próprio avaliador interpreta `original` em vez da
+// constante, para que o custo de uma chamada, e portanto o que cabe no
+// combustível, não dependa de o corpo do chamado já ter sido avaliado
+// (ele pode vir do cache sem passar por aqui).
+//
+// Se o programa principal não lê nada e só chama sub-rotinas puras, ele é
+// executado inteiro e, se terminar dentro do combustível, vira uma só
+// escrita das constantes que imprimiria.
+
+#define AVALIACAO_COMBUSTIVEL (1 << 16)             // Por chamada substituída
+#define AVALIACAO_COMBUSTIVEL_PRINCIPAL (1 << 20)   // Para o programa principal
+#define AVALIACAO_MAX_PROFUNDIDADE 1000             // Chamadas aninhadas
+#define AVALIACAO_MAX_ESCRITAS 4096                 // Constantes do principal avaliado
+
+// Decide se a sub-rotina `s`, recém-declarada (s->decl válida), é pura e
+// calcula s->hash_avaliacao. As sub-rotinas anteriores já foram declaradas.
+void avaliacao_declara(TabelaSimbolos* ts, Simbolo* s);
+
+// Substitui as chamadas avaliáveis do corpo de `s`, já analisado sem
+// erros; retorna o número de substituições
+int avalia_subrotina(TabelaSimbolos* ts, Simbolo* s);
+
+// O mesmo nos comandos do programa principal, que podem virar uma só
+// escrita (o primeiro comando é reescrito no lugar; os demais passam a ser
+// o seu `original`)
+int avalia_principal(TabelaSimbolos* ts, Comando* comandos);
+
+// As substituições como passe de um percurso (percurso.h), fundido à
+// análise; no principal a execução inteira vem depois, à parte, já com
+// as chamadas substituídas: avalia_principal é o percurso seguido de
+// avaliacao_executa_principal (retorna 1 se o principal virou escrita)
+typedef struct AvaliacaoParcial AvaliacaoParcial;
+
+extern const Passe passe_avaliacao;
+AvaliacaoParcial* avaliacao_cria(void);
+void avaliacao_libera(AvaliacaoParcial* av);
+int avaliacao_executa_principal(TabelaSimbolos* ts, Comando* comandos);
+
+// Ao fim da compilação de `s`: se pura, os comandos passam da declaração
+// (que pode ser liberada) ao símbolo, para as avaliações seguintes
+void avaliacao_guarda_corpo(Simbolo* s);
+
+#endif
@@ -0,0 +1,589 @@
+#include "cache_compilacao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#define CACHE_MAGICO "RASCACHE"
+#define CACHE_VERSAO 7
+#define SEM_LINHA INT_MIN   // Instrução sem linha do fonte
+
+typedef struct {
+    int op, a, b, c;
+    int rotulo;     // Relativo ao primeiro rótulo do fragmento (-1 se nenhum)
+    int linha;      // Relativa à linha base (SEM_LINHA se desconhecida)
+    int externo;    // Índice em externos[] se `a` é a entrada de outra sub-rotina
+} InstrCache;
+
+struct FragmentoCache {
+    ChaveCache chave;
+    int num_instrs;
+    int num_rotulos;
+    int info[CACHE_NUM_INFO];
+    double tempo;           // Tempo da geração original (s)
+    int num_externos;
+    char** externos;        // Nomes das sub-rotinas chamadas
+    int num_deps;
+    char** deps;            // Nomes não locais referenciados no corpo
+    uint64_t hash_deps;     // Das assinaturas de deps[] (assinatura())
+    InstrCache* instrs;
+    int usado;              // Reaproveitado ou criado nesta compilação
+};
+
+struct CacheCompilacao {
+    FragmentoCache** frags;
+    int num_frags;
+    int cap_frags;
+    int* tabela;            // Endereçamento aberto: índice em frags ou -1
+    int cap_tabela;
+    int alterado;           // Algum fragmento guardado desde a carga
+    EstatisticasCache est;
+};
+
+static void* cache_malloc(size_t tam) {
+    void *ptr = calloc(1, tam > 0 ? tam : 1);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o cache de compilação");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// ======================================================================
+// CHAVES E DEPENDÊNCIAS
+// ======================================================================
+
+static uint64_t mistura(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+ChaveCache cache_chave(const Simbolo* s, const Bloco* principal, int num_globais, int modo) {
+    ChaveCache h = mistura(mistura(CACHE_VERSAO, modo), s != NULL);
+    if (s == NULL)
+        return mistura(mistura(mistura(mistura(h, principal->comandos->hash), num_globais), principal->desenrolamento),
+                       principal->subexpressoes);
+
+    // O hash estrutural não vê as posições das locais, que dependem da
+    // eliminação e do compartilhamento (eliminacao.h, vivacidade.h), nem
+    // a memoização (memoizacao.h), o desenrolamento (desenrolamento.h) e o
+    // reaproveitamento de subexpressões (subexpressoes.h)
+    h = mistura(mistura(h, s->decl->hash), s->decl->memoizada);
+    h = mistura(mistura(h, s->decl->u.subrot.bloco->desenrolamento), s->decl->u.subrot.bloco->subexpressoes);
+    for (const Decl *d = s->decl->u.subrot.bloco->decls_var; d != NULL; d = d->prox)
+        for (const IdList *id = d->u.var.ids; id != NULL; id = id->prox)
+            h = mistura(mistura(h, id->morta), id->posicao);
+    return h;
+}
+
+// Assinatura do que a análise semântica e o gerador usam de uma global ou
+// sub-rotina referenciada. Como a busca é feita na ordem do programa, um
+// nome declarado mais adiante ainda não existe aqui, assim como na análise.
+static uint64_t assinatura(const Simbolo* s, const Simbolo* subrot) {
+    if (s == NULL) return 1;
+    if (s == subrot) return 2;
+
+    uint64_t h = mistura(mistura(3, s->categoria), s->tipo);
+    h = mistura(mistura(h, s->deslocamento), s->num_params);
+    for (int k = 0; k < s->num_params; k++) h = mistura(h, s->tipos_params[k]);
+    h = mistura(mistura(h, s->num_locais), s->pilha_max);
+    return mistura(h, s->pilha_total);
+}
+
+// "=nome": uma chamada avaliada na compilação (avaliacao_parcial.h), que
+// depende do corpo do chamado e não só da sua assinatura
+static uint64_t assinatura_avaliacao(const Simbolo* s) {
+    return s == NULL ? 1 : mistura(4, s->hash_avaliacao);
+}
+
+static uint64_t hash_dependencias(TabelaSimbolos* ts, const Simbolo* subrot, char* const* nomes, int n) {
+    uint64_t h = mistura(0, n);
+    for (int k = 0; k < n; k++) {
+        if (nomes[k][0] == '=')
+            h = mistura(h, assinatura_avaliacao(ts_busca_escopo(ts->global, nomes[k] + 1)));
+        else
+            h = mistura(h, assinatura(ts_busca_escopo(ts->global, nomes[k]), subrot));
+    }
+    return h;
+}
+
+// Nomes não locais referenciados no corpo, sem repetição
+typedef struct {
+    TabelaSimbolos* ts;
+    char** nomes;
+    int num, cap;
+    int avaliado;           // Dentro do `original` de uma avaliação parcial
+} Coleta;
+
+static void coleta_nome(Coleta* col, const char* nome) {
+    Simbolo *s = ts_busca(col->ts, nome);
+    if (s != NULL && s->nivel == NIVEL_LOCAL) return;
+
+    // O que foi avaliado só depende dos corpos das sub-rotinas chamadas
+    int avaliado = col->avaliado;
+    if (avaliado && (s == NULL || (s->categoria != CAT_FUNCAO && s->categoria != CAT_PROCEDIMENTO))) return;
+    for (int k = 0; k < col->num; k++)
+        if ((col->nomes[k][0] == '=') == avaliado && strcmp(col->nomes[k] + avaliado, nome) == 0) return;
+
+    if (col->num == col->cap) {
+        col->cap = col->cap ? 2 * col->cap : 16;
+        col->nomes = realloc(col->nomes, col->cap * sizeof(char*));
+        if (col->nomes == NULL) {
+            perror("Erro ao alocar memória para o cache de compilação");
+            exit(EXIT_FAILURE);
+        }
+    }
+    char *copia = cache_malloc(strlen(nome) + 2);
+    copia[0] = '=';
+    strcpy(copia + avaliado, nome);
+    col->nomes[col->num++] = copia;
+}
+
+static void coleta_expr(Coleta* col, const Expr* e) {
+    for (; e != NULL; e = e->prox) {
+        if (e->original != NULL) {
+            int avaliado = col->avaliado;
+            col->avaliado = 1;
+            coleta_expr(col, e->original);
+            col->avaliado = avaliado;
+            continue;
+        }
+        switch (e->tipo) {
+            case EXPR_VAR:
+                coleta_nome(col, e->u.id);
+                break;
+            case EXPR_CALL_FUNC:
+                coleta_nome(col, e->u.func.nome);
+                coleta_expr(col, e->u.func.args_lista);
+                break;
+            case EXPR_BIN:
+                coleta_expr(col, e->u.bin.esq);
+                coleta_expr(col, e->u.bin.dir);
+                break;
+            case EXPR_UN:
+                coleta_expr(col, e->u.un.arg);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void coleta_cmds(Coleta* col, const Comando* c) {
+    for (; c != NULL; c = c->prox) {
+        if (c->original != NULL) {
+            int avaliado = col->avaliado;
+            col->avaliado = 1;
+            coleta_cmds(col, c->original);
+            col->avaliado = avaliado;
+        }
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                coleta_nome(col, c->u.atrib.nome_var);
+                coleta_expr(col, c->u.atrib.expr);
+                break;
+            case CMD_IF:
+                coleta_expr(col, c->u.cond.cond);
+                coleta_cmds(col, c->u.cond.then_cmd);
+                coleta_cmds(col, c->u.cond.else_cmd);
+                break;
+            case CMD_WHILE:
+                coleta_expr(col, c->u.loop.cond);
+                coleta_cmds(col, c->u.loop.body);
+                break;
+            case CMD_READ:
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    coleta_nome(col, id->nome);
+                break;
+            case CMD_WRITE:
+                coleta_expr(col, c->u.escrita.lista_exp);
+                break;
+            case CMD_CALL_PROC:
+                coleta_nome(col, c->u.proc_call.nome);
+                coleta_expr(col, c->u.proc_call.args_lista);
+                break;
+            case CMD_COMPOSTO:
+                coleta_cmds(col, c->u.composto->comandos);
+                break;
+        }
+    }
+}
+
+// ======================================================================
+// TABELA
+// ======================================================================
+
+static int posicao(const CacheCompilacao* cache, ChaveCache chave) {
+    int k = (int)(chave % (uint64_t)cache->cap_tabela);
+    while (cache->tabela[k] >= 0) {
+        const FragmentoCache *f = cache->frags[cache->tabela[k]];
+        if (f->chave == chave) break;
+        k = (k + 1) % cache->cap_tabela;
+    }
+    return k;
+}
+
+static void reconstroi_tabela(CacheCompilacao* cache, int cap) {
+    free(cache->tabela);
+    cache->cap_tabela = cap;
+    cache->tabela = cache_malloc(cap * sizeof(int));
+    for (int k = 0; k < cap; k++) cache->tabela[k] = -1;
+    for (int n = 0; n < cache->num_frags; n++)
+        cache->tabela[posicao(cache, cache->frags[n]->chave)] = n;
+}
+
+static void insere(CacheCompilacao* cache, FragmentoCache* f) {
+    if (cache->num_frags == cache->cap_frags) {
+        cache->cap_frags = cache->cap_frags ? 2 * cache->cap_frags : 64;
+        cache->frags = realloc(cache->frags, cache->cap_frags * sizeof(FragmentoCache*));
+        if (cache->frags == NULL) {
+            perror("Erro ao alocar memória para o cache de compilação");
+            exit(EXIT_FAILURE);
+        }
+    }
+    cache->frags[cache->num_frags++] = f;
+
+    // Ocupação máxima de 1/2
+    if (2 * cache->num_frags > cache->cap_tabela)
+        reconstroi_tabela(cache, cache->cap_tabela ? 2 * cache->cap_tabela : 128);
+    else
+        cache->tabela[posicao(cache, f->chave)] = cache->num_frags - 1;
+}
+
+static void fragmento_libera(FragmentoCache* f) {
+    for (int k = 0; k < f->num_externos; k++) free(f->externos[k]);
+    free(f->externos);
+    for (int k = 0; k < f->num_deps; k++) free(f->deps[k]);
+    free(f->deps);
+    free(f->instrs);
+    free(f);
+}
+
+const FragmentoCache* cache_busca(CacheCompilacao* cache, ChaveCache chave, TabelaSimbolos* ts,
+                                  const Simbolo* s) {
+    double inicio = agora();
+    int n = cache->tabela[posicao(cache, chave)];
+    if (n >= 0) {
+        const FragmentoCache *f = cache->frags[n];
+        if (hash_dependencias(ts, s, f->deps, f->num_deps) != f->hash_deps) n = -1;
+    }
+    cache->est.tempo_cache += agora() - inicio;
+
+    if (n < 0) {
+        cache->est.falhas++;
+        return NULL;
+    }
+    cache->est.acertos++;
+    cache->est.tempo_economizado += cache->frags[n]->tempo;
+    return cache->frags[n];
+}
+
+// ======================================================================
+// FRAGMENTOS
+// ======================================================================
+
+int cache_reaproveita(CacheCompilacao* cache, const FragmentoCache* f, CodigoMepa* c,
+                      TabelaSimbolos* ts, int r_ini, int linha_base, int info[CACHE_NUM_INFO]) {
+    double inicio = agora();
+
+    // Os rótulos são alocados na mesma ordem da geração original
+    while (c->num_rotulos < r_ini + f->num_rotulos) mepa_novo_rotulo(c);
+
+    for (int k = 0; k < f->num_instrs; k++) {
+        const InstrCache *fi = &f->instrs[k];
+        int a = fi->a;
+        if (fi->externo >= 0)
+            a = ts_busca_escopo(ts->global, f->externos[fi->externo])->rotulo;
+        else if (mepa_op_usa_rotulo(fi->op))
+            a += r_ini;
+
+        int idx = mepa_emite(c, fi->op, a, fi->b);
+        InstrMepa *i = &c->instrs[idx];
+        i->c = fi->c;
+        i->rotulo = fi->rotulo >= 0 ? r_ini + fi->rotulo : -1;
+        i->linha = fi->linha != SEM_LINHA ? linha_base + fi->linha : 0;
+    }
+
+    for (int k = 0; k < CACHE_NUM_INFO; k++) info[k] = f->info[k];
+    ((FragmentoCache*)f)->usado = 1;
+    cache->est.tempo_cache += agora() - inicio;
+    return f->num_instrs;
+}
+
+DependenciasCache* cache_dependencias(CacheCompilacao* cache, TabelaSimbolos* ts, Simbolo* s,
+                                     const Comando* principal) {
+    double inicio = agora();
+    Coleta col = { ts, NULL, 0, 0, 0 };
+    if (s != NULL) {
+        ts_abre_local(ts, s);
+        coleta_cmds(&col, s->decl->u.subrot.bloco->comandos);
+        ts_fecha_local(ts);
+    } else {
+        coleta_cmds(&col, principal);
+    }
+
+    DependenciasCache *deps = cache_malloc(sizeof(DependenciasCache));
+    deps->nomes = col.nomes;
+    deps->num = col.num;
+    deps->hash = hash_dependencias(ts, s, deps->nomes, deps->num);
+    cache->est.tempo_cache += agora() - inicio;
+    return deps;
+}
+
+void cache_dependencias_libera(DependenciasCache* deps) {
+    if (deps == NULL) return;
+    for (int k = 0; k < deps->num; k++) free(deps->nomes[k]);
+    free(deps->nomes);
+    free(deps);
+}
+
+void cache_guarda(CacheCompilacao* cache, ChaveCache chave, DependenciasCache* deps, const CodigoMepa* c,
+                  int ini, int fim, int r_ini, int r_fim, int linha_base, const int info[CACHE_NUM_INFO],
+                  double tempo) {
+    double inicio = agora();
+    FragmentoCache *f = cache_malloc(sizeof(FragmentoCache));
+    f->chave = chave;
+    f->num_instrs = fim - ini;
+    f->num_rotulos = r_fim - r_ini;
+    for (int k = 0; k < CACHE_NUM_INFO; k++) f->info[k] = info[k];
+    f->tempo = tempo;
+    f->instrs = cache_malloc(f->num_instrs * sizeof(InstrCache));
+    f->externos = cache_malloc(f->num_instrs * sizeof(char*));
+    f->usado = 1;
+
+    for (int k = 0; k < f->num_instrs; k++) {
+        const InstrMepa *i = &c->instrs[ini + k];
+        InstrCache *fi = &f->instrs[k];
+        fi->op = i->op;
+        fi->a = i->a;
+        fi->b = i->b;
+        fi->c = i->c;
+        fi->rotulo = i->rotulo >= 0 ? i->rotulo - r_ini : -1;
+        fi->linha = i->linha > 0 ? i->linha - linha_base : SEM_LINHA;
+        fi->externo = -1;
+
+        if (!mepa_op_usa_rotulo(i->op)) continue;
+        if (i->a >= r_ini && i->a < r_fim) {
+            fi->a = i->a - r_ini;
+            continue;
+        }
+
+        // Chamada: guarda o nome do chamado (os rótulos de entrada são nomeados)
+        const char *nome = mepa_nome_rotulo(c, i->a);
+        if (nome == NULL) {
+            fragmento_libera(f);
+            cache_dependencias_libera(deps);
+            cache->est.tempo_cache += agora() - inicio;
+            return;
+        }
+        int e;
+        for (e = 0; e < f->num_externos && strcmp(f->externos[e], nome) != 0; e++) { }
+        if (e == f->num_externos) f->externos[f->num_externos++] = strdup(nome);
+        fi->externo = e;
+    }
+
+    f->deps = deps->nomes;
+    f->num_deps = deps->num;
+    f->hash_deps = deps->hash;
+    free(deps);
+
+    cache->alterado = 1;
+
+    // Mesma chave com dependências diferentes: o novo substitui o antigo
+    int n = cache->tabela[posicao(cache, chave)];
+    if (n >= 0) {
+        fragmento_libera(cache->frags[n]);
+        cache->frags[n] = f;
+    } else {
+        insere(cache, f);
+    }
+    cache->est.tempo_cache += agora() - inicio;
+}
+
+// ======================================================================
+// ARQUIVO
+// ======================================================================
+
+static int le_int(FILE* f, int* v) {
+    return fread(v, sizeof(int), 1, f) == 1;
+}
+
+// Lista de `n` nomes, cada um precedido do tamanho; retorna 0 em erro
+static int le_nomes(FILE* f, char** nomes, int n) {
+    int ok = 1;
+    for (int k = 0; k < n; k++) {
+        int tam;
+        if (!le_int(f, &tam) || tam < 0 || tam > 4096) ok = 0;
+        nomes[k] = cache_malloc(ok ? tam + 1 : 1);
+        if (ok && fread(nomes[k], 1, tam, f) != (size_t)tam) ok = 0;
+    }
+    return ok;
+}
+
+static void grava_nomes(FILE* f, char* const* nomes, int n) {
+    for (int k = 0; k < n; k++) {
+        int tam = (int)strlen(nomes[k]);
+        fwrite(&tam, sizeof(int), 1, f);
+        fwrite(nomes[k], 1, tam, f);
+    }
+}
+
+static FragmentoCache* le_fragmento(FILE* f) {
+    FragmentoCache *fr = cache_malloc(sizeof(FragmentoCache));
+    int ok = fread(&fr->chave, sizeof(ChaveCache), 1, f) == 1
+          && le_int(f, &fr->num_instrs) && fr->num_instrs >= 0 && fr->num_instrs < (1 << 26)
+          && le_int(f, &fr->num_rotulos) && fr->num_rotulos >= 0
+          && fread(fr->info, sizeof(int), CACHE_NUM_INFO, f) == CACHE_NUM_INFO
+          && fread(&fr->tempo, sizeof(double), 1, f) == 1
+          && le_int(f, &fr->num_externos) && fr->num_externos >= 0 && fr->num_externos <= fr->num_instrs
+          && le_int(f, &fr->num_deps) && fr->num_deps >= 0 && fr->num_deps < (1 << 20)
+          && fread(&fr->hash_deps, sizeof(uint64_t), 1, f) == 1;
+    if (!ok) {
+        free(fr);
+        return NULL;
+    }
+
+    fr->externos = cache_malloc(fr->num_externos * sizeof(char*));
+    fr->deps = cache_malloc(fr->num_deps * sizeof(char*));
+    fr->instrs = cache_malloc(fr->num_instrs * sizeof(InstrCache));
+    ok = le_nomes(f, fr->externos, fr->num_externos) && le_nomes(f, fr->deps, fr->num_deps);
+    if (ok && fread(fr->instrs, sizeof(InstrCache), fr->num_instrs, f) != (size_t)fr->num_instrs) ok = 0;
+
+    for (int k = 0; ok && k < fr->num_instrs; k++) {
+        const InstrCache *i = &fr->instrs[k];
+        if (i->op < 0 || i->op >= MEPA_NUM_OPS || i->rotulo >= fr->num_rotulos
+            || i->externo < -1 || i->externo >= fr->num_externos)
+            ok = 0;
+        else if (i->externo >= 0 && !mepa_op_usa_rotulo(i->op))
+            ok = 0;
+        else if (mepa_op_usa_rotulo(i->op) && i->externo < 0 && (i->a < 0 || i->a >= fr->num_rotulos))
+            ok = 0;
+    }
+    if (!ok) {
+        fragmento_libera(fr);
+        return NULL;
+    }
+    return fr;
+}
+
+static void carrega(CacheCompilacao* cache, const char* arquivo) {
+    FILE *f = fopen(arquivo, "rb");
+    if (f == NULL) return;
+
+    char magico[sizeof(CACHE_MAGICO)] = { 0 };
+    int versao, num;
+    if (fread(magico, 1, strlen(CACHE_MAGICO), f) != strlen(CACHE_MAGICO) || strcmp(magico, CACHE_MAGICO) != 0
+        || !le_int(f, &versao) || versao != CACHE_VERSAO || !le_int(f, &num) || num < 0) {
+        fprintf(stderr, "ALERTA: cache de compilação '%s' inválido; ignorado\n", arquivo);
+        fclose(f);
+        return;
+    }
+
+    for (int n = 0; n < num; n++) {
+        FragmentoCache *fr = le_fragmento(f);
+        if (fr == NULL) {
+            fprintf(stderr, "ALERTA: cache de compilação '%s' truncado; lidos %d de %d fragmentos\n",
+                    arquivo, n, num);
+            break;
+        }
+        insere(cache, fr);
+    }
+    fclose(f);
+}
+
+CacheCompilacao* cache_abre(const char* arquivo) {
+    double inicio = agora();
+    CacheCompilacao *cache = cache_malloc(sizeof(CacheCompilacao));
+    reconstroi_tabela(cache, 128);
+    if (arquivo != NULL) carrega(cache, arquivo);
+    cache->est.tempo_cache += agora() - inicio;
+    return cache;
+}
+
+static int grava(CacheCompilacao* cache, const char* arquivo) {
+    FILE *f = fopen(arquivo, "wb");
+    if (f == NULL) {
+        perror("Erro ao gravar o cache de compilação");
+        return 1;
+    }
+
+    int versao = CACHE_VERSAO, num = 0;
+    for (int n = 0; n < cache->num_frags; n++) num += cache->frags[n]->usado;
+
+    fwrite(CACHE_MAGICO, 1, strlen(CACHE_MAGICO), f);
+    fwrite(&versao, sizeof(int), 1, f);
+    fwrite(&num, sizeof(int), 1, f);
+
+    for (int n = 0; n < cache->num_frags; n++) {
+        const FragmentoCache *fr = cache->frags[n];
+        if (!fr->usado) continue;
+        fwrite(&fr->chave, sizeof(ChaveCache), 1, f);
+        fwrite(&fr->num_instrs, sizeof(int), 1, f);
+        fwrite(&fr->num_rotulos, sizeof(int), 1, f);
+        fwrite(fr->info, sizeof(int), CACHE_NUM_INFO, f);
+        fwrite(&fr->tempo, sizeof(double), 1, f);
+        fwrite(&fr->num_externos, sizeof(int), 1, f);
+        fwrite(&fr->num_deps, sizeof(int), 1, f);
+        fwrite(&fr->hash_deps, sizeof(uint64_t), 1, f);
+        grava_nomes(f, fr->externos, fr->num_externos);
+        grava_nomes(f, fr->deps, fr->num_deps);
+        fwrite(fr->instrs, sizeof(InstrCache), fr->num_instrs, f);
+    }
+
+    if (fclose(f) != 0) {
+        perror("Erro ao gravar o cache de compilação");
+        return 1;
+    }
+    return 0;
+}
+
+int cache_grava(CacheCompilacao* cache, const char* arquivo) {
+    // Sem fragmentos novos nem descartados o arquivo ficaria igual
+    int descartados = 0;
+    for (int n = 0; n < cache->num_frags; n++) descartados += !cache->frags[n]->usado;
+    if (!cache->alterado && descartados == 0) return 0;
+
+    double inicio = agora();
+    int r = grava(cache, arquivo);
+    cache->est.tempo_cache += agora() - inicio;
+    return r;
+}
+
+void cache_recomeca(CacheCompilacao* cache, int descarta) {
+    if (descarta) {
+        int m = 0;
+        for (int n = 0; n < cache->num_frags; n++) {
+            if (cache->frags[n]->usado)
+                cache->frags[m++] = cache->frags[n];
+            else
+                fragmento_libera(cache->frags[n]);
+        }
+        if (m < cache->num_frags) {
+            cache->num_frags = m;
+            reconstroi_tabela(cache, cache->cap_tabela);
+        }
+    }
+    for (int n = 0; n < cache->num_frags; n++) cache->frags[n]->usado = 0;
+    cache->alterado = 0;
+    memset(&cache->est, 0, sizeof(cache->est));
+}
+
+void cache_libera(CacheCompilacao* cache) {
+    if (cache == NULL) return;
+    for (int n = 0; n < cache->num_frags; n++) fragmento_libera(cache->frags[n]);
+    free(cache->frags);
+    free(cache->tabela);
+    free(cache);
+}
+
+const EstatisticasCache* cache_estatisticas(const CacheCompilacao* cache) {
+    return &cache->est;
+}
@@ -0,0 +1,97 @@
+#ifndef CACHE_COMPILACAO_H
+#define CACHE_COMPILACAO_H
+
+#include <stdint.h>
+#include "ast.h"
+#include "mepa.h"
+#include "tabela_simbolos.h"
+
+// Cache persistente de compilação incremental. Cada sub-rotina (e o
+// programa principal) gera um fragmento de código MEPA guardado sob uma
+// chave: o hash estrutural da sua subárvore, calculado pelo parser (ast.c),
+// que já tem as linhas relativas à da declaração. Junto vão os nomes das
+// globais e sub-rotinas que ela referencia e um hash das suas assinaturas
+// (endereço e tipo das variáveis; parâmetros, locais e profundidades de
+// pilha das sub-rotinas). Se nada disso mudou, a análise do corpo não acha
+// erros (só fragmentos de compilações sem erros são guardados) e o código
+// gerado é o mesmo, então o fragmento é reaproveitado sem percorrer o
+// corpo: sem analisar, reordenar nem gerar de novo.
+//
+// Dentro do fragmento os rótulos são numerados a partir do de entrada e as
+// chamadas a outras sub-rotinas guardam o nome do chamado; ao reaproveitar,
+// os rótulos são realocados na mesma ordem em que o gerador os criaria e as
+// chamadas religadas pelo nome, então o código final é idêntico ao de uma
+// compilação sem cache.
+
+typedef uint64_t ChaveCache;
+
+typedef struct FragmentoCache FragmentoCache;
+typedef struct CacheCompilacao CacheCompilacao;
+
+// Nomes não locais referenciados por um corpo e o hash das suas assinaturas
+typedef struct {
+    char** nomes;
+    int num;
+    uint64_t hash;
+} DependenciasCache;
+
+// Informações que o gerador calcula junto com o fragmento e que as
+// sub-rotinas seguintes usam: pilha_max e pilha_total numa sub-rotina;
+// altura máxima, maior chamada e recursão no programa principal
+#define CACHE_NUM_INFO 3
+
+typedef struct {
+    int acertos;
+    int falhas;
+    double tempo_economizado;   // Soma dos tempos de geração originais dos acertos (s)
+    double tempo_cache;         // Gasto com o arquivo, a busca, o reaproveitamento e a guarda (s)
+} EstatisticasCache;
+
+// Carrega o cache de `arquivo`; se não existir ou for inválido, começa
+// vazio. Com `arquivo` NULL o cache só existe em memória.
+CacheCompilacao* cache_abre(const char* arquivo);
+
+// Grava os fragmentos usados ou criados nesta compilação; retorna 0 em caso
+// de sucesso
+int cache_grava(CacheCompilacao* cache, const char* arquivo);
+void cache_libera(CacheCompilacao* cache);
+
+// Prepara um cache mantido em memória para a compilação seguinte, como se
+// fosse gravado e carregado de novo: com `descarta`, libera os fragmentos
+// que esta compilação não usou (o que cache_grava deixaria de fora); zera
+// as estatísticas
+void cache_recomeca(CacheCompilacao* cache, int descarta);
+
+const EstatisticasCache* cache_estatisticas(const CacheCompilacao* cache);
+
+// Chave da sub-rotina `s` ou do programa principal (s == NULL, com o
+// bloco `principal`, que tem comandos, e `num_globais` globais)
+ChaveCache cache_chave(const Simbolo* s, const Bloco* principal, int num_globais, int modo);
+
+// Fragmento sob `chave` cujas dependências têm as mesmas assinaturas em
+// `ts`, onde `s` (NULL no principal) já foi declarada e as sub-rotinas
+// anteriores já foram geradas; NULL se não houver
+const FragmentoCache* cache_busca(CacheCompilacao* cache, ChaveCache chave, TabelaSimbolos* ts,
+                                  const Simbolo* s);
+
+// Emite o fragmento em `c` com os rótulos a partir de `r_ini` (o de entrada
+// da sub-rotina, já alocado, ou o próximo livre no programa principal),
+// alocando os que faltarem; `linha_base` é a da declaração (ou do primeiro
+// comando do principal). Preenche info[] e retorna o número de instruções.
+int cache_reaproveita(CacheCompilacao* cache, const FragmentoCache* f, CodigoMepa* c,
+                      TabelaSimbolos* ts, int r_ini, int linha_base, int info[CACHE_NUM_INFO]);
+
+// Dependências do corpo de `s` (ou dos comandos `principal`), calculadas
+// logo após a geração, enquanto a AST ainda existe
+DependenciasCache* cache_dependencias(CacheCompilacao* cache, TabelaSimbolos* ts, Simbolo* s,
+                                     const Comando* principal);
+void cache_dependencias_libera(DependenciasCache* deps);
+
+// Guarda as instruções [ini, fim) de `c`, que usam os rótulos [r_ini, r_fim)
+// e foram geradas em `tempo` segundos, com as dependências `deps` (das
+// quais toma posse), substituindo o fragmento que houver sob a mesma chave
+void cache_guarda(CacheCompilacao* cache, ChaveCache chave, DependenciasCache* deps, const CodigoMepa* c,
+                  int ini, int fim, int r_ini, int r_fim, int linha_base, const int info[CACHE_NUM_INFO],
+                  double tempo);
+
+#endif
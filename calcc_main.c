@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "servidor.h"
+
+// Cliente do servidor de compilação: calcc [opções do calc] entrada.ras [saida.mepa]
+//
+// Com CALC_SERVIDOR apontando para o socket de um `calc --servidor`, o
+// pedido é executado por um dos trabalhadores do servidor, com as
+// mensagens na saída e no erro padrão deste processo e o mesmo código de
+// saída do calc. Sem CALC_SERVIDOR, ou se não houver servidor escutando,
+// executa o calc do mesmo diretório do cliente (ou o do PATH).
+
+int main(int argc, char **argv) {
+    const char *caminho = getenv("CALC_SERVIDOR");
+    if (caminho != NULL && *caminho != '\0') {
+        int status;
+        int r = servidor_pede(caminho, argc - 1, argv + 1, &status);
+        if (r == 0) return status;
+        if (r == -2) {
+            fprintf(stderr, "calcc: o servidor em %s encerrou a conexão sem concluir o pedido\n", caminho);
+            return 1;
+        }
+    }
+
+    // Sem servidor: o calc local, com os mesmos argumentos
+    const char *barra = strrchr(argv[0], '/');
+    if (barra == NULL) {
+        argv[0] = "calc";
+        execvp("calc", argv);
+    } else {
+        size_t dir = (size_t)(barra - argv[0]) + 1;
+        char *calc = malloc(dir + sizeof("calc"));
+        if (calc == NULL) {
+            perror("calcc");
+            return 1;
+        }
+        memcpy(calc, argv[0], dir);
+        strcpy(calc + dir, "calc");
+        argv[0] = calc;
+        execv(calc, argv);
+    }
+    perror("calcc: não foi possível executar o calc");
+    return 1;
+}
@@ -0,0 +1,287 @@
+#include "compilacao.h"
+#include "semantico.h"
+#include "ordem_avaliacao.h"
+#include "avaliacao_parcial.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+struct Compilacao {
+    TabelaSimbolos* ts;
+    CodigoMepa* saida;
+    ModoGeracao modo;
+    CacheCompilacao* cache;
+    ModoPercurso percurso;
+    Gerador* g;
+    int num_globais;
+
+    // Estados dos passes, reaproveitados de uma sub-rotina para a outra
+    AnaliseSemantica* analise;
+    AvaliacaoParcial* avaliacao;
+    OrdenacaoAvaliacao* ordenacao;
+};
+
+Compilacao* compilacao_em_fluxo = NULL;
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+Compilacao* compilacao_cria(TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo, CacheCompilacao* cache,
+                            ModoPercurso percurso) {
+    Compilacao *c = calloc(1, sizeof(Compilacao));
+    if (c == NULL) {
+        perror("Erro ao alocar memória para a compilação");
+        exit(EXIT_FAILURE);
+    }
+    c->ts = ts;
+    c->saida = saida;
+    c->modo = modo;
+    c->cache = cache;
+    c->percurso = percurso;
+    c->analise = analise_cria();
+    c->avaliacao = avaliacao_cria();
+    c->ordenacao = ordenacao_cria();
+    return c;
+}
+
+static void libera(Compilacao* c) {
+    analise_libera(c->analise);
+    avaliacao_libera(c->avaliacao);
+    ordenacao_libera(c->ordenacao);
+    free(c);
+}
+
+void compilacao_cabecalho(Compilacao* c, const char* nome, Decl* decls_var) {
+    analisa_cabecalho(c->ts, nome, decls_var);
+    c->num_globais = c->ts->global->prox_deslocamento;
+    c->g = gerador_cria(c->ts, c->saida, c->modo, c->cache);
+}
+
+void compilacao_subrotina(Compilacao* c, Decl* d) {
+    Simbolo *s = declara_subrotina(c->ts, d);
+    if (s == NULL) return;
+    avaliacao_declara(c->ts, s);
+
+    // Inalcançável (eliminacao.h): analisada só pelas mensagens
+    if (s->morta) {
+        analisa_corpo_subrotina(c->ts, s);
+        s->decl = NULL;
+        return;
+    }
+
+    ChaveCache chave;
+    const FragmentoCache *f = NULL;
+    int usa_cache = c->cache != NULL && semantico_num_erros() == 0;
+    if (usa_cache) {
+        chave = cache_chave(s, NULL, 0, c->modo);
+        f = cache_busca(c->cache, chave, c->ts, s);
+    }
+
+    // Sem o fragmento, a análise, a avaliação parcial e a ordenação vão no
+    // percurso da geração; depois de um erro, só a análise roda
+    double inicio = usa_cache ? agora() : 0;
+    Percurso p;
+    percurso_inicia(&p, c->percurso);
+    if (f == NULL) {
+        percurso_adiciona(&p, &passe_analise, c->analise);
+        percurso_adiciona(&p, &passe_avaliacao, c->avaliacao);
+        percurso_adiciona(&p, &passe_ordenacao, c->ordenacao);
+    }
+    if (semantico_num_erros() == 0)
+        gerador_subrotina(c->g, s, f, usa_cache ? &chave : NULL, usa_cache ? agora() - inicio : 0, &p);
+    else
+        percorre_subrotina(&p, c->ts, s);
+
+    // Daqui em diante só o símbolo é usado: a declaração pode ser liberada
+    avaliacao_guarda_corpo(s);
+    s->decl = NULL;
+}
+
+int compilacao_finaliza(Compilacao* c, Bloco* principal) {
+    Comando *comandos = principal->comandos;
+    // Sem comandos o principal é só DMEM/PARA e não passa pelo cache (as
+    // linhas do fragmento são relativas à do primeiro comando)
+    ChaveCache chave;
+    const FragmentoCache *f = NULL;
+    int usa_cache = c->cache != NULL && semantico_num_erros() == 0 && comandos != NULL;
+    if (usa_cache) {
+        chave = cache_chave(NULL, principal, c->num_globais, c->modo);
+        f = cache_busca(c->cache, chave, c->ts, NULL);
+    }
+
+    // O principal é executado inteiro (avaliacao_parcial.h) depois que as
+    // chamadas foram substituídas e antes da ordenação: dois percursos
+    double inicio = usa_cache ? agora() : 0;
+    Percurso p;
+    percurso_inicia(&p, c->percurso);
+    if (f == NULL) {
+        percurso_adiciona(&p, &passe_analise, c->analise);
+        percurso_adiciona(&p, &passe_avaliacao, c->avaliacao);
+        percorre_principal(&p, c->ts, comandos);
+        if (semantico_num_erros() == 0) avaliacao_executa_principal(c->ts, comandos);
+    }
+    if (semantico_num_erros() == 0) {
+        percurso_inicia(&p, c->percurso);
+        if (f == NULL) percurso_adiciona(&p, &passe_ordenacao, c->ordenacao);
+        gerador_principal(c->g, comandos, f, usa_cache ? &chave : NULL, usa_cache ? agora() - inicio : 0, &p);
+    }
+
+    int erros = semantico_num_erros();
+    if (erros > 0) {
+        // Nada do que foi gerado será usado: não guarda os fragmentos
+        gerador_descarta(c->g);
+    } else {
+        gerador_finaliza(c->g);
+    }
+    libera(c);
+    return erros;
+}
+
+void compilacao_descarta(Compilacao* c) {
+    if (c == NULL) return;
+    if (c->g != NULL) gerador_descarta(c->g);
+    libera(c);
+}
+
+int compila_programa(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo,
+                     CacheCompilacao* cache, ModoPercurso percurso) {
+    Bloco *b = p->bloco_principal;
+    Compilacao *c = compilacao_cria(ts, saida, modo, cache, percurso);
+
+    compilacao_cabecalho(c, p->nome, b->decls_var);
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox)
+        compilacao_subrotina(c, d);
+    return compilacao_finaliza(c, b);
+}
+
+// ======================================================================
+// EM PARALELO
+// ======================================================================
+
+typedef struct {
+    Simbolo* s;                 // NULL se a declaração foi ignorada
+    MensagensSemantico msgs;
+    Gerador* parte;
+} TarefaSubrotina;
+
+// Duas rodadas de threads: a análise dos corpos e, depois da avaliação
+// parcial (feita em ordem, porque avalia os corpos anteriores), a
+// ordenação e a geração
+typedef enum { RODADA_ANALISE, RODADA_GERACAO } Rodada;
+
+typedef struct {
+    TabelaSimbolos* ts;
+    ModoGeracao modo;
+    ModoPercurso percurso;
+    TarefaSubrotina* tarefas;
+    int n;
+    Rodada rodada;
+    atomic_int proxima;
+} Paralelo;
+
+static void processa(Paralelo* par, TarefaSubrotina* t) {
+    if (t->s == NULL || (par->rodada == RODADA_GERACAO && t->s->morta)) return;
+
+    // Só as sub-rotinas declaradas até esta são visíveis, como na análise
+    // sequencial
+    TabelaSimbolos visao = ts_visao(par->ts, t->s);
+    if (par->rodada == RODADA_ANALISE) {
+        semantico_redireciona(&t->msgs);
+        analisa_corpo_subrotina(&visao, t->s);
+        semantico_redireciona(NULL);
+        return;
+    }
+
+    // A ordenação vai no percurso da geração
+    OrdenacaoAvaliacao *o = ordenacao_cria();
+    Percurso p;
+    percurso_inicia(&p, par->percurso);
+    percurso_adiciona(&p, &passe_ordenacao, o);
+    t->parte = gerador_cria_parte(&visao, par->modo);
+    gerador_parte_subrotina(t->parte, t->s, &p);
+    ordenacao_libera(o);
+}
+
+static void* trabalhador(void* arg) {
+    Paralelo *par = arg;
+    for (;;) {
+        int k = atomic_fetch_add(&par->proxima, 1);
+        if (k >= par->n) break;
+        processa(par, &par->tarefas[k]);
+    }
+    return NULL;
+}
+
+static void rodada(Paralelo* par, Rodada r, pthread_t* ids, int threads) {
+    par->rodada = r;
+    atomic_store(&par->proxima, 0);
+
+    // A thread chamadora também trabalha
+    int criadas = 0;
+    while (criadas < threads - 1 && pthread_create(&ids[criadas], NULL, trabalhador, par) == 0)
+        criadas++;
+    trabalhador(par);
+    for (int t = 0; t < criadas; t++) pthread_join(ids[t], NULL);
+}
+
+int compila_programa_paralelo(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo,
+                              int threads, ModoPercurso percurso) {
+    Bloco *b = p->bloco_principal;
+    Compilacao *c = compilacao_cria(ts, saida, modo, NULL, percurso);
+    compilacao_cabecalho(c, p->nome, b->decls_var);
+
+    int n = 0;
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) n++;
+    Paralelo par = { .ts = ts, .modo = modo, .percurso = percurso, .n = n };
+    par.tarefas = calloc(n > 0 ? n : 1, sizeof(TarefaSubrotina));
+    if (par.tarefas == NULL) {
+        perror("Erro ao alocar memória para a compilação");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&par.proxima, 0);
+
+    // As declarações instalam os símbolos, em ordem; os alertas delas vão
+    // para as mensagens da sub-rotina, antes das do corpo
+    int k = 0;
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox, k++) {
+        semantico_redireciona(&par.tarefas[k].msgs);
+        par.tarefas[k].s = declara_subrotina(ts, d);
+        semantico_redireciona(NULL);
+        if (par.tarefas[k].s != NULL) avaliacao_declara(ts, par.tarefas[k].s);
+    }
+
+    if (threads > n) threads = n;
+    pthread_t *ids = malloc((threads > 1 ? threads - 1 : 1) * sizeof(pthread_t));
+    if (ids == NULL) {
+        perror("Erro ao alocar as threads da compilação");
+        exit(EXIT_FAILURE);
+    }
+    rodada(&par, RODADA_ANALISE, ids, threads);
+
+    // Mensagens na ordem do programa, como na compilação sequencial
+    for (k = 0; k < n; k++) semantico_despeja(&par.tarefas[k].msgs);
+
+    if (semantico_num_erros() == 0) {
+        for (k = 0; k < n; k++)
+            if (par.tarefas[k].s != NULL && !par.tarefas[k].s->morta) avalia_subrotina(ts, par.tarefas[k].s);
+        rodada(&par, RODADA_GERACAO, ids, threads);
+
+        // Junção na ordem do programa: o código sai como na compilação
+        // sequencial
+        for (k = 0; k < n; k++) {
+            TarefaSubrotina *t = &par.tarefas[k];
+            if (t->s == NULL || t->s->morta) continue;
+            gerador_junta(c->g, t->parte, t->s);
+            avaliacao_guarda_corpo(t->s);
+        }
+    }
+    free(ids);
+    free(par.tarefas);
+
+    return compilacao_finaliza(c, b);
+}
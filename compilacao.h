@@ -0,0 +1,66 @@
+#ifndef COMPILACAO_H
+#define COMPILACAO_H
+
+#include "ast.h"
+#include "mepa.h"
+#include "tabela_simbolos.h"
+#include "gerador_mepa.h"
+#include "cache_compilacao.h"
+#include "percurso.h"
+
+// Análise semântica, ordenação de operandos e geração de código feitas
+// sub-rotina a sub-rotina, na ordem do programa: cada uma é analisada e
+// gerada antes de a seguinte ser vista. O resultado (mensagens e código) é
+// o mesmo de analisa_semantica + ordena_avaliacao + gera_codigo.
+//
+// No modo PERCURSO_FUNDIDO (percurso.h), a análise, a avaliação parcial,
+// a ordenação e a geração de cada sub-rotina são feitas numa só descida
+// pelos comandos; o principal leva duas, porque é executado inteiro entre
+// a avaliação parcial e a ordenação. PERCURSO_SEPARADO faz uma descida
+// por passe, com o mesmo resultado.
+//
+// Com `cache` (pode ser NULL), uma sub-rotina (ou o principal) cuja chave
+// está no cache não tem o corpo analisado nem gerado: o fragmento é
+// copiado de lá. Depois do primeiro erro semântico o cache deixa de ser
+// consultado e nada mais é gerado, mas a análise continua até o fim.
+// Retorna o número de erros semânticos; o código em `saida` só é válido
+// se for 0.
+int compila_programa(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo,
+                     CacheCompilacao* cache, ModoPercurso percurso);
+
+// O mesmo com as sub-rotinas analisadas e geradas em paralelo, em até
+// `threads` threads: as declarações são instaladas em ordem, cada corpo é
+// analisado e gerado numa parte isolada (gerador_cria_parte) e as partes e
+// as mensagens são juntadas na ordem do programa. O código e as mensagens
+// são idênticos aos de compila_programa (sem cache). Aqui só a ordenação
+// e a geração são fundidas: a análise vem numa rodada de threads antes, e
+// a avaliação parcial, em ordem, entre as duas.
+int compila_programa_paralelo(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo,
+                              int threads, ModoPercurso percurso);
+
+// As mesmas etapas, para quem recebe o programa aos pedaços:
+//   compilacao_cabecalho   instala o programa e as globais
+//   compilacao_subrotina   analisa e gera uma sub-rotina; ao retornar nada
+//                          mais guarda referência a `d`, que pode ser
+//                          liberada
+//   compilacao_finaliza    analisa e gera os comandos do bloco principal,
+//                          preenche as profundidades pendentes e libera a
+//                          compilação; retorna o número de erros
+//   compilacao_descarta    libera a compilação interrompida (erro sintático)
+typedef struct Compilacao Compilacao;
+
+Compilacao* compilacao_cria(TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo, CacheCompilacao* cache,
+                            ModoPercurso percurso);
+void compilacao_cabecalho(Compilacao* c, const char* nome, Decl* decls_var);
+void compilacao_subrotina(Compilacao* c, Decl* d);
+int compilacao_finaliza(Compilacao* c, Bloco* principal);
+void compilacao_descarta(Compilacao* c);
+
+// Compilação em fluxo: se definida, o parser chama compilacao_cabecalho ao
+// fim das variáveis globais e compilacao_subrotina a cada sub-rotina
+// reduzida, que é liberada em seguida em vez de entrar na AST. Assim a
+// memória da AST fica limitada à maior sub-rotina (mais o principal), e
+// não ao programa inteiro.
+extern Compilacao* compilacao_em_fluxo;
+
+#endif
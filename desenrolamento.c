@@ -0,0 +1,633 @@
+#include "desenrolamento.h"
+#include "grafo_chamadas.h"
+#include "parser.tab.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_INVARIANTES 8   // A variável de indução e as do limite
+#define MAX_PRODUTOS 8      // Constantes distintas que multiplicam a variável de indução
+#define PESO_REDUCAO 3      // Ocorrências a partir das quais o produto vira temporária
+#define PESO_LACO_INTERNO 3 // Peso de uma ocorrência dentro de um laço interno
+
+typedef struct {
+    Programa* prog;
+    Decl* subrot;           // NULL no principal
+    Bloco* bloco;           // O da sub-rotina (ou o principal): recebe as temporárias
+    int fator;
+    GrafoChamadas* grafo;   // Montado na primeira consulta
+    int transformou;        // Algum laço do bloco
+    DesenrolamentoLacos total;
+} Desenrolamento;
+
+// ======================================================================
+// NOMES
+// ======================================================================
+
+enum { NOME_OUTRO, NOME_LOCAL, NOME_GLOBAL };
+
+static int busca_vars(const Decl* d, const char* nome, TipoSemantico* tipo) {
+    for (; d != NULL; d = d->prox) {
+        for (const IdList *id = d->u.var.ids; id != NULL; id = id->prox) {
+            if (strcmp(id->nome, nome) != 0) continue;
+            *tipo = d->u.var.tipo_var;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Onde `nome` está declarado, como na análise: parâmetros e locais
+// escondem as globais, e num nome declarado duas vezes vale a primeira
+// declaração. *tipo recebe o tipo de uma variável ou parâmetro; as
+// sub-rotinas, o programa e os nomes não declarados são NOME_OUTRO.
+static int resolve(const Desenrolamento* d, const char* nome, TipoSemantico* tipo) {
+    if (d->subrot != NULL) {
+        for (const ParamDecl *p = d->subrot->u.subrot.params; p != NULL; p = p->prox) {
+            for (const IdList *id = p->ids; id != NULL; id = id->prox) {
+                if (strcmp(id->nome, nome) != 0) continue;
+                *tipo = p->tipo_param;
+                return NOME_LOCAL;
+            }
+        }
+        if (busca_vars(d->subrot->u.subrot.bloco->decls_var, nome, tipo)) return NOME_LOCAL;
+    }
+    if (strcmp(nome, d->prog->nome) == 0) return NOME_OUTRO;
+    return busca_vars(d->prog->bloco_principal->decls_var, nome, tipo) ? NOME_GLOBAL : NOME_OUTRO;
+}
+
+// ======================================================================
+// RECONHECIMENTO
+// ======================================================================
+
+typedef struct {
+    int k;
+    int peso;           // Ocorrências, as de laços internos com PESO_LACO_INTERNO
+    char* temp;         // Temporária, se o produto for reduzido
+} Produto;
+
+typedef struct {
+    const char* var;            // A variável de indução
+    int passo;
+    int op;                     // Comparação, com `var` à esquerda
+    int crescente;
+    Expr* limite;
+    Comando* corpo;             // Os comandos antes do incremento (pode ser o próprio)
+    Comando* incremento;
+    const char* invariantes[MAX_INVARIANTES];   // `var` e as variáveis do limite
+    int num_invariantes;
+    int globais;                // Alguma delas é global
+    Produto produtos[MAX_PRODUTOS];
+    int num_produtos;
+    int trocas;                 // Produtos trocados por temporárias nas cópias
+} LacoContado;
+
+// `nome` é uma variável ou parâmetro inteiro que o laço não pode mudar
+static int registra(const Desenrolamento* d, LacoContado* l, const char* nome) {
+    TipoSemantico tipo;
+    int onde = resolve(d, nome, &tipo);
+    if (onde == NOME_OUTRO || tipo != T_INT) return 0;
+    for (int k = 0; k < l->num_invariantes; k++)
+        if (strcmp(l->invariantes[k], nome) == 0) return 1;
+    if (l->num_invariantes == MAX_INVARIANTES) return 0;
+    l->invariantes[l->num_invariantes++] = nome;
+    l->globais |= onde == NOME_GLOBAL;
+    return 1;
+}
+
+// Constantes e variáveis inteiras (não a de indução) com + - *
+static int limite_invariante(const Desenrolamento* d, LacoContado* l, const Expr* e) {
+    switch (e->tipo) {
+        case EXPR_NUM:
+            return 1;
+        case EXPR_VAR:
+            return strcmp(e->u.id, l->var) != 0 && registra(d, l, e->u.id);
+        case EXPR_BIN:
+            if (e->u.bin.op != '+' && e->u.bin.op != '-' && e->u.bin.op != '*') return 0;
+            return limite_invariante(d, l, e->u.bin.esq) && limite_invariante(d, l, e->u.bin.dir);
+        case EXPR_UN:
+            return e->u.un.op == '-' && limite_invariante(d, l, e->u.un.arg);
+        default:
+            return 0;
+    }
+}
+
+static int invariante(const LacoContado* l, const char* nome) {
+    for (int k = 0; k < l->num_invariantes; k++)
+        if (strcmp(l->invariantes[k], nome) == 0) return 1;
+    return 0;
+}
+
+// Uma chamada de `nome` não escreve as globais invariantes do laço
+static int chamada_preserva(Desenrolamento* d, const LacoContado* l, const char* nome) {
+    if (!l->globais) return 1;
+    if (d->grafo == NULL) d->grafo = grafo_constroi(d->prog);
+
+    int no = grafo_busca(d->grafo, nome);
+    if (no < 0) return 0;
+    for (int k = 0; k < l->num_invariantes; k++) {
+        int g = grafo_busca_global(d->grafo, l->invariantes[k]);
+        if (g >= 0 && grafo_escreve_global(d->grafo, no, g)) return 0;
+    }
+    return 1;
+}
+
+// As expressões não mudam as invariantes; conta os nós em *nos
+static int preserva_exprs(Desenrolamento* d, const LacoContado* l, const Expr* e, int* nos) {
+    for (; e != NULL; e = e->prox) {
+        TipoSemantico tipo;
+        (*nos)++;
+        switch (e->tipo) {
+            case EXPR_NUM:
+            case EXPR_BOOL:
+                break;
+            case EXPR_VAR:
+                // Um nome que não é variável é chamada (ou erro)
+                if (resolve(d, e->u.id, &tipo) == NOME_OUTRO && !chamada_preserva(d, l, e->u.id)) return 0;
+                break;
+            case EXPR_CALL_FUNC:
+                if (!chamada_preserva(d, l, e->u.func.nome)) return 0;
+                if (!preserva_exprs(d, l, e->u.func.args_lista, nos)) return 0;
+                break;
+            case EXPR_BIN:
+                if (!preserva_exprs(d, l, e->u.bin.esq, nos) || !preserva_exprs(d, l, e->u.bin.dir, nos)) return 0;
+                break;
+            case EXPR_UN:
+                if (!preserva_exprs(d, l, e->u.un.arg, nos)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+// Os comandos de `c` até `fim` (exclusive) não mudam as invariantes
+static int preserva_cmds(Desenrolamento* d, const LacoContado* l, const Comando* c, const Comando* fim, int* nos) {
+    for (; c != fim; c = c->prox) {
+        (*nos)++;
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                if (invariante(l, c->u.atrib.nome_var)) return 0;
+                if (!preserva_exprs(d, l, c->u.atrib.expr, nos)) return 0;
+                break;
+            case CMD_IF:
+                if (!preserva_exprs(d, l, c->u.cond.cond, nos)) return 0;
+                if (!preserva_cmds(d, l, c->u.cond.then_cmd, NULL, nos)) return 0;
+                if (!preserva_cmds(d, l, c->u.cond.else_cmd, NULL, nos)) return 0;
+                break;
+            case CMD_WHILE:
+                if (!preserva_exprs(d, l, c->u.loop.cond, nos)) return 0;
+                if (!preserva_cmds(d, l, c->u.loop.body, NULL, nos)) return 0;
+                break;
+            case CMD_READ:
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    if (invariante(l, id->nome)) return 0;
+                break;
+            case CMD_WRITE:
+                if (!preserva_exprs(d, l, c->u.escrita.lista_exp, nos)) return 0;
+                break;
+            case CMD_CALL_PROC:
+                if (!chamada_preserva(d, l, c->u.proc_call.nome)) return 0;
+                if (!preserva_exprs(d, l, c->u.proc_call.args_lista, nos)) return 0;
+                break;
+            case CMD_COMPOSTO:
+                if (c->u.composto->decls_var != NULL || c->u.composto->decls_subrotinas != NULL) return 0;
+                if (!preserva_cmds(d, l, c->u.composto->comandos, NULL, nos)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+// `i := i + c`, `i := c + i` ou `i := i - c`, com c != 0
+static int le_incremento(LacoContado* l, const Comando* c) {
+    if (c->tipo != CMD_ATRIB || c->u.atrib.expr->tipo != EXPR_BIN) return 0;
+    const Expr *e = c->u.atrib.expr, *esq = e->u.bin.esq, *dir = e->u.bin.dir;
+    const char *i = c->u.atrib.nome_var;
+    int esq_i = esq->tipo == EXPR_VAR && strcmp(esq->u.id, i) == 0;
+    int dir_i = dir->tipo == EXPR_VAR && strcmp(dir->u.id, i) == 0;
+
+    if (e->u.bin.op == '+' && esq_i && dir->tipo == EXPR_NUM)
+        l->passo = dir->u.ival;
+    else if (e->u.bin.op == '+' && dir_i && esq->tipo == EXPR_NUM)
+        l->passo = esq->u.ival;
+    else if (e->u.bin.op == '-' && esq_i && dir->tipo == EXPR_NUM && dir->u.ival != INT_MIN)
+        l->passo = -dir->u.ival;
+    else
+        return 0;
+    l->var = i;
+    l->incremento = (Comando*)c;
+    return l->passo != 0;
+}
+
+static int inverte(int op) {
+    switch (op) {
+        case MENOR: return MAIOR;
+        case MENOR_IGUAL: return MAIOR_IGUAL;
+        case MAIOR: return MENOR;
+        default: return MENOR_IGUAL;
+    }
+}
+
+// Reconhece o laço contado `w`; *nos recebe o tamanho de uma cópia do corpo
+static int reconhece(Desenrolamento* d, const Comando* w, LacoContado* l, int* nos) {
+    const Expr *cond = w->u.loop.cond;
+    const Comando *corpo = w->u.loop.body;
+    memset(l, 0, sizeof(*l));
+    if (cond->tipo != EXPR_BIN || corpo->tipo != CMD_COMPOSTO || corpo->copia) return 0;
+    const Bloco *b = corpo->u.composto;
+    if (b->decls_var != NULL || b->decls_subrotinas != NULL || b->comandos == NULL) return 0;
+
+    const Comando *ultimo = b->comandos;
+    while (ultimo->prox != NULL) ultimo = ultimo->prox;
+    if (!le_incremento(l, ultimo)) return 0;
+
+    int op = cond->u.bin.op;
+    if (op != MENOR && op != MENOR_IGUAL && op != MAIOR && op != MAIOR_IGUAL) return 0;
+    const Expr *esq = cond->u.bin.esq, *dir = cond->u.bin.dir;
+    if (esq->tipo == EXPR_VAR && strcmp(esq->u.id, l->var) == 0) {
+        l->limite = (Expr*)dir;
+    } else if (dir->tipo == EXPR_VAR && strcmp(dir->u.id, l->var) == 0) {
+        l->limite = (Expr*)esq;
+        op = inverte(op);
+    } else {
+        return 0;
+    }
+    l->op = op;
+    l->crescente = op == MENOR || op == MENOR_IGUAL;
+    if (l->crescente != (l->passo > 0)) return 0;
+
+    if (!registra(d, l, l->var) || !limite_invariante(d, l, l->limite)) return 0;
+    l->corpo = b->comandos;
+    *nos = 1;
+    return preserva_cmds(d, l, l->corpo, l->incremento, nos);
+}
+
+// ======================================================================
+// REDUÇÃO DE FORÇA
+// ======================================================================
+
+// A constante de `i * k` ou `k * i`, se `e` for um desses produtos
+static int produto(const LacoContado* l, const Expr* e, int* k) {
+    if (e->tipo != EXPR_BIN || e->u.bin.op != '*') return 0;
+    const Expr *esq = e->u.bin.esq, *dir = e->u.bin.dir;
+    if (esq->tipo == EXPR_VAR && strcmp(esq->u.id, l->var) == 0 && dir->tipo == EXPR_NUM)
+        *k = dir->u.ival;
+    else if (dir->tipo == EXPR_VAR && strcmp(dir->u.id, l->var) == 0 && esq->tipo == EXPR_NUM)
+        *k = esq->u.ival;
+    else
+        return 0;
+    return *k < -1 || *k > 1;
+}
+
+static void conta_exprs(LacoContado* l, const Expr* e, int peso) {
+    for (; e != NULL; e = e->prox) {
+        int k;
+        if (produto(l, e, &k)) {
+            int p = 0;
+            while (p < l->num_produtos && l->produtos[p].k != k) p++;
+            if (p == l->num_produtos) {
+                if (p == MAX_PRODUTOS) continue;
+                l->produtos[l->num_produtos++].k = k;
+            }
+            l->produtos[p].peso += peso;
+            continue;
+        }
+        switch (e->tipo) {
+            case EXPR_CALL_FUNC:
+                conta_exprs(l, e->u.func.args_lista, peso);
+                break;
+            case EXPR_BIN:
+                conta_exprs(l, e->u.bin.esq, peso);
+                conta_exprs(l, e->u.bin.dir, peso);
+                break;
+            case EXPR_UN:
+                conta_exprs(l, e->u.un.arg, peso);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void conta_cmds(LacoContado* l, const Comando* c, const Comando* fim, int peso) {
+    for (; c != fim; c = c->prox) {
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                conta_exprs(l, c->u.atrib.expr, peso);
+                break;
+            case CMD_IF:
+                conta_exprs(l, c->u.cond.cond, peso);
+                conta_cmds(l, c->u.cond.then_cmd, NULL, peso);
+                conta_cmds(l, c->u.cond.else_cmd, NULL, peso);
+                break;
+            case CMD_WHILE:
+                conta_exprs(l, c->u.loop.cond, PESO_LACO_INTERNO);
+                conta_cmds(l, c->u.loop.body, NULL, PESO_LACO_INTERNO);
+                break;
+            case CMD_WRITE:
+                conta_exprs(l, c->u.escrita.lista_exp, peso);
+                break;
+            case CMD_CALL_PROC:
+                conta_exprs(l, c->u.proc_call.args_lista, peso);
+                break;
+            case CMD_COMPOSTO:
+                conta_cmds(l, c->u.composto->comandos, NULL, peso);
+                break;
+            case CMD_READ:
+                break;
+        }
+    }
+}
+
+// A temporária de `i * k` no bloco, declarada na primeira vez
+static char* temporaria(Desenrolamento* d, const LacoContado* l, int k, int linha) {
+    char nome[256];
+    TipoSemantico tipo;
+    snprintf(nome, sizeof(nome), "%s*%d", l->var, k);
+
+    Decl *vars = d->bloco->decls_var;
+    if (!busca_vars(vars, nome, &tipo)) {
+        Decl *nova = decl_var(adiciona_id(NULL, nome), T_INT);
+        nova->linha = linha;
+        d->bloco->decls_var = adiciona_decl(vars, nova);
+        d->total.temporarias++;
+    }
+    return strdup(nome);
+}
+
+// ======================================================================
+// CÓPIAS
+// ======================================================================
+
+// Os construtores dão aos nós a linha corrente do scanner: as cópias
+// recebem a do original
+static Expr* na_linha(Expr* e, int linha) {
+    e->linha = linha;
+    return e;
+}
+
+static Comando* cmd_na_linha(Comando* c, int linha) {
+    c->linha = linha;
+    return c;
+}
+
+static Expr* copia_exprs(LacoContado* l, const Expr* e);
+
+static Expr* copia_expr(LacoContado* l, const Expr* e) {
+    int k;
+    if (produto(l, e, &k)) {
+        for (int p = 0; p < l->num_produtos; p++) {
+            if (l->produtos[p].k != k || l->produtos[p].temp == NULL) continue;
+            l->trocas++;
+            return na_linha(expr_id(l->produtos[p].temp), e->linha);
+        }
+    }
+
+    Expr *c = NULL;
+    switch (e->tipo) {
+        case EXPR_NUM:
+            c = expr_num(e->u.ival);
+            break;
+        case EXPR_BOOL:
+            c = expr_bool(e->u.ival);
+            break;
+        case EXPR_VAR:
+            c = expr_id(e->u.id);
+            break;
+        case EXPR_BIN:
+            c = expr_bin(e->u.bin.op, copia_expr(l, e->u.bin.esq), copia_expr(l, e->u.bin.dir));
+            break;
+        case EXPR_UN:
+            c = expr_un(e->u.un.op, copia_expr(l, e->u.un.arg));
+            break;
+        case EXPR_CALL_FUNC:
+            c = expr_call_func(e->u.func.nome, copia_exprs(l, e->u.func.args_lista));
+            break;
+    }
+    return na_linha(c, e->linha);
+}
+
+static Expr* copia_exprs(LacoContado* l, const Expr* e) {
+    Expr *lista = NULL, **fim = &lista;
+    for (; e != NULL; e = e->prox) {
+        *fim = copia_expr(l, e);
+        fim = &(*fim)->prox;
+    }
+    return lista;
+}
+
+static Comando* composto(Comando* cmds, int linha) {
+    return cmd_na_linha(cmd_composto(criar_bloco(NULL, NULL, cmds)), linha);
+}
+
+// Cópia dos comandos de `c` até `fim` (exclusive), com os produtos
+// reduzidos trocados pelas temporárias
+static Comando* copia_cmds(LacoContado* l, const Comando* c, const Comando* fim) {
+    Comando *lista = NULL, **ult = &lista;
+    for (; c != fim; c = c->prox) {
+        Comando *n = NULL;
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                n = cmd_atrib(c->u.atrib.nome_var, copia_expr(l, c->u.atrib.expr));
+                break;
+            case CMD_IF:
+                n = cmd_if(copia_expr(l, c->u.cond.cond), copia_cmds(l, c->u.cond.then_cmd, NULL),
+                           copia_cmds(l, c->u.cond.else_cmd, NULL));
+                break;
+            case CMD_WHILE:
+                n = cmd_while(copia_expr(l, c->u.loop.cond), copia_cmds(l, c->u.loop.body, NULL));
+                break;
+            case CMD_READ: {
+                IdList *ids = NULL;
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    ids = adiciona_id(ids, id->nome);
+                n = cmd_read(ids);
+            } break;
+            case CMD_WRITE:
+                n = cmd_write(copia_exprs(l, c->u.escrita.lista_exp));
+                break;
+            case CMD_CALL_PROC:
+                n = cmd_call_proc(c->u.proc_call.nome, copia_exprs(l, c->u.proc_call.args_lista));
+                break;
+            case CMD_COMPOSTO:
+                n = composto(copia_cmds(l, c->u.composto->comandos, NULL), c->linha);
+                n->copia = c->copia;
+                break;
+        }
+        *ult = cmd_na_linha(n, c->linha);
+        ult = &n->prox;
+    }
+    return lista;
+}
+
+// ======================================================================
+// TRANSFORMAÇÃO
+// ======================================================================
+
+static Comando* atribuicao(const char* nome, Expr* e, int linha) {
+    return cmd_na_linha(cmd_atrib((char*)nome, e), linha);
+}
+
+// Acrescenta a `*ult` uma iteração: o corpo, o incremento e as
+// atualizações das temporárias; retorna o novo fim da lista
+static Comando** iteracao(LacoContado* l, Comando** ult) {
+    *ult = copia_cmds(l, l->corpo, l->incremento);
+    while (*ult != NULL) ult = &(*ult)->prox;
+
+    *ult = copia_cmds(l, l->incremento, NULL);
+    ult = &(*ult)->prox;
+    for (int p = 0; p < l->num_produtos; p++) {
+        const Produto *pr = &l->produtos[p];
+        if (pr->temp == NULL) continue;
+        int linha = l->incremento->linha;
+        int soma = (int)((unsigned)l->passo * (unsigned)pr->k);     // Com o estouro da MEPA
+        *ult = atribuicao(pr->temp, na_linha(expr_bin('+', na_linha(expr_id(pr->temp), linha),
+                                                         na_linha(expr_num(soma), linha)), linha), linha);
+        ult = &(*ult)->prox;
+    }
+    return ult;
+}
+
+// Maior fator que cabe: corpo desenrolado dentro de DESENROLAMENTO_MAX_NOS
+// e sem estouro de K = (fator - 1) * |passo| nem, com limite constante,
+// de n -/+ K
+static int fator_efetivo(const Desenrolamento* d, const LacoContado* l, int nos, long long* k) {
+    int fator = d->fator;
+    if (fator > 1 && (long long)fator * nos > DESENROLAMENTO_MAX_NOS) fator = DESENROLAMENTO_MAX_NOS / nos;
+    if (fator <= 1) return 1;
+
+    *k = (long long)(fator - 1) * llabs((long long)l->passo);
+    if (*k > INT_MAX) return 1;
+    if (l->limite->tipo == EXPR_NUM) {
+        long long n = l->limite->u.ival;
+        if (l->crescente ? n - *k < INT_MIN : n + *k > INT_MAX) return 1;
+    }
+    return fator;
+}
+
+// Troca o while *pos, já reconhecido, por um composto com o laço
+// transformado, se há o que fazer
+static void transforma(Desenrolamento* d, Comando** pos, LacoContado* l, int nos) {
+    Comando *w = *pos;
+    int linha = cmd_linha(w);
+    long long k = 0;
+    int fator = fator_efetivo(d, l, nos, &k);
+
+    conta_cmds(l, l->corpo, l->incremento, 1);
+    int reduzidos = 0;
+    for (int p = 0; p < l->num_produtos; p++) {
+        if (l->produtos[p].peso < PESO_REDUCAO) continue;
+        l->produtos[p].temp = temporaria(d, l, l->produtos[p].k, linha);
+        reduzidos++;
+    }
+    if (fator == 1 && reduzidos == 0) return;       // Nenhuma temporária foi criada
+
+    // Iniciação das temporárias
+    Comando *seq = NULL, **ult = &seq;
+    for (int p = 0; p < l->num_produtos; p++) {
+        const Produto *pr = &l->produtos[p];
+        if (pr->temp == NULL) continue;
+        Expr *e = expr_bin('*', na_linha(expr_id((char*)l->var), linha), na_linha(expr_num(pr->k), linha));
+        *ult = atribuicao(pr->temp, na_linha(e, linha), linha);
+        ult = &(*ult)->prox;
+    }
+
+    // O laço: a primeira iteração à vista da análise, as demais numa cópia
+    Comando *corpo = NULL, **fim = iteracao(l, &corpo);
+    d->total.multiplicacoes += l->trocas;
+    if (fator > 1) {
+        Comando *demais = NULL, **fim_demais = &demais;
+        for (int u = 1; u < fator; u++) fim_demais = iteracao(l, fim_demais);
+        *fim = composto(demais, linha);
+        (*fim)->copia = 1;
+    }
+
+    Expr *cond;
+    if (fator > 1) {
+        Expr *limite = na_linha(expr_bin(l->crescente ? '-' : '+', copia_expr(l, l->limite),
+                                         na_linha(expr_num((int)k), linha)), linha);
+        cond = na_linha(expr_bin(l->op, na_linha(expr_id((char*)l->var), linha), limite), linha);
+    } else {
+        cond = copia_expr(l, w->u.loop.cond);
+    }
+    *ult = cmd_na_linha(cmd_while(cond, composto(corpo, linha)), linha);
+
+    if (fator > 1) {
+        // Guarda contra o estouro de n -/+ K e o laço original para o resto
+        if (l->limite->tipo != EXPR_NUM) {
+            Expr *guarda = na_linha(expr_bin(l->crescente ? MAIOR_IGUAL : MENOR_IGUAL, copia_expr(l, l->limite),
+                                             na_linha(expr_num(l->crescente ? (int)(INT_MIN + k) : (int)(INT_MAX - k)),
+                                                      linha)), linha);
+            seq = cmd_na_linha(cmd_if(guarda, composto(seq, linha), NULL), linha);
+            ult = &seq->prox;
+        } else {
+            ult = &(*ult)->prox;
+        }
+        *pos = w->prox;
+        w->prox = NULL;
+        *ult = composto(w, linha);
+        (*ult)->copia = 1;
+        d->total.lacos++;
+    } else {
+        *pos = w->prox;
+        w->prox = NULL;
+        cmd_free(w);
+        d->total.reduzidos++;
+    }
+
+    Comando *novo = composto(seq, linha);
+    novo->prox = *pos;
+    *pos = novo;
+    for (int p = 0; p < l->num_produtos; p++) free(l->produtos[p].temp);
+    d->transformou = 1;
+}
+
+// ======================================================================
+// PERCURSO
+// ======================================================================
+
+// Os laços internos antes dos externos, para que estes copiem o corpo já
+// desenrolado
+static void percorre(Desenrolamento* d, Comando** pos) {
+    for (; *pos != NULL; pos = &(*pos)->prox) {
+        Comando *c = *pos;
+        switch (c->tipo) {
+            case CMD_IF:
+                percorre(d, &c->u.cond.then_cmd);
+                percorre(d, &c->u.cond.else_cmd);
+                break;
+            case CMD_WHILE: {
+                percorre(d, &c->u.loop.body);
+                LacoContado l;
+                int nos;
+                if (reconhece(d, c, &l, &nos)) transforma(d, pos, &l, nos);
+            } break;
+            case CMD_COMPOSTO:
+                percorre(d, &c->u.composto->comandos);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void desenrola_bloco(Desenrolamento* d, Decl* subrot, Bloco* b) {
+    d->subrot = subrot;
+    d->bloco = b;
+    d->transformou = 0;
+    percorre(d, &b->comandos);
+    b->desenrolamento = d->transformou ? d->fator : 0;
+}
+
+DesenrolamentoLacos desenrola_lacos(Programa* p, int fator) {
+    Desenrolamento d = { .prog = p, .fator = fator };
+    Bloco *b = p->bloco_principal;
+
+    for (Decl *s = b->decls_subrotinas; s != NULL; s = s->prox)
+        if (!s->morta) desenrola_bloco(&d, s, s->u.subrot.bloco);
+    desenrola_bloco(&d, NULL, b);
+
+    if (d.grafo != NULL) grafo_libera(d.grafo);
+    return d.total;
+}
@@ -0,0 +1,60 @@
+#ifndef DESENROLAMENTO_H
+#define DESENROLAMENTO_H
+
+#include "ast.h"
+
+// Desenrolamento de laços contados, feito na AST depois da eliminação de
+// código morto e antes do compartilhamento de posições. Um while é
+// contado se tem a forma
+//
+//     while i <= n do begin B; i := i + c end
+//
+// (ou com <, >, >=, ou com os lados trocados), onde `i` é uma variável
+// ou parâmetro inteiro, `c` uma constante no sentido da comparação e `n`
+// uma expressão invariante: constantes e variáveis inteiras com + - *,
+// sem chamadas. B não atribui nem lê (read) `i` nem as variáveis de `n`,
+// e, se alguma delas for global, não chama sub-rotina que possa escrevê-la
+// (grafo_chamadas.h). Com fator U, o laço vira
+//
+//     if n >= INT_MIN + K then begin
+//         while i <= n - K do begin B; i := i + c; ... (U vezes) end
+//     end;
+//     while i <= n do begin B; i := i + c end     { o resto }
+//
+// com K = (U - 1) * |c|: enquanto o teste do laço desenrolado vale, as
+// U - 1 iterações seguintes também passariam no teste original, e o
+// laço original termina as que sobram. A guarda evita o estouro de
+// n - K (com `n` constante ela é decidida aqui). A sequência de valores
+// de `i`, e de tudo o mais, é a mesma; só os testes intermediários saem.
+//
+// Num laço contado, as multiplicações `i * k` por constantes do corpo
+// passam a ler uma temporária, iniciada com i * k antes do laço e somada
+// de c * k a cada incremento de `i` (redução de força). A troca economiza
+// uma instrução por ocorrência executada e custa duas por iteração, então
+// só é feita quando o produto aparece ao menos três vezes (ou dentro de um
+// laço interno); com fator 1 é a única transformação. As temporárias são
+// locais da sub-rotina (globais no principal) com nomes que não são
+// identificadores ("i*4") e uma por par (i, k) em cada sub-rotina.
+//
+// As cópias do corpo, menos a primeira, e o laço do resto ficam em
+// compostos marcados `copia`, cujos erros a análise semântica não
+// informa: a primeira cópia já os informa uma vez, como o laço original
+// faria (o cabeçalho, conferido aqui, não tem erros). Os laços internos
+// são desenrolados antes dos externos; um corpo grande demais reduz o
+// fator (DESENROLAMENTO_MAX_NOS). As sub-rotinas inalcançáveis não são
+// transformadas e, como a eliminação, nada disso se aplica a --fluxo. O
+// fator entra em Bloco.desenrolamento, e daí na chave do cache.
+
+#define DESENROLAMENTO_FATOR 4
+#define DESENROLAMENTO_MAX_NOS 512     // Do corpo desenrolado: fator x nós de uma cópia
+
+typedef struct {
+    int lacos;          // Desenrolados
+    int reduzidos;      // Só com redução de força (fator 1 ou corpo grande demais)
+    int multiplicacoes; // Ocorrências trocadas por temporárias (na primeira cópia)
+    int temporarias;
+} DesenrolamentoLacos;
+
+DesenrolamentoLacos desenrola_lacos(Programa* p, int fator);
+
+#endif
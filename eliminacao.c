@@ -0,0 +1,294 @@
+#include "eliminacao.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* el_calloc(size_t n, size_t tam) {
+    void *ptr = calloc(n > 0 ? n : 1, tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para a eliminação de código morto");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// ======================================================================
+// NOMES
+// ======================================================================
+
+// Um identificador declarado: variável, sub-rotina ou outro (parâmetro,
+// o nome do programa), que só esconde os demais
+typedef struct {
+    const char* nome;
+    IdList* var;
+    Decl* subrot;
+    int usado;          // Variável lida; sub-rotina alcançada
+    int atribuicoes;    // Variável: atribuições sem efeitos
+} Nome;
+
+// Tabela de endereçamento aberto, com a primeira declaração de cada nome
+typedef struct {
+    Nome* itens;
+    int cap, num;
+} Nomes;
+
+static unsigned hash_nome(const char* s) {
+    unsigned h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+static void nomes_inicia(Nomes* t) {
+    t->cap = 16;
+    t->num = 0;
+    t->itens = el_calloc(t->cap, sizeof(Nome));
+}
+
+static Nome* nomes_busca(const Nomes* t, const char* nome) {
+    for (unsigned k = hash_nome(nome) & (t->cap - 1); t->itens[k].nome != NULL; k = (k + 1) & (t->cap - 1))
+        if (strcmp(t->itens[k].nome, nome) == 0) return &t->itens[k];
+    return NULL;
+}
+
+// Declara `nome`; NULL se já foi declarado (a declaração é ignorada)
+static Nome* nomes_declara(Nomes* t, const char* nome) {
+    if (nomes_busca(t, nome) != NULL) return NULL;
+
+    if (2 * (t->num + 1) > t->cap) {
+        Nomes maior = { el_calloc(2 * t->cap, sizeof(Nome)), 2 * t->cap, t->num };
+        for (int i = 0; i < t->cap; i++) {
+            if (t->itens[i].nome == NULL) continue;
+            unsigned k = hash_nome(t->itens[i].nome) & (maior.cap - 1);
+            while (maior.itens[k].nome != NULL) k = (k + 1) & (maior.cap - 1);
+            maior.itens[k] = t->itens[i];
+        }
+        free(t->itens);
+        *t = maior;
+    }
+
+    unsigned k = hash_nome(nome) & (t->cap - 1);
+    while (t->itens[k].nome != NULL) k = (k + 1) & (t->cap - 1);
+    t->itens[k].nome = nome;
+    t->num++;
+    return &t->itens[k];
+}
+
+static void declara_vars(Nomes* t, Decl* d) {
+    for (; d != NULL; d = d->prox) {
+        for (IdList *id = d->u.var.ids; id != NULL; id = id->prox) {
+            Nome *n = nomes_declara(t, id->nome);
+            if (n != NULL) n->var = id;
+        }
+    }
+}
+
+// ======================================================================
+// ALCANCE
+// ======================================================================
+
+typedef struct {
+    Nomes globais;
+    Nomes locais;       // Da sub-rotina percorrida
+    int em_subrotina;
+    Decl** pendentes;   // Alcançadas ainda não percorridas
+    int num_pendentes, cap_pendentes;
+} Eliminacao;
+
+static Nome* resolve(Eliminacao* el, const char* nome) {
+    Nome *n = el->em_subrotina ? nomes_busca(&el->locais, nome) : NULL;
+    return n != NULL ? n : nomes_busca(&el->globais, nome);
+}
+
+// Uso de `nome` como valor ou chamada
+static void usa(Eliminacao* el, const char* nome) {
+    Nome *n = resolve(el, nome);
+    if (n == NULL || n->usado) return;
+    n->usado = 1;
+    if (n->subrot == NULL) return;
+
+    if (el->num_pendentes == el->cap_pendentes) {
+        el->cap_pendentes = el->cap_pendentes ? 2 * el->cap_pendentes : 16;
+        el->pendentes = realloc(el->pendentes, el->cap_pendentes * sizeof(Decl*));
+        if (el->pendentes == NULL) {
+            perror("Erro ao alocar memória para a eliminação de código morto");
+            exit(EXIT_FAILURE);
+        }
+    }
+    el->pendentes[el->num_pendentes++] = n->subrot;
+}
+
+static void percorre_exprs(Eliminacao* el, Expr* e) {
+    for (; e != NULL; e = e->prox) {
+        switch (e->tipo) {
+            case EXPR_NUM:
+            case EXPR_BOOL:
+                break;
+            case EXPR_VAR:
+                usa(el, e->u.id);
+                break;
+            case EXPR_CALL_FUNC:
+                usa(el, e->u.func.nome);
+                percorre_exprs(el, e->u.func.args_lista);
+                break;
+            case EXPR_BIN:
+                percorre_exprs(el, e->u.bin.esq);
+                percorre_exprs(el, e->u.bin.dir);
+                break;
+            case EXPR_UN:
+                percorre_exprs(el, e->u.un.arg);
+                break;
+        }
+    }
+}
+
+// A expressão pode ser descartada: não chama nada nem divide por algo que
+// possa ser 0 (ou -1, que estoura com INT_MIN)
+static int sem_efeitos(Eliminacao* el, const Expr* e) {
+    const Nome *n;
+    switch (e->tipo) {
+        case EXPR_NUM:
+        case EXPR_BOOL:
+            return 1;
+        case EXPR_VAR:
+            n = resolve(el, e->u.id);
+            return n != NULL && n->subrot == NULL;
+        case EXPR_CALL_FUNC:
+            return 0;
+        case EXPR_BIN:
+            if (e->u.bin.op == DIV && (e->u.bin.dir->tipo != EXPR_NUM || e->u.bin.dir->u.ival == 0
+                                       || e->u.bin.dir->u.ival == -1))
+                return 0;
+            return sem_efeitos(el, e->u.bin.esq) && sem_efeitos(el, e->u.bin.dir);
+        case EXPR_UN:
+            return sem_efeitos(el, e->u.un.arg);
+    }
+    return 0;
+}
+
+static void percorre_cmds(Eliminacao* el, Comando* c) {
+    for (; c != NULL; c = c->prox) {
+        switch (c->tipo) {
+            case CMD_ATRIB: {
+                // A expressão de uma atribuição já eliminada não lê nada
+                Nome *n = resolve(el, c->u.atrib.nome_var);
+                if (n != NULL && n->var != NULL && n->var->morta) {
+                    n->atribuicoes++;
+                    break;
+                }
+                percorre_exprs(el, c->u.atrib.expr);
+                if (n == NULL || n->var == NULL) break;
+                if (sem_efeitos(el, c->u.atrib.expr))
+                    n->atribuicoes++;
+                else
+                    n->usado = 1;
+            } break;
+
+            case CMD_IF:
+                percorre_exprs(el, c->u.cond.cond);
+                percorre_cmds(el, c->u.cond.then_cmd);
+                percorre_cmds(el, c->u.cond.else_cmd);
+                break;
+
+            case CMD_WHILE:
+                percorre_exprs(el, c->u.loop.cond);
+                percorre_cmds(el, c->u.loop.body);
+                break;
+
+            case CMD_READ:
+                for (IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    usa(el, id->nome);
+                break;
+
+            case CMD_WRITE:
+                percorre_exprs(el, c->u.escrita.lista_exp);
+                break;
+
+            case CMD_CALL_PROC:
+                usa(el, c->u.proc_call.nome);
+                percorre_exprs(el, c->u.proc_call.args_lista);
+                break;
+
+            case CMD_COMPOSTO:
+                percorre_cmds(el, c->u.composto->comandos);
+                break;
+        }
+    }
+}
+
+// Marca as variáveis de `t` que não foram lidas
+static void marca_variaveis(const Nomes* t, EliminacaoCodigo* total) {
+    for (int k = 0; k < t->cap; k++) {
+        const Nome *n = &t->itens[k];
+        if (n->nome == NULL || n->var == NULL || n->usado) continue;
+        n->var->morta = 1;
+        total->variaveis++;
+        total->atribuicoes += n->atribuicoes;
+    }
+}
+
+static void percorre_subrotina(Eliminacao* el, Decl* d, EliminacaoCodigo* total) {
+    nomes_inicia(&el->locais);
+    el->em_subrotina = 1;
+
+    // Parâmetros antes das locais, como na instalação
+    for (ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox)
+        for (IdList *id = p->ids; id != NULL; id = id->prox)
+            nomes_declara(&el->locais, id->nome);
+    declara_vars(&el->locais, d->u.subrot.bloco->decls_var);
+
+    percorre_cmds(el, d->u.subrot.bloco->comandos);
+    marca_variaveis(&el->locais, total);
+
+    el->em_subrotina = 0;
+    free(el->locais.itens);
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+// Um percurso do programa a partir do principal; as marcas se acumulam e
+// o total conta todas, não só as novas
+static EliminacaoCodigo rodada(Programa* p) {
+    Bloco *b = p->bloco_principal;
+    EliminacaoCodigo total = { 0, 0, 0 };
+    Eliminacao el = { .em_subrotina = 0 };
+
+    nomes_inicia(&el.globais);
+    nomes_declara(&el.globais, p->nome);
+    declara_vars(&el.globais, b->decls_var);
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        Nome *n = nomes_declara(&el.globais, d->u.subrot.nome);
+        if (n != NULL) n->subrot = d;
+    }
+
+    percorre_cmds(&el, b->comandos);
+    while (el.num_pendentes > 0)
+        percorre_subrotina(&el, el.pendentes[--el.num_pendentes], &total);
+    marca_variaveis(&el.globais, &total);
+
+    // Uma declaração repetida é ignorada pela análise: não é marcada
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        Nome *n = nomes_busca(&el.globais, d->u.subrot.nome);
+        if (n->subrot == d && !n->usado) {
+            d->morta = 1;
+            total.subrotinas++;
+        }
+    }
+
+    free(el.globais.itens);
+    free(el.pendentes);
+    return total;
+}
+
+EliminacaoCodigo elimina_codigo_morto(Programa* p) {
+    // Eliminar `x := y + 1` pode deixar `y` sem leituras: repete até não
+    // haver variável nova
+    EliminacaoCodigo total = rodada(p), anterior;
+    do {
+        anterior = total;
+        total = rodada(p);
+    } while (total.variaveis > anterior.variaveis);
+    return total;
+}
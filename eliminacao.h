@@ -0,0 +1,37 @@
+#ifndef ELIMINACAO_H
+#define ELIMINACAO_H
+
+#include "ast.h"
+
+// Eliminação de código morto, feita na AST antes da análise semântica.
+// As sub-rotinas alcançáveis são as chamadas (com ou sem parênteses) a
+// partir do programa principal, e delas transitivamente; as demais são
+// marcadas `morta` na declaração e não são geradas. Uma variável (global
+// ou local, não parâmetro) que nunca é lida no código alcançável, nem por
+// read, e cujas atribuições não têm efeitos (nenhuma chamada e nenhuma
+// divisão que possa falhar) também é marcada: ela não recebe posição na
+// memória e as atribuições a ela não geram código.
+//
+// Nada sai da AST: a análise semântica continua vendo tudo, então os
+// erros do código eliminado ainda são informados, e o hash estrutural das
+// declarações (a chave do cache) não muda. As atribuições a uma global
+// eliminada dependem dela no cache como qualquer uso, e a sua assinatura
+// (sem deslocamento) distingue as duas situações.
+//
+// Os nomes são resolvidos como na análise: locais e parâmetros escondem
+// as globais e, se um nome é declarado duas vezes no mesmo escopo, vale a
+// primeira declaração. Uma variável lida só na expressão de uma
+// atribuição eliminada também é eliminada (o percurso se repete até não
+// haver novas).
+//
+// Precisa do programa inteiro, então não se aplica a --fluxo.
+
+typedef struct {
+    int subrotinas;     // Inalcançáveis
+    int variaveis;      // Nunca lidas
+    int atribuicoes;    // Às variáveis eliminadas, no código alcançável
+} EliminacaoCodigo;
+
+EliminacaoCodigo elimina_codigo_morto(Programa* p);
+
+#endif
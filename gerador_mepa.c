@@ -0,0 +1,759 @@
+#include "gerador_mepa.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// CHSR cujo operando d (profundidade do chamado) é preenchido no final,
+// já que a própria sub-rotina pode ser chamada antes de terminada
+typedef struct {
+    int idx;
+    Simbolo* chamado;
+} ChamadaPendente;
+
+// Chamada feita numa parte isolada: o total de pilha do chamado, que o
+// registro do chamador precisa, só é conhecido na junção
+typedef struct {
+    int altura;
+    Simbolo* chamado;
+} ChamadaFeita;
+
+// Rótulo provisório de uma parte isolada para a entrada de uma sub-rotina
+typedef struct {
+    int rotulo;
+    Simbolo* chamado;
+} RotuloExterno;
+
+// Fragmento gerado nesta compilação, guardado no cache ao final (depois de
+// preenchidos os CHSR pendentes)
+typedef struct {
+    ChaveCache chave;
+    DependenciasCache* deps;
+    int ini, fim;          // Instruções
+    int r_ini, r_fim;      // Rótulos
+    int linha_base;
+    int info[CACHE_NUM_INFO];
+    double tempo;
+} FragmentoNovo;
+
+struct Gerador {
+    TabelaSimbolos* ts;
+    CodigoMepa* cod;
+    ModoGeracao modo;
+    CacheCompilacao* cache;
+    int num_globais;
+    int inpp;              // Índice do INPP, anotado ao final
+    int r_principal;       // Rótulo do principal (-1 até a primeira sub-rotina)
+
+    // Altura da pilha de operandos no ponto corrente do código
+    Simbolo* subrot;       // Sub-rotina em geração (NULL no principal)
+    int altura;
+    int altura_max;
+    int chamadas_max;      // Maior altura + pilha_total de um chamado
+    int recursivo;         // O total não é limitado estaticamente
+
+    ChamadaPendente* pendentes;
+    int num_pendentes;
+    int cap_pendentes;
+
+    FragmentoNovo* novos;
+    int num_novos;
+    int cap_novos;
+
+    // Parte isolada (gerador_cria_parte): código e rótulos próprios
+    int isolado;
+    ChamadaFeita* feitas;
+    int num_feitas;
+    int cap_feitas;
+    RotuloExterno* externos;
+    int num_externos;
+    int cap_externos;
+
+    // Rótulos dos IF e WHILE em geração, de fora para dentro
+    int* abertos;
+    int num_abertos;
+    int cap_abertos;
+
+    // Se cada comando em geração, de fora para dentro, é o último a ser
+    // executado na sub-rotina (posição terminal)
+    int* terminais;
+    int num_terminais;
+    int cap_terminais;
+    int ini_corpo;         // Primeira instrução depois da entrada
+    int r_entrada;         // Rótulo da entrada (o do MEMC, se memoizada)
+};
+
+static void gera_expr(Gerador* g, Expr* e);
+
+// Emite uma instrução acompanhando a altura da pilha de operandos
+static int emite(Gerador* g, OpMepa op, int a, int b) {
+    int idx = mepa_emite(g->cod, op, a, b);
+    g->altura += mepa_efeito_pilha(&g->cod->instrs[idx]);
+    if (g->altura > g->altura_max) g->altura_max = g->altura;
+    return idx;
+}
+
+// ======================================================================
+// ACESSO A VARIÁVEIS
+// ======================================================================
+
+static void gera_carrega(Gerador* g, NivelEscopo nivel, int desloc) {
+    if (g->modo == MODO_CLASSICO)
+        emite(g, MEPA_CRVL, nivel, desloc);
+    else
+        emite(g, nivel == NIVEL_GLOBAL ? MEPA_CRGB : MEPA_CRLC, desloc, 0);
+}
+
+static void gera_armazena(Gerador* g, NivelEscopo nivel, int desloc) {
+    if (g->modo == MODO_CLASSICO)
+        emite(g, MEPA_ARMZ, nivel, desloc);
+    else
+        emite(g, nivel == NIVEL_GLOBAL ? MEPA_ARGB : MEPA_ARLC, desloc, 0);
+}
+
+// Armazena o topo da pilha na variável `nome` (ou no retorno da função)
+static void gera_armazena_nome(Gerador* g, const char* nome) {
+    Simbolo *s = ts_busca(g->ts, nome);
+    if (s->categoria == CAT_FUNCAO)
+        gera_armazena(g, NIVEL_LOCAL, ts_deslocamento_retorno(s));
+    else
+        gera_armazena(g, s->nivel, s->deslocamento);
+}
+
+// ======================================================================
+// EXPRESSÕES
+// ======================================================================
+
+static OpMepa op_binario(int token) {
+    switch (token) {
+        case '+': return MEPA_SOMA;
+        case '-': return MEPA_SUBT;
+        case '*': return MEPA_MULT;
+        case DIV: return MEPA_DIVI;
+        case AND: return MEPA_CONJ;
+        case OR: return MEPA_DISJ;
+        case IGUAL: return MEPA_CMIG;
+        case DIF: return MEPA_CMDG;
+        case MENOR: return MEPA_CMME;
+        case MENOR_IGUAL: return MEPA_CMEG;
+        case MAIOR: return MEPA_CMMA;
+        case MAIOR_IGUAL: return MEPA_CMAG;
+        default: return MEPA_NADA;
+    }
+}
+
+// Garante espaço para mais um elemento no vetor *v de *cap elementos
+static void* cresce(void* v, int num, int* cap, size_t tam) {
+    if (num < *cap) return v;
+    *cap = *cap ? 2 * *cap : 64;
+    v = realloc(v, *cap * tam);
+    if (v == NULL) {
+        perror("Erro ao alocar memória para o gerador");
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+static void adiciona_pendente(Gerador* g, int idx, Simbolo* chamado) {
+    g->pendentes = cresce(g->pendentes, g->num_pendentes, &g->cap_pendentes, sizeof(ChamadaPendente));
+    g->pendentes[g->num_pendentes].idx = idx;
+    g->pendentes[g->num_pendentes].chamado = chamado;
+    g->num_pendentes++;
+}
+
+// O registro do chamado começa acima da altura corrente. Como Rascal
+// exige declaração antes do uso, só a própria sub-rotina pode ainda
+// não ter total calculado (recursão direta).
+static void conta_chamada(Gerador* g, int altura, Simbolo* s) {
+    if (s == g->subrot || s->pilha_total < 0)
+        g->recursivo = 1;
+    else if (altura + s->pilha_total > g->chamadas_max)
+        g->chamadas_max = altura + s->pilha_total;
+}
+
+// Rótulo de entrada do chamado; numa parte isolada, um provisório
+static int rotulo_chamado(Gerador* g, Simbolo* s) {
+    if (!g->isolado) return s->rotulo;
+
+    g->externos = cresce(g->externos, g->num_externos, &g->cap_externos, sizeof(RotuloExterno));
+    RotuloExterno *e = &g->externos[g->num_externos++];
+    e->rotulo = mepa_novo_rotulo(g->cod);
+    e->chamado = s;
+    return e->rotulo;
+}
+
+// O registro do chamado começa `altura` posições acima da base das
+// ligações do chamador; numa parte isolada, contado só na junção
+static void registra_chamada(Gerador* g, int altura, Simbolo* s) {
+    if (g->isolado) {
+        g->feitas = cresce(g->feitas, g->num_feitas, &g->cap_feitas, sizeof(ChamadaFeita));
+        g->feitas[g->num_feitas].altura = altura;
+        g->feitas[g->num_feitas].chamado = s;
+        g->num_feitas++;
+    } else {
+        conta_chamada(g, altura, s);
+    }
+}
+
+static void gera_chamada(Gerador* g, Simbolo* s, Expr* args) {
+    if (s->categoria == CAT_FUNCAO)
+        emite(g, MEPA_AMEM, 1, 0); // Espaço para o valor de retorno
+
+    for (Expr *a = args; a != NULL; a = a->prox)
+        gera_expr(g, a);
+
+    if (g->modo == MODO_CLASSICO) {
+        emite(g, MEPA_CHPR, rotulo_chamado(g, s), 0);
+    } else {
+        int idx = emite(g, MEPA_CHSR, rotulo_chamado(g, s), s->num_locais);
+        adiciona_pendente(g, idx, s);
+    }
+
+    registra_chamada(g, g->altura, s);
+    g->altura -= s->num_params; // Fica só o valor de retorno (funções)
+}
+
+// Rótulo da primeira instrução do corpo da sub-rotina em geração (a
+// entrada, no modo de dois níveis), posto agora se ainda não tiver
+static int rotulo_corpo(Gerador* g) {
+    CodigoMepa *c = g->cod;
+    if (g->ini_corpo == c->num_instrs) {
+        if (c->rotulo_pendente < 0) mepa_rotula_proxima(c, mepa_novo_rotulo(c));
+        return c->rotulo_pendente;
+    }
+    if (c->instrs[g->ini_corpo].rotulo < 0) c->instrs[g->ini_corpo].rotulo = mepa_novo_rotulo(c);
+    return c->instrs[g->ini_corpo].rotulo;
+}
+
+// Chamada em posição terminal: o registro corrente é reaproveitado, com
+// os argumentos no lugar dos parâmetros, e o chamado retorna direto a
+// quem chamou esta sub-rotina (numa função, o retorno dela fica no mesmo
+// lugar). Na recursão terminal o registro é o mesmo e basta desviar para
+// o corpo; para outra sub-rotina, com o mesmo número de parâmetros, o
+// CTSR troca as locais. Retorna 0 (nada gerado) se não se aplica.
+static int gera_chamada_terminal(Gerador* g, Simbolo* s, Expr* args) {
+    Simbolo *atual = g->subrot;
+    if (atual == NULL || s->num_params != atual->num_params) return 0;
+    if (s != atual && g->modo == MODO_CLASSICO) return 0;
+
+    for (Expr *a = args; a != NULL; a = a->prox)
+        gera_expr(g, a);
+    for (int j = s->num_params - 1; j >= 0; j--)
+        gera_armazena(g, NIVEL_LOCAL, j - (s->num_params + 2));
+
+    if (s == atual) {
+        emite(g, MEPA_DSVS, rotulo_corpo(g), 0);
+    } else {
+        int idx = emite(g, MEPA_CTSR, rotulo_chamado(g, s), s->num_locais);
+        adiciona_pendente(g, idx, s);
+        registra_chamada(g, -(2 + atual->num_locais), s);
+    }
+    return 1;
+}
+
+static void gera_expr(Gerador* g, Expr* e) {
+    Simbolo *s;
+
+    switch (e->tipo) {
+        case EXPR_NUM:
+        case EXPR_BOOL:
+            emite(g, MEPA_CRCT, e->u.ival, 0);
+            break;
+
+        case EXPR_VAR:
+            s = ts_busca(g->ts, e->u.id);
+            if (s->categoria == CAT_FUNCAO)
+                gera_chamada(g, s, NULL);
+            else
+                gera_carrega(g, s->nivel, s->deslocamento);
+            break;
+
+        case EXPR_CALL_FUNC:
+            s = ts_busca(g->ts, e->u.func.nome);
+            gera_chamada(g, s, e->u.func.args_lista);
+            break;
+
+        case EXPR_BIN:
+            gera_expr(g, e->u.bin.esq);
+            gera_expr(g, e->u.bin.dir);
+            emite(g, op_binario(e->u.bin.op), 0, 0);
+            break;
+
+        case EXPR_UN:
+            gera_expr(g, e->u.un.arg);
+            emite(g, e->u.un.op == NOT ? MEPA_NEGA : MEPA_INVR, 0, 0);
+            break;
+    }
+}
+
+// ======================================================================
+// COMANDOS
+// ======================================================================
+
+// Cada comando é gerado pelos ganchos do passe de geração (percurso.h);
+// as expressões, inteiras, depois que os passes anteriores terminaram com
+// elas (a avaliação parcial e a ordenação mudam a árvore no pos).
+
+static void abre_rotulo(Gerador* g, int rotulo) {
+    g->abertos = cresce(g->abertos, g->num_abertos, &g->cap_abertos, sizeof(int));
+    g->abertos[g->num_abertos++] = rotulo;
+}
+
+static void empilha_terminal(Gerador* g, int terminal) {
+    g->terminais = cresce(g->terminais, g->num_terminais, &g->cap_terminais, sizeof(int));
+    g->terminais[g->num_terminais++] = terminal;
+}
+
+// O último comando de uma lista em posição terminal (o corpo, os ramos
+// de um IF terminal, um bloco terminal); o corpo de um WHILE nunca é
+static int terminal(const Gerador* g, const Comando* c) {
+    return c->prox == NULL && g->terminais[g->num_terminais - 1];
+}
+
+static int gr_pre_cmd(void* estado, Comando* c) {
+    Gerador *g = estado;
+    g->cod->linha_corrente = cmd_linha(c);
+
+    switch (c->tipo) {
+        case CMD_IF:
+            abre_rotulo(g, mepa_novo_rotulo(g->cod)); // Do else
+            empilha_terminal(g, terminal(g, c));
+            break;
+
+        case CMD_WHILE: {
+            int r_inicio = mepa_novo_rotulo(g->cod);
+            int r_fim = mepa_novo_rotulo(g->cod);
+            mepa_define_rotulo(g->cod, r_inicio);
+            abre_rotulo(g, r_inicio);
+            abre_rotulo(g, r_fim);
+            empilha_terminal(g, 0);
+        } break;
+
+        case CMD_COMPOSTO:
+            empilha_terminal(g, terminal(g, c));
+            break;
+
+        case CMD_READ:
+            for (IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox) {
+                emite(g, MEPA_LEIT, 0, 0);
+                gera_armazena_nome(g, id->nome);
+            }
+            break;
+
+        default:
+            break;
+    }
+    return 1;
+}
+
+// Depois da condição, o desvio para o else; depois do then, o desvio
+// sobre o else, cujo fim passa a ser o rótulo aberto
+static void gr_entre_if(void* estado, Comando* c, int k, Expr* cond) {
+    Gerador *g = estado;
+    int *r = &g->abertos[g->num_abertos - 1];
+    if (k == 0) {
+        gera_expr(g, cond);
+        emite(g, MEPA_DSVF, *r, 0);
+    } else if (c->u.cond.else_cmd) {
+        int r_fim = mepa_novo_rotulo(g->cod);
+        g->cod->linha_corrente = cmd_linha(c);
+        emite(g, MEPA_DSVS, r_fim, 0);
+        mepa_define_rotulo(g->cod, *r);
+        *r = r_fim;
+    }
+}
+
+static void gr_entre_while(void* estado, Comando* c, int k, Expr* cond) {
+    Gerador *g = estado;
+    (void)c; (void)k;
+    gera_expr(g, cond);
+    emite(g, MEPA_DSVF, g->abertos[g->num_abertos - 1], 0);
+}
+
+static void gr_entre_write(void* estado, Comando* c, int k, Expr* e) {
+    Gerador *g = estado;
+    (void)c; (void)k;
+    gera_expr(g, e);
+    emite(g, MEPA_IMPR, 0, 0);
+}
+
+// Função chamada por `e`, se for uma chamada de função (NULL se não)
+static Simbolo* funcao_chamada(Gerador* g, const Expr* e) {
+    const char *nome = e->tipo == EXPR_CALL_FUNC ? e->u.func.nome : e->tipo == EXPR_VAR ? e->u.id : NULL;
+    Simbolo *s = nome ? ts_busca(g->ts, nome) : NULL;
+    return s != NULL && s->categoria == CAT_FUNCAO ? s : NULL;
+}
+
+static void gr_pos_atrib(void* estado, Comando* c) {
+    Gerador *g = estado;
+    Simbolo *s = ts_busca(g->ts, c->u.atrib.nome_var);
+    // Variável eliminada: a expressão não tem efeitos
+    if (s->morta) return;
+
+    // `f := g(...)` no fim da função f: o retorno de g já é o de f
+    Expr *e = c->u.atrib.expr;
+    Simbolo *chamado = s == g->subrot && terminal(g, c) ? funcao_chamada(g, e) : NULL;
+    if (chamado != NULL && gera_chamada_terminal(g, chamado, e->tipo == EXPR_CALL_FUNC ? e->u.func.args_lista : NULL))
+        return;
+
+    gera_expr(g, e);
+    gera_armazena_nome(g, c->u.atrib.nome_var);
+}
+
+static void gr_pos_if(void* estado, Comando* c) {
+    Gerador *g = estado;
+    (void)c;
+    mepa_define_rotulo(g->cod, g->abertos[--g->num_abertos]);
+    g->num_terminais--;
+}
+
+static void gr_pos_while(void* estado, Comando* c) {
+    Gerador *g = estado;
+    int r_fim = g->abertos[--g->num_abertos];
+    int r_inicio = g->abertos[--g->num_abertos];
+    g->cod->linha_corrente = cmd_linha(c);
+    emite(g, MEPA_DSVS, r_inicio, 0);
+    mepa_define_rotulo(g->cod, r_fim);
+    g->num_terminais--;
+}
+
+static void gr_pos_composto(void* estado, Comando* c) {
+    Gerador *g = estado;
+    (void)c;
+    g->num_terminais--;
+}
+
+static void gr_pos_proc(void* estado, Comando* c) {
+    Gerador *g = estado;
+    Simbolo *s = ts_busca(g->ts, c->u.proc_call.nome);
+    if (terminal(g, c) && gera_chamada_terminal(g, s, c->u.proc_call.args_lista)) return;
+    gera_chamada(g, s, c->u.proc_call.args_lista);
+}
+
+// ======================================================================
+// SUB-ROTINAS E PROGRAMA
+// ======================================================================
+
+// No modo de dois níveis a entrada (salvar a base e alocar as locais) é
+// feita pelo próprio CHSR, então o rótulo vai direto no primeiro comando.
+// Registro: endereço de retorno, base antiga, locais e operandos
+static void fecha_registro(Gerador* g, Simbolo* s) {
+    s->pilha_total = g->recursivo ? -1 :
+        2 + s->num_locais + (g->altura_max > g->chamadas_max ? g->altura_max : g->chamadas_max);
+}
+
+// Programa principal (s == NULL): a altura conta a partir do início da
+// memória, onde estão as globais. Numa parte isolada a entrada da
+// sub-rotina é o rótulo 0 da parte.
+static void gr_inicio(void* estado, TabelaSimbolos* ts, Simbolo* s) {
+    Gerador *g = estado;
+    (void)ts;
+    g->num_abertos = 0;
+    g->num_terminais = 0;
+    empilha_terminal(g, s != NULL);
+    g->subrot = s;
+    g->chamadas_max = 0;
+    g->recursivo = 0;
+
+    if (s == NULL) {
+        g->altura = g->altura_max = g->num_globais;
+        return;
+    }
+
+    int entrada = g->isolado ? mepa_novo_rotulo(g->cod) : s->rotulo;
+    mepa_nomeia_rotulo(g->cod, entrada, s->nome);
+    g->cod->linha_corrente = s->decl->linha;
+    mepa_rotula_proxima(g->cod, entrada);
+    g->r_entrada = entrada;
+
+    if (g->modo == MODO_CLASSICO) {
+        mepa_emite(g->cod, MEPA_ENPR, NIVEL_LOCAL, 0);
+        if (s->num_locais > 0) mepa_emite(g->cod, MEPA_AMEM, s->num_locais, 0);
+    } else if (s->decl->memoizada) {
+        // Função memoizada (memoizacao.h): a tabela antes do corpo
+        mepa_emite(g->cod, MEPA_MEMC, s->num_locais, s->num_params);
+    }
+    g->ini_corpo = g->cod->num_instrs;
+    g->altura = g->altura_max = 0;
+}
+
+static void gr_fim(void* estado, Simbolo* s) {
+    Gerador *g = estado;
+
+    if (s == NULL) {
+        if (g->num_globais > 0) mepa_emite(g->cod, MEPA_DMEM, g->num_globais, 0);
+        mepa_emite(g->cod, MEPA_PARA, 0, 0);
+        return;
+    }
+
+    g->cod->linha_corrente = s->decl->linha;
+
+    // Numa parte isolada o total só é calculado na junção
+    s->pilha_max = g->altura_max;
+    if (!g->isolado) fecha_registro(g, s);
+
+    if (g->modo == MODO_CLASSICO) {
+        if (s->num_locais > 0) emite(g, MEPA_DMEM, s->num_locais, 0);
+        emite(g, MEPA_RTPR, NIVEL_LOCAL, s->num_params);
+    } else {
+        if (s->decl->memoizada) emite(g, MEPA_MEMG, g->r_entrada, 0);
+        emite(g, MEPA_RTSR, s->num_locais, s->num_params);
+    }
+}
+
+static const Passe passe_geracao = {
+    .nome = "geração de código",
+    .exige_sem_erros = 1,
+    .inicio = gr_inicio,
+    .fim = gr_fim,
+    .pre_cmd = {
+        [CMD_ATRIB] = gr_pre_cmd, [CMD_IF] = gr_pre_cmd, [CMD_WHILE] = gr_pre_cmd, [CMD_READ] = gr_pre_cmd,
+        [CMD_WRITE] = gr_pre_cmd, [CMD_CALL_PROC] = gr_pre_cmd, [CMD_COMPOSTO] = gr_pre_cmd,
+    },
+    .entre_cmd = { [CMD_IF] = gr_entre_if, [CMD_WHILE] = gr_entre_while, [CMD_WRITE] = gr_entre_write },
+    .pos_cmd = {
+        [CMD_ATRIB] = gr_pos_atrib, [CMD_IF] = gr_pos_if, [CMD_WHILE] = gr_pos_while,
+        [CMD_CALL_PROC] = gr_pos_proc, [CMD_COMPOSTO] = gr_pos_composto,
+    },
+};
+
+// A geração é o último passe do percurso `p` (NULL: sozinha); retorna 0
+// se ela parou por erros semânticos
+static int gera_comandos(Gerador* g, Simbolo* s, Comando* comandos, Percurso* p) {
+    Percurso so_geracao;
+    if (p == NULL) {
+        percurso_inicia(&so_geracao, PERCURSO_SEPARADO);
+        p = &so_geracao;
+    }
+    percurso_adiciona(p, &passe_geracao, g);
+    return s != NULL ? percorre_subrotina(p, g->ts, s) : percorre_principal(p, g->ts, comandos);
+}
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Registra o fragmento [ini, fim) gerado agora, a ser guardado no cache
+static void novo_fragmento(Gerador* g, const ChaveCache* chave, Simbolo* s, Comando* comandos, int ini,
+                           int r_ini, int linha_base, const int info[CACHE_NUM_INFO], double tempo) {
+    if (g->num_novos == g->cap_novos) {
+        g->cap_novos = g->cap_novos ? 2 * g->cap_novos : 64;
+        g->novos = realloc(g->novos, g->cap_novos * sizeof(FragmentoNovo));
+        if (g->novos == NULL) {
+            perror("Erro ao alocar memória para o gerador");
+            exit(EXIT_FAILURE);
+        }
+    }
+    FragmentoNovo *f = &g->novos[g->num_novos++];
+    f->chave = *chave;
+    f->deps = cache_dependencias(g->cache, g->ts, s, comandos);
+    f->ini = ini;
+    f->fim = g->cod->num_instrs;
+    f->r_ini = r_ini;
+    f->r_fim = g->cod->num_rotulos;
+    f->linha_base = linha_base;
+    memcpy(f->info, info, sizeof(f->info));
+    f->tempo = tempo;
+}
+
+// ======================================================================
+// INTERFACE
+// ======================================================================
+
+Gerador* gerador_cria(TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo, CacheCompilacao* cache) {
+    Gerador *g = calloc(1, sizeof(Gerador));
+    if (g == NULL) {
+        perror("Erro ao alocar memória para o gerador");
+        exit(EXIT_FAILURE);
+    }
+    g->ts = ts;
+    g->cod = saida;
+    g->modo = modo;
+    g->cache = cache;
+    g->num_globais = ts->global->prox_deslocamento;
+    g->r_principal = -1;
+
+    g->inpp = mepa_emite(saida, MEPA_INPP, -1, -1);
+    if (g->num_globais > 0) mepa_emite(saida, MEPA_AMEM, g->num_globais, 0);
+    return g;
+}
+
+// Antes da primeira sub-rotina, o desvio para o principal
+static void inicia_subrotina(Gerador* g, Simbolo* s) {
+    if (g->r_principal < 0) {
+        g->r_principal = mepa_novo_rotulo(g->cod);
+        mepa_emite(g->cod, MEPA_DSVS, g->r_principal, 0);
+    }
+    s->rotulo = mepa_novo_rotulo(g->cod);
+}
+
+void gerador_subrotina(Gerador* g, Simbolo* s, const FragmentoCache* f, const ChaveCache* chave,
+                       double tempo_analise, Percurso* p) {
+    inicia_subrotina(g, s);
+
+    int info[CACHE_NUM_INFO] = { 0 };
+    if (f != NULL) {
+        mepa_nomeia_rotulo(g->cod, s->rotulo, s->nome);
+        cache_reaproveita(g->cache, f, g->cod, g->ts, s->rotulo, s->decl->linha, info);
+        s->pilha_max = info[0];
+        s->pilha_total = info[1];
+        g->cod->linha_corrente = s->decl->linha;
+        return;
+    }
+
+    double inicio = chave ? agora() : 0;
+    int ini = g->cod->num_instrs;
+    if (gera_comandos(g, s, NULL, p) && chave != NULL) {
+        info[0] = s->pilha_max;
+        info[1] = s->pilha_total;
+        novo_fragmento(g, chave, s, NULL, ini, s->rotulo, s->decl->linha, info, tempo_analise + agora() - inicio);
+    }
+}
+
+void gerador_principal(Gerador* g, Comando* comandos, const FragmentoCache* f, const ChaveCache* chave,
+                       double tempo_analise, Percurso* p) {
+    if (g->r_principal >= 0) mepa_define_rotulo(g->cod, g->r_principal);
+
+    // As linhas do fragmento são relativas à do primeiro comando
+    int linha_base = comandos ? comandos->linha : 0;
+    int r_ini = g->cod->num_rotulos;
+    int info[CACHE_NUM_INFO];
+
+    if (f != NULL) {
+        cache_reaproveita(g->cache, f, g->cod, g->ts, r_ini, linha_base, info);
+        g->altura_max = info[0];
+        g->chamadas_max = info[1];
+        g->recursivo = info[2];
+        return;
+    }
+
+    double inicio = chave ? agora() : 0;
+    int ini = g->cod->num_instrs;
+    if (gera_comandos(g, NULL, comandos, p) && chave != NULL) {
+        info[0] = g->altura_max;
+        info[1] = g->chamadas_max;
+        info[2] = g->recursivo;
+        novo_fragmento(g, chave, NULL, comandos, ini, r_ini, linha_base, info, tempo_analise + agora() - inicio);
+    }
+}
+
+void gerador_finaliza(Gerador* g) {
+    CodigoMepa *saida = g->cod;
+
+    if (g->modo == MODO_DOIS_NIVEIS) {
+        for (int k = 0; k < g->num_pendentes; k++)
+            saida->instrs[g->pendentes[k].idx].c = g->pendentes[k].chamado->pilha_max;
+
+        saida->instrs[g->inpp].a = g->altura_max;
+        saida->instrs[g->inpp].b = g->recursivo ? 0 :
+            (g->altura_max > g->chamadas_max ? g->altura_max : g->chamadas_max);
+    }
+
+    for (int k = 0; k < g->num_novos; k++) {
+        FragmentoNovo *f = &g->novos[k];
+        cache_guarda(g->cache, f->chave, f->deps, saida, f->ini, f->fim, f->r_ini, f->r_fim,
+                     f->linha_base, f->info, f->tempo);
+    }
+    g->num_novos = 0;
+
+    gerador_descarta(g);
+}
+
+Gerador* gerador_cria_parte(TabelaSimbolos* ts, ModoGeracao modo) {
+    Gerador *g = calloc(1, sizeof(Gerador));
+    CodigoMepa *cod = malloc(sizeof(CodigoMepa));
+    if (g == NULL || cod == NULL) {
+        perror("Erro ao alocar memória para o gerador");
+        exit(EXIT_FAILURE);
+    }
+    mepa_inicia(cod);
+    g->ts = ts;
+    g->cod = cod;
+    g->modo = modo;
+    g->r_principal = -1;
+    g->isolado = 1;
+    return g;
+}
+
+void gerador_parte_subrotina(Gerador* parte, Simbolo* s, Percurso* p) {
+    gera_comandos(parte, s, NULL, p);
+}
+
+void gerador_junta(Gerador* g, Gerador* parte, Simbolo* s) {
+    CodigoMepa *p = parte->cod;
+    inicia_subrotina(g, s);
+
+    // Os rótulos próprios da parte recebem números novos na ordem em que
+    // foram criados, como se ela tivesse sido gerada aqui; os provisórios
+    // viram as entradas dos chamados, já numeradas
+    int *mapa = malloc((p->num_rotulos > 0 ? p->num_rotulos : 1) * sizeof(int));
+    if (mapa == NULL) {
+        perror("Erro ao alocar memória para o gerador");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < p->num_rotulos; r++) mapa[r] = -1;
+    for (int k = 0; k < parte->num_externos; k++) mapa[parte->externos[k].rotulo] = parte->externos[k].chamado->rotulo;
+    mapa[0] = s->rotulo;
+    for (int r = 1; r < p->num_rotulos; r++)
+        if (mapa[r] < 0) mapa[r] = mepa_novo_rotulo(g->cod);
+
+    int base = g->cod->num_instrs;
+    for (int k = 0; k < p->num_instrs; k++) {
+        const InstrMepa *i = &p->instrs[k];
+        int idx = mepa_emite(g->cod, i->op, mepa_op_usa_rotulo(i->op) ? mapa[i->a] : i->a, i->b);
+        InstrMepa *j = &g->cod->instrs[idx];
+        j->c = i->c;
+        j->rotulo = i->rotulo >= 0 ? mapa[i->rotulo] : -1;
+        j->linha = i->linha;
+    }
+    mepa_nomeia_rotulo(g->cod, s->rotulo, s->nome);
+    g->cod->linha_corrente = p->linha_corrente;
+    free(mapa);
+
+    for (int k = 0; k < parte->num_pendentes; k++)
+        adiciona_pendente(g, base + parte->pendentes[k].idx, parte->pendentes[k].chamado);
+
+    // As sub-rotinas anteriores já estão juntadas: os totais dos chamados
+    // são conhecidos
+    g->subrot = s;
+    g->altura_max = parte->altura_max;
+    g->chamadas_max = 0;
+    g->recursivo = 0;
+    for (int k = 0; k < parte->num_feitas; k++)
+        conta_chamada(g, parte->feitas[k].altura, parte->feitas[k].chamado);
+    fecha_registro(g, s);
+
+    gerador_descarta(parte);
+}
+
+void gerador_descarta(Gerador* g) {
+    for (int k = 0; k < g->num_novos; k++) cache_dependencias_libera(g->novos[k].deps);
+    if (g->isolado) {
+        mepa_libera(g->cod);
+        free(g->cod);
+        free(g->feitas);
+        free(g->externos);
+    }
+    free(g->pendentes);
+    free(g->novos);
+    free(g->abertos);
+    free(g->terminais);
+    free(g);
+}
+
+void gera_codigo(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo) {
+    Gerador *g = gerador_cria(ts, saida, modo, NULL);
+    Bloco *b = p->bloco_principal;
+
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        Simbolo *s = ts_busca_escopo(ts->global, d->u.subrot.nome);
+        if (s == NULL || s->decl != d) continue; // Declaração ignorada (duplicada)
+        gerador_subrotina(g, s, NULL, NULL, 0, NULL);
+    }
+
+    gerador_principal(g, b->comandos, NULL, NULL, 0, NULL);
+    gerador_finaliza(g);
+}
@@ -0,0 +1,61 @@
+#ifndef GERADOR_MEPA_H
+#define GERADOR_MEPA_H
+
+#include "ast.h"
+#include "mepa.h"
+#include "tabela_simbolos.h"
+#include "cache_compilacao.h"
+#include "percurso.h"
+
+// Forma de endereçamento das variáveis e de chamada das sub-rotinas
+typedef enum {
+    // Usa os dois níveis léxicos de Rascal: CRGB/ARGB para globais,
+    // CRLC/ARLC para locais e CHSR/RTSR na chamada e no retorno
+    MODO_DOIS_NIVEIS,
+    // MEPA clássica: CRVL/ARMZ k,n com display e ENPR/AMEM/DMEM/RTPR
+    MODO_CLASSICO
+} ModoGeracao;
+
+// Gera o código MEPA de um programa já analisado semanticamente
+// (a tabela `ts` deve ser a preenchida por analisa_semantica).
+void gera_codigo(Programa* p, TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo);
+
+// Geração em partes, na ordem do programa, para quem processa uma
+// sub-rotina de cada vez (compilacao.h). As sub-rotinas chamadas precisam
+// já ter sido geradas (o que a regra de declarar antes de usar garante).
+//   gerador_cria        emite o INPP e a alocação das globais, já
+//                       instaladas em `ts`
+//   gerador_subrotina   gera `s` (analisada), ou copia o fragmento `f` do
+//                       cache se não for NULL
+//   gerador_principal   idem para o programa principal
+//   gerador_finaliza    preenche as profundidades (INPP e CHSR), guarda no
+//                       cache os fragmentos gerados e libera o gerador
+//   gerador_descarta    libera o gerador sem nada disso (após erros)
+// Com `chave` (pode ser NULL), o fragmento gerado é guardado no cache sob
+// ela, junto com o tempo gasto nele (`tempo_analise`, em segundos, mais o
+// da geração). A geração é o último passe do percurso `p` (percurso.h;
+// NULL: um percurso só dela): os passes de `p`, se for fundido, rodam na
+// mesma descida. Se um deles encontrar erros semânticos, a geração para e
+// o fragmento não é guardado.
+typedef struct Gerador Gerador;
+
+Gerador* gerador_cria(TabelaSimbolos* ts, CodigoMepa* saida, ModoGeracao modo, CacheCompilacao* cache);
+void gerador_subrotina(Gerador* g, Simbolo* s, const FragmentoCache* f, const ChaveCache* chave,
+                       double tempo_analise, Percurso* p);
+void gerador_principal(Gerador* g, Comando* comandos, const FragmentoCache* f, const ChaveCache* chave,
+                       double tempo_analise, Percurso* p);
+void gerador_finaliza(Gerador* g);
+void gerador_descarta(Gerador* g);
+
+// Geração em paralelo: cada sub-rotina, já analisada, é gerada numa parte
+// isolada (gerador_cria_parte, com a visão `ts` da thread), com o seu
+// próprio buffer e os seus próprios rótulos; as chamadas levam rótulos
+// provisórios e a conta do registro (pilha_total), que depende dos totais
+// dos chamados, fica para a junção. gerador_junta incorpora a parte de `s`
+// a `g` e a libera; feita na ordem do programa, o resultado é idêntico ao
+// de gerador_subrotina.
+Gerador* gerador_cria_parte(TabelaSimbolos* ts, ModoGeracao modo);
+void gerador_parte_subrotina(Gerador* parte, Simbolo* s, Percurso* p);
+void gerador_junta(Gerador* g, Gerador* parte, Simbolo* s);
+
+#endif
@@ -0,0 +1,500 @@
+#include "grafo_chamadas.h"
+#include "tabela_simbolos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct GrafoChamadas {
+    TabelaSimbolos* ts;         // Os nomes, resolvidos como na análise
+    NoGrafo* nos;
+    int num_nos;
+    int base;                   // Ordem, no escopo global, da primeira sub-rotina
+    int* arestas;               // Os chamados de todos os nós, em sequência
+    const char** globais;       // Nome de cada global (índice: deslocamento)
+    int num_globais;
+    int num_componentes;
+    int* membros;               // membros[inicio[c], inicio[c + 1]): a componente c
+    int* inicio;
+    int** lidas;                // Conjuntos de cada componente
+    int** escritas;
+};
+
+static void* gr_malloc(size_t n, size_t tam) {
+    void *ptr = calloc(n > 0 ? n : 1, tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o grafo de chamadas");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+typedef struct {
+    int* v;
+    int num, cap;
+} Vetor;
+
+static void vetor_poe(Vetor* a, int x) {
+    if (a->num == a->cap) {
+        a->cap = a->cap ? 2 * a->cap : 64;
+        a->v = realloc(a->v, a->cap * sizeof(int));
+        if (a->v == NULL) {
+            perror("Erro ao alocar memória para o grafo de chamadas");
+            exit(EXIT_FAILURE);
+        }
+    }
+    a->v[a->num++] = x;
+}
+
+static int compara_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// ======================================================================
+// MONTAGEM
+// ======================================================================
+
+// Percurso de um nó: os fatos diretos, sem repetição (as marcas guardam o
+// último nó que registrou cada chamado ou global)
+typedef struct {
+    GrafoChamadas* g;
+    int no;
+    Vetor chamados, lidas, escritas;
+    int inicio_chamados, inicio_lidas, inicio_escritas;
+    int* marca_chamado;
+    int* marca_lida;
+    int* marca_escrita;
+} Montagem;
+
+static int no_de(const GrafoChamadas* g, const Simbolo* s) {
+    if (s == NULL || (s->categoria != CAT_FUNCAO && s->categoria != CAT_PROCEDIMENTO)) return -1;
+    return s->ordem - g->base;
+}
+
+static int global_de(const Simbolo* s) {
+    return s != NULL && s->categoria == CAT_VARIAVEL && s->nivel == NIVEL_GLOBAL ? s->deslocamento : -1;
+}
+
+static void registra(Vetor* v, int* marca, int x, int no) {
+    if (x < 0 || marca[x] == no + 1) return;
+    marca[x] = no + 1;
+    vetor_poe(v, x);
+}
+
+// Uso de `nome` como valor ou chamada
+static void usa(Montagem* m, const char* nome) {
+    Simbolo *s = ts_busca(m->g->ts, nome);
+    registra(&m->chamados, m->marca_chamado, no_de(m->g, s), m->no);
+    registra(&m->lidas, m->marca_lida, global_de(s), m->no);
+}
+
+static void escreve(Montagem* m, const char* nome) {
+    registra(&m->escritas, m->marca_escrita, global_de(ts_busca(m->g->ts, nome)), m->no);
+}
+
+static void percorre_exprs(Montagem* m, const Expr* e) {
+    for (; e != NULL; e = e->prox) {
+        switch (e->tipo) {
+            case EXPR_NUM:
+            case EXPR_BOOL:
+                break;
+            case EXPR_VAR:
+                usa(m, e->u.id);
+                break;
+            case EXPR_CALL_FUNC:
+                usa(m, e->u.func.nome);
+                percorre_exprs(m, e->u.func.args_lista);
+                break;
+            case EXPR_BIN:
+                percorre_exprs(m, e->u.bin.esq);
+                percorre_exprs(m, e->u.bin.dir);
+                break;
+            case EXPR_UN:
+                percorre_exprs(m, e->u.un.arg);
+                break;
+        }
+    }
+}
+
+static void percorre_cmds(Montagem* m, const Comando* c) {
+    NoGrafo *no = &m->g->nos[m->no];
+    for (; c != NULL; c = c->prox) {
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                percorre_exprs(m, c->u.atrib.expr);
+                escreve(m, c->u.atrib.nome_var);
+                break;
+            case CMD_IF:
+                percorre_exprs(m, c->u.cond.cond);
+                percorre_cmds(m, c->u.cond.then_cmd);
+                percorre_cmds(m, c->u.cond.else_cmd);
+                break;
+            case CMD_WHILE:
+                percorre_exprs(m, c->u.loop.cond);
+                percorre_cmds(m, c->u.loop.body);
+                break;
+            case CMD_READ:
+                no->le_entrada = 1;
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    escreve(m, id->nome);
+                break;
+            case CMD_WRITE:
+                no->escreve_saida = 1;
+                percorre_exprs(m, c->u.escrita.lista_exp);
+                break;
+            case CMD_CALL_PROC:
+                usa(m, c->u.proc_call.nome);
+                percorre_exprs(m, c->u.proc_call.args_lista);
+                break;
+            case CMD_COMPOSTO:
+                percorre_cmds(m, c->u.composto->comandos);
+                break;
+        }
+    }
+}
+
+// Percorre `comandos` como o nó `k`; as posições dos seus fatos nos
+// vetores são acertadas em fecha_nos, quando os vetores param de crescer
+static void percorre_no(Montagem* m, int k, const Comando* comandos) {
+    NoGrafo *no = &m->g->nos[k];
+    m->no = k;
+    int c0 = m->chamados.num, l0 = m->lidas.num, e0 = m->escritas.num;
+    percorre_cmds(m, comandos);
+    no->num_chamados = m->chamados.num - c0;
+    no->num_globais_lidas = m->lidas.num - l0;
+    no->num_globais_escritas = m->escritas.num - e0;
+}
+
+static void instala_vars(TabelaSimbolos* ts, Decl* d) {
+    for (; d != NULL; d = d->prox)
+        for (IdList *id = d->u.var.ids; id != NULL; id = id->prox)
+            ts_instala(ts, id->nome, CAT_VARIAVEL, d->u.var.tipo_var);
+}
+
+// ======================================================================
+// COMPONENTES (Tarjan, sem recursão)
+// ======================================================================
+
+static void componentes(GrafoChamadas* g) {
+    int n = g->num_nos, proximo = 0, topo = 0, num_quadros = 0;
+    int *indice = gr_malloc(n, sizeof(int)), *baixo = gr_malloc(n, sizeof(int));
+    int *pilha = gr_malloc(n, sizeof(int)), *na_pilha = gr_malloc(n, sizeof(int));
+    int *quadro_no = gr_malloc(n, sizeof(int)), *quadro_aresta = gr_malloc(n, sizeof(int));
+    for (int k = 0; k < n; k++) indice[k] = -1;
+
+    for (int raiz = 0; raiz < n; raiz++) {
+        if (indice[raiz] >= 0) continue;
+        quadro_no[0] = raiz;
+        quadro_aresta[0] = 0;
+        num_quadros = 1;
+        indice[raiz] = baixo[raiz] = proximo++;
+        pilha[topo++] = raiz;
+        na_pilha[raiz] = 1;
+
+        while (num_quadros > 0) {
+            int v = quadro_no[num_quadros - 1];
+            const NoGrafo *no = &g->nos[v];
+            if (quadro_aresta[num_quadros - 1] < no->num_chamados) {
+                int w = no->chamados[quadro_aresta[num_quadros - 1]++];
+                if (indice[w] < 0) {
+                    indice[w] = baixo[w] = proximo++;
+                    pilha[topo++] = w;
+                    na_pilha[w] = 1;
+                    quadro_no[num_quadros] = w;
+                    quadro_aresta[num_quadros++] = 0;
+                } else if (na_pilha[w] && indice[w] < baixo[v]) {
+                    baixo[v] = indice[w];
+                }
+                continue;
+            }
+
+            // Todos os chamados de v vistos: v fecha uma componente ou
+            // passa o seu mínimo ao chamador
+            num_quadros--;
+            if (num_quadros > 0) {
+                int u = quadro_no[num_quadros - 1];
+                if (baixo[v] < baixo[u]) baixo[u] = baixo[v];
+            }
+            if (baixo[v] != indice[v]) continue;
+            int w, tam = 0;
+            do {
+                w = pilha[--topo];
+                na_pilha[w] = 0;
+                g->nos[w].componente = g->num_componentes;
+                tam++;
+            } while (w != v);
+            if (tam > 1) {
+                for (int j = topo; j < topo + tam; j++) g->nos[pilha[j]].recursiva = 1;
+            }
+            g->num_componentes++;
+        }
+    }
+
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < g->nos[k].num_chamados; j++)
+            if (g->nos[k].chamados[j] == k) g->nos[k].recursiva = 1;
+
+    // Membros agrupados por componente, em ordem de declaração
+    g->inicio = gr_malloc(g->num_componentes + 1, sizeof(int));
+    g->membros = gr_malloc(n, sizeof(int));
+    for (int k = 0; k < n; k++) g->inicio[g->nos[k].componente + 1]++;
+    for (int c = 0; c < g->num_componentes; c++) g->inicio[c + 1] += g->inicio[c];
+    int *pos = quadro_no;
+    for (int c = 0; c < g->num_componentes; c++) pos[c] = g->inicio[c];
+    for (int k = 0; k < n; k++) g->membros[pos[g->nos[k].componente]++] = k;
+
+    free(indice);
+    free(baixo);
+    free(pilha);
+    free(na_pilha);
+    free(quadro_no);
+    free(quadro_aresta);
+}
+
+// ======================================================================
+// RESUMOS (de baixo para cima)
+// ======================================================================
+
+// União dos conjuntos (lidas ou escritas, conforme `escritas`) dos
+// membros de `c` e das componentes que eles chamam, já calculadas
+static int* une_globais(GrafoChamadas* g, int c, int escritas, int* marca, Vetor* tmp, int* num) {
+    tmp->num = 0;
+    for (int j = g->inicio[c]; j < g->inicio[c + 1]; j++) {
+        const NoGrafo *no = &g->nos[g->membros[j]];
+        const int *proprias = escritas ? no->globais_escritas : no->globais_lidas;
+        int num_proprias = escritas ? no->num_globais_escritas : no->num_globais_lidas;
+        for (int i = 0; i < num_proprias; i++)
+            registra(tmp, marca, proprias[i], c);
+        for (int i = 0; i < no->num_chamados; i++) {
+            int d = g->nos[no->chamados[i]].componente;
+            if (d == c) continue;
+            const int *conj = escritas ? g->escritas[d] : g->lidas[d];
+            const NoGrafo *rep = &g->nos[g->membros[g->inicio[d]]];
+            int tam = escritas ? rep->num_globais_escritas : rep->num_globais_lidas;
+            for (int x = 0; x < tam; x++) registra(tmp, marca, conj[x], c);
+        }
+    }
+    int *conj = gr_malloc(tmp->num, sizeof(int));
+    memcpy(conj, tmp->v, tmp->num * sizeof(int));
+    qsort(conj, tmp->num, sizeof(int), compara_int);
+    *num = tmp->num;
+    return conj;
+}
+
+static void resume(GrafoChamadas* g) {
+    int *marca_lida = gr_malloc(g->num_globais, sizeof(int));
+    int *marca_escrita = gr_malloc(g->num_globais, sizeof(int));
+    Vetor tmp = { NULL, 0, 0 };
+    g->lidas = gr_malloc(g->num_componentes, sizeof(int*));
+    g->escritas = gr_malloc(g->num_componentes, sizeof(int*));
+
+    for (int c = 0; c < g->num_componentes; c++) {
+        int le = 0, escreve = 0, num_lidas, num_escritas;
+        for (int j = g->inicio[c]; j < g->inicio[c + 1]; j++) {
+            const NoGrafo *no = &g->nos[g->membros[j]];
+            le |= no->le_entrada;
+            escreve |= no->escreve_saida;
+            for (int i = 0; i < no->num_chamados; i++) {
+                const NoGrafo *ch = &g->nos[no->chamados[i]];
+                le |= ch->le_entrada;
+                escreve |= ch->escreve_saida;
+            }
+        }
+        g->lidas[c] = une_globais(g, c, 0, marca_lida, &tmp, &num_lidas);
+        g->escritas[c] = une_globais(g, c, 1, marca_escrita, &tmp, &num_escritas);
+
+        // Daqui em diante os nós da componente apontam para o resumo dela
+        for (int j = g->inicio[c]; j < g->inicio[c + 1]; j++) {
+            NoGrafo *no = &g->nos[g->membros[j]];
+            no->le_entrada = le;
+            no->escreve_saida = escreve;
+            no->globais_lidas = g->lidas[c];
+            no->num_globais_lidas = num_lidas;
+            no->globais_escritas = g->escritas[c];
+            no->num_globais_escritas = num_escritas;
+        }
+    }
+
+    free(marca_lida);
+    free(marca_escrita);
+    free(tmp.v);
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+GrafoChamadas* grafo_constroi(Programa* p) {
+    Bloco *b = p->bloco_principal;
+    GrafoChamadas *g = gr_malloc(1, sizeof(GrafoChamadas));
+    g->ts = ts_cria();
+
+    ts_instala(g->ts, p->nome, CAT_PROGRAMA, T_VOID);
+    instala_vars(g->ts, b->decls_var);
+    g->num_globais = g->ts->global->prox_deslocamento;
+    g->base = g->ts->global->num_simbolos;
+
+    // Só as sub-rotinas instaladas viram nós; o principal vem por último
+    int n = 0;
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) n++;
+    g->nos = gr_malloc(n + 1, sizeof(NoGrafo));
+    Simbolo **simbolos = gr_malloc(n, sizeof(Simbolo*));
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        CategoriaSimbolo cat = d->tipo == DECL_FUNCTION ? CAT_FUNCAO : CAT_PROCEDIMENTO;
+        Simbolo *s = ts_instala(g->ts, d->u.subrot.nome, cat, d->u.subrot.tipo_retorno);
+        if (s == NULL) continue;
+        s->decl = d;
+        simbolos[g->num_nos] = s;
+        g->nos[g->num_nos].decl = d;
+        g->nos[g->num_nos].nome = s->nome;
+        g->num_nos++;
+    }
+    g->nos[g->num_nos].nome = p->nome;
+    g->num_nos++;
+
+    g->globais = gr_malloc(g->num_globais, sizeof(char*));
+    for (int i = 0; i < g->ts->global->num_baldes; i++)
+        for (Simbolo *s = g->ts->global->baldes[i]; s != NULL; s = s->prox)
+            if (global_de(s) >= 0) g->globais[s->deslocamento] = s->nome;
+
+    Montagem m = { .g = g };
+    m.marca_chamado = gr_malloc(g->num_nos, sizeof(int));
+    m.marca_lida = gr_malloc(g->num_globais, sizeof(int));
+    m.marca_escrita = gr_malloc(g->num_globais, sizeof(int));
+
+    for (int k = 0; k < g->num_nos - 1; k++) {
+        Simbolo *s = simbolos[k];
+        Decl *d = s->decl;
+        ts_abre_local(g->ts, s);
+        for (ParamDecl *pd = d->u.subrot.params; pd != NULL; pd = pd->prox)
+            for (IdList *id = pd->ids; id != NULL; id = id->prox)
+                ts_instala(g->ts, id->nome, CAT_PARAMETRO, pd->tipo_param);
+        instala_vars(g->ts, d->u.subrot.bloco->decls_var);
+        percorre_no(&m, k, d->u.subrot.bloco->comandos);
+        ts_fecha_local(g->ts);
+    }
+    percorre_no(&m, g->num_nos - 1, b->comandos);
+
+    // Os vetores não crescem mais: cada nó aponta para o seu trecho
+    g->arestas = m.chamados.v;
+    int c = 0, l = 0, e = 0;
+    for (int k = 0; k < g->num_nos; k++) {
+        NoGrafo *no = &g->nos[k];
+        no->chamados = g->arestas + c;
+        no->globais_lidas = m.lidas.v + l;
+        no->globais_escritas = m.escritas.v + e;
+        c += no->num_chamados;
+        l += no->num_globais_lidas;
+        e += no->num_globais_escritas;
+    }
+
+    componentes(g);
+    resume(g);
+
+    free(m.lidas.v);
+    free(m.escritas.v);
+    free(m.marca_chamado);
+    free(m.marca_lida);
+    free(m.marca_escrita);
+    free(simbolos);
+    return g;
+}
+
+void grafo_libera(GrafoChamadas* g) {
+    if (g == NULL) return;
+    for (int c = 0; c < g->num_componentes; c++) {
+        free(g->lidas[c]);
+        free(g->escritas[c]);
+    }
+    free(g->lidas);
+    free(g->escritas);
+    free(g->membros);
+    free(g->inicio);
+    free(g->arestas);
+    free(g->globais);
+    free(g->nos);
+    ts_libera(g->ts);
+    free(g);
+}
+
+int grafo_num_nos(const GrafoChamadas* g) {
+    return g->num_nos;
+}
+
+int grafo_num_componentes(const GrafoChamadas* g) {
+    return g->num_componentes;
+}
+
+const NoGrafo* grafo_no(const GrafoChamadas* g, int k) {
+    return &g->nos[k];
+}
+
+int grafo_busca(const GrafoChamadas* g, const char* nome) {
+    return no_de(g, ts_busca_escopo(g->ts->global, nome));
+}
+
+int grafo_busca_global(const GrafoChamadas* g, const char* nome) {
+    return global_de(ts_busca_escopo(g->ts->global, nome));
+}
+
+int grafo_num_globais(const GrafoChamadas* g) {
+    return g->num_globais;
+}
+
+const char* grafo_nome_global(const GrafoChamadas* g, int global) {
+    return g->globais[global];
+}
+
+const int* grafo_componente(const GrafoChamadas* g, int c, int* num) {
+    *num = g->inicio[c + 1] - g->inicio[c];
+    return g->membros + g->inicio[c];
+}
+
+static int contem(const int* conj, int n, int x) {
+    return bsearch(&x, conj, n, sizeof(int), compara_int) != NULL;
+}
+
+int grafo_le_global(const GrafoChamadas* g, int k, int global) {
+    return contem(g->nos[k].globais_lidas, g->nos[k].num_globais_lidas, global);
+}
+
+int grafo_escreve_global(const GrafoChamadas* g, int k, int global) {
+    return contem(g->nos[k].globais_escritas, g->nos[k].num_globais_escritas, global);
+}
+
+int grafo_pura(const GrafoChamadas* g, int k) {
+    const NoGrafo *no = &g->nos[k];
+    return !no->le_entrada && !no->escreve_saida && no->num_globais_lidas == 0 && no->num_globais_escritas == 0;
+}
+
+// ======================================================================
+// IMPRESSÃO
+// ======================================================================
+
+static void imprime_globais(const GrafoChamadas* g, FILE* f, const char* rotulo, const int* conj, int n) {
+    if (n == 0) return;
+    fprintf(f, "; %s", rotulo);
+    for (int i = 0; i < n; i++) fprintf(f, "%s%s", i ? ", " : " ", g->globais[conj[i]]);
+}
+
+void grafo_imprime(const GrafoChamadas* g, FILE* f) {
+    fprintf(f, "Grafo de chamadas: %d sub-rotina(s), %d componente(s)\n", g->num_nos - 1, g->num_componentes);
+    for (int c = 0; c < g->num_componentes; c++) {
+        for (int j = g->inicio[c]; j < g->inicio[c + 1]; j++) {
+            int k = g->membros[j];
+            const NoGrafo *no = &g->nos[k];
+            fprintf(f, "  [%d] %s%s", c, no->decl ? no->nome : "(principal)", no->recursiva ? " (recursiva)" : "");
+            if (no->num_chamados > 0) {
+                fprintf(f, ": chama");
+                for (int i = 0; i < no->num_chamados; i++)
+                    fprintf(f, "%s%s", i ? ", " : " ", g->nos[no->chamados[i]].nome);
+            }
+            imprime_globais(g, f, "lê", no->globais_lidas, no->num_globais_lidas);
+            imprime_globais(g, f, "escreve", no->globais_escritas, no->num_globais_escritas);
+            if (no->le_entrada) fprintf(f, "; read");
+            if (no->escreve_saida) fprintf(f, "; write");
+            if (grafo_pura(g, k)) fprintf(f, "; pura");
+            fputc('\n', f);
+        }
+    }
+}
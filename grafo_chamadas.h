@@ -0,0 +1,69 @@
+#ifndef GRAFO_CHAMADAS_H
+#define GRAFO_CHAMADAS_H
+
+#include "ast.h"
+
+// Grafo de chamadas do programa inteiro, montado sobre a AST (antes ou
+// depois da análise semântica) para as otimizações que precisam saber o
+// que uma sub-rotina pode fazer ao ser chamada.
+//
+// Há um nó por sub-rotina instalada, na ordem de declaração (uma
+// declaração repetida é ignorada, como na análise), e o último nó é o
+// programa principal. As arestas são as chamadas com e sem parênteses,
+// sem repetição; os nomes são resolvidos como na análise, com parâmetros
+// e locais escondendo as globais. As componentes fortemente conexas
+// (Tarjan) saem numeradas de baixo para cima: os chamados de uma
+// componente estão em componentes de número menor.
+//
+// O resumo de cada nó é transitivo (inclui o que os chamados podem fazer)
+// e é o mesmo para todos os nós de uma componente. Montagem, componentes
+// e indicadores custam tempo linear no tamanho do programa; os conjuntos
+// de globais custam, além disso, o tamanho dos conjuntos de cada
+// componente.
+
+typedef struct {
+    Decl* decl;                 // NULL: o programa principal
+    const char* nome;
+    const int* chamados;        // Índices dos nós chamados diretamente
+    int num_chamados;
+    int componente;
+    int recursiva;              // Pode chamar a si mesma (direta ou indiretamente)
+
+    // Resumo
+    int le_entrada;             // Pode executar read
+    int escreve_saida;          // Pode executar write
+    const int* globais_lidas;   // Índices das globais, em ordem crescente
+    int num_globais_lidas;
+    const int* globais_escritas;
+    int num_globais_escritas;
+} NoGrafo;
+
+typedef struct GrafoChamadas GrafoChamadas;
+
+GrafoChamadas* grafo_constroi(Programa* p);
+void grafo_libera(GrafoChamadas* g);
+
+int grafo_num_nos(const GrafoChamadas* g);              // Sub-rotinas + o principal
+int grafo_num_componentes(const GrafoChamadas* g);
+const NoGrafo* grafo_no(const GrafoChamadas* g, int k);
+
+// Nó da sub-rotina `nome` (-1 se não há) e índice da global `nome` (-1)
+int grafo_busca(const GrafoChamadas* g, const char* nome);
+int grafo_busca_global(const GrafoChamadas* g, const char* nome);
+int grafo_num_globais(const GrafoChamadas* g);
+const char* grafo_nome_global(const GrafoChamadas* g, int global);
+
+// Os nós da componente `c`, em ordem de declaração
+const int* grafo_componente(const GrafoChamadas* g, int c, int* num);
+
+// Consultas ao resumo do nó `k`
+int grafo_le_global(const GrafoChamadas* g, int k, int global);
+int grafo_escreve_global(const GrafoChamadas* g, int k, int global);
+// Sem read nem write e sem tocar globais: chamá-la só produz o retorno
+// (ou falha, ou não termina)
+int grafo_pura(const GrafoChamadas* g, int k);
+
+// Imprime os nós, componente a componente (calc --grafo)
+void grafo_imprime(const GrafoChamadas* g, FILE* f);
+
+#endif
@@ -0,0 +1,351 @@
+#include "lexico_manual.h"
+#include "ast.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LARGURA 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LARGURA 16
+#endif
+
+// Do flex e do Bison, para lexico_compara
+extern FILE *yyin;
+extern int yylineno;
+int yylex(void);
+
+// ======================================================================
+// CLASSIFICAÇÃO DE CARACTERES
+// ======================================================================
+
+// Os espaços de lexer.l ({ESPACO}); \v e \f são símbolos ilegais
+static inline int espaco(unsigned char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+static inline int letra(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static inline int digito(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+#ifdef LARGURA
+// Máscaras de bits (bit k = byte p[k]) de um bloco de LARGURA bytes. As
+// comparações de bytes são com sinal, então os bytes >= 0x80 (negativos)
+// nunca caem nas faixas ASCII.
+#if LARGURA == 32
+typedef __m256i Vetor;
+#define V_CARREGA(p) _mm256_loadu_si256((const __m256i*)(p))
+#define V_REPETE(c) _mm256_set1_epi8((char)(c))
+#define V_IGUAIS(a, b) _mm256_cmpeq_epi8(a, b)
+#define V_MAIOR(a, b) _mm256_cmpgt_epi8(a, b)
+#define V_E(a, b) _mm256_and_si256(a, b)
+#define V_OU(a, b) _mm256_or_si256(a, b)
+#define V_MASCARA(a) ((unsigned)_mm256_movemask_epi8(a))
+#define V_TODOS 0xFFFFFFFFu
+#else
+typedef __m128i Vetor;
+#define V_CARREGA(p) _mm_loadu_si128((const __m128i*)(p))
+#define V_REPETE(c) _mm_set1_epi8((char)(c))
+#define V_IGUAIS(a, b) _mm_cmpeq_epi8(a, b)
+#define V_MAIOR(a, b) _mm_cmpgt_epi8(a, b)
+#define V_E(a, b) _mm_and_si128(a, b)
+#define V_OU(a, b) _mm_or_si128(a, b)
+#define V_MASCARA(a) ((unsigned)_mm_movemask_epi8(a))
+#define V_TODOS 0xFFFFu
+#endif
+
+// c em [min, max]
+static inline Vetor na_faixa(Vetor c, char min, char max) {
+    return V_E(V_MAIOR(c, V_REPETE(min - 1)), V_MAIOR(V_REPETE(max + 1), c));
+}
+
+static inline unsigned mascara_espacos(const unsigned char* p, unsigned* quebras) {
+    Vetor c = V_CARREGA(p);
+    Vetor nl = V_IGUAIS(c, V_REPETE('\n'));
+    *quebras = V_MASCARA(nl);
+    return V_MASCARA(V_OU(V_OU(nl, V_IGUAIS(c, V_REPETE(' '))), V_OU(V_IGUAIS(c, V_REPETE('\t')), V_IGUAIS(c, V_REPETE('\r')))));
+}
+
+static inline unsigned mascara_digitos(const unsigned char* p) {
+    return V_MASCARA(na_faixa(V_CARREGA(p), '0', '9'));
+}
+
+// [a-zA-Z0-9_]; c | 0x20 leva as maiúsculas às minúsculas sem trazer
+// nenhum outro byte para a faixa a-z
+static inline unsigned mascara_nome(const unsigned char* p) {
+    Vetor c = V_CARREGA(p);
+    Vetor letras = na_faixa(V_OU(c, V_REPETE(0x20)), 'a', 'z');
+    return V_MASCARA(V_OU(V_OU(letras, na_faixa(c, '0', '9')), V_IGUAIS(c, V_REPETE('_'))));
+}
+#endif
+
+const char* lexico_simd(void) {
+#if defined(LARGURA) && LARGURA == 32
+    return "AVX2";
+#elif defined(LARGURA)
+    return "SSE2";
+#else
+    return "escalar";
+#endif
+}
+
+// Posição do primeiro byte a partir de `i` que não é espaço, contando as
+// quebras de linha no caminho
+static size_t pula_espacos(Scanner* sc, size_t i) {
+    // O caso mais comum é um espaço só entre dois tokens: resolvido sem
+    // carregar um bloco
+    if (i < sc->fim && !espaco(sc->s[i])) return i;
+    if (i + 1 < sc->fim && sc->s[i] == ' ' && !espaco(sc->s[i + 1])) return i + 1;
+#ifdef LARGURA
+    while (i + LARGURA <= sc->fim) {
+        unsigned quebras, espacos = mascara_espacos(sc->s + i, &quebras);
+        if (espacos == V_TODOS) {
+            sc->linha += __builtin_popcount(quebras);
+            i += LARGURA;
+            continue;
+        }
+        int k = __builtin_ctz(~espacos);
+        sc->linha += __builtin_popcount(quebras & ((1u << k) - 1));
+        return i + k;
+    }
+#endif
+    while (i < sc->fim && espaco(sc->s[i])) {
+        if (sc->s[i] == '\n') sc->linha++;
+        i++;
+    }
+    return i;
+}
+
+// Fim da sequência de bytes de nome ([a-zA-Z0-9_]) que começa em `i`
+static size_t fim_nome(const Scanner* sc, size_t i) {
+#ifdef LARGURA
+    // Nomes curtos (a maioria) terminam antes de valer carregar um bloco
+    for (size_t k = 0; k < 4 && i < sc->fim; k++, i++)
+        if (!letra(sc->s[i]) && !digito(sc->s[i]) && sc->s[i] != '_') return i;
+    while (i + LARGURA <= sc->fim) {
+        unsigned m = mascara_nome(sc->s + i);
+        if (m != V_TODOS) return i + __builtin_ctz(~m);
+        i += LARGURA;
+    }
+#endif
+    while (i < sc->fim && (letra(sc->s[i]) || digito(sc->s[i]) || sc->s[i] == '_')) i++;
+    return i;
+}
+
+static size_t fim_numero(const Scanner* sc, size_t i) {
+#ifdef LARGURA
+    while (i + LARGURA <= sc->fim) {
+        unsigned m = mascara_digitos(sc->s + i);
+        if (m != V_TODOS) return i + __builtin_ctz(~m);
+        i += LARGURA;
+    }
+#endif
+    while (i < sc->fim && digito(sc->s[i])) i++;
+    return i;
+}
+
+// ======================================================================
+// PALAVRAS RESERVADAS
+// ======================================================================
+
+// Hash perfeito das 21 palavras: (comprimento + s[0] + 5 * s[1]) mod 64
+// não tem colisões entre elas (todas têm pelo menos 2 letras)
+#define HASH_PALAVRA(tam, c0, c1) (((tam) + (c0) + 5 * (c1)) & 63)
+#define PALAVRA(texto, c0, c1, token) \
+    [HASH_PALAVRA(sizeof(texto) - 1, c0, c1)] = { texto, sizeof(texto) - 1, token }
+
+typedef struct {
+    const char* texto;
+    size_t tam;
+    int token;
+} Palavra;
+
+static const Palavra palavras[64] = {
+    PALAVRA("program", 'p', 'r', TK_PROGRAM), PALAVRA("procedure", 'p', 'r', PROCEDURE),
+    PALAVRA("function", 'f', 'u', FUNCTION), PALAVRA("begin", 'b', 'e', KW_BEGIN),
+    PALAVRA("end", 'e', 'n', END), PALAVRA("var", 'v', 'a', VAR), PALAVRA("if", 'i', 'f', IF),
+    PALAVRA("then", 't', 'h', THEN), PALAVRA("else", 'e', 'l', ELSE),
+    PALAVRA("while", 'w', 'h', WHILE), PALAVRA("do", 'd', 'o', DO), PALAVRA("read", 'r', 'e', READ),
+    PALAVRA("write", 'w', 'r', WRITE), PALAVRA("integer", 'i', 'n', INTEGER),
+    PALAVRA("boolean", 'b', 'o', BOOLEAN), PALAVRA("true", 't', 'r', TRUE),
+    PALAVRA("false", 'f', 'a', FALSE), PALAVRA("not", 'n', 'o', NOT), PALAVRA("or", 'o', 'r', OR),
+    PALAVRA("and", 'a', 'n', AND), PALAVRA("div", 'd', 'i', DIV),
+};
+
+// Token da palavra reservada `s` (de `tam` bytes); 0 se for um nome
+static inline int palavra_reservada(const unsigned char* s, size_t tam) {
+    if (tam < 2 || tam > 9) return 0;
+    const Palavra *p = &palavras[HASH_PALAVRA(tam, s[0], s[1])];
+    return p->tam == tam && memcmp(p->texto, s, tam) == 0 ? p->token : 0;
+}
+
+// ======================================================================
+// SCANNER
+// ======================================================================
+
+void lexico_escaneia(Scanner* sc, Token* tk) {
+    const unsigned char *s = sc->s;
+    size_t i;
+    for (;;) {
+        i = pula_espacos(sc, sc->pos);
+        if (i + 2 < sc->fim && s[i] == 0xEF && s[i + 1] == 0xBB && s[i + 2] == 0xBF) {
+            sc->pos = i + 3;    // BOM do UTF-8
+            continue;
+        }
+        break;
+    }
+
+    int tipo, valor = 0;
+    size_t fim;
+    if (i >= sc->fim) {
+        tipo = 0;
+        fim = i;
+    } else if (letra(s[i])) {
+        fim = fim_nome(sc, i + 1);
+        tipo = palavra_reservada(s + i, fim - i);
+        if (tipo == 0) {
+            tipo = ID;
+            valor = (int)(fim - i);
+        }
+    } else if (digito(s[i])) {
+        // Como atoi (strtol): satura em LONG_MAX e converte para int
+        fim = fim_numero(sc, i + 1);
+        long v = 0;
+        for (size_t k = i; k < fim; k++) {
+            int d = s[k] - '0';
+            v = v > (LONG_MAX - d) / 10 ? LONG_MAX : v * 10 + d;
+        }
+        tipo = NUM;
+        valor = (int)v;
+    } else {
+        int seguinte = i + 1 < sc->fim ? s[i + 1] : -1;
+        switch (s[i]) {
+            case ':': tipo = seguinte == '=' ? ATRIB : ':'; break;
+            case '<': tipo = seguinte == '=' ? MENOR_IGUAL : seguinte == '>' ? DIF : MENOR; break;
+            case '>': tipo = seguinte == '=' ? MAIOR_IGUAL : MAIOR; break;
+            case '=': tipo = IGUAL; break;
+            case '(': case ')': case ';': case '.': case ',': case '+': case '-': case '*':
+                tipo = s[i];
+                break;
+            default:
+                tipo = TOKEN_ILEGAL;
+                valor = s[i];
+                break;
+        }
+        fim = i + (tipo == ATRIB || tipo == MENOR_IGUAL || tipo == DIF || tipo == MAIOR_IGUAL ? 2 : 1);
+    }
+
+    *tk = (Token){
+        .tipo = (int16_t)tipo,
+        .tam = fim - i > UINT16_MAX ? UINT16_MAX : (uint16_t)(fim - i),
+        .desloc = (uint32_t)i,
+        .linha = sc->linha,
+        .valor = valor,
+    };
+    sc->pos = fim;
+}
+
+// ======================================================================
+// COMPARAÇÃO COM O FLEX
+// ======================================================================
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Lê o arquivo inteiro pelo flex, com o trabalho das suas ações (strdup
+// dos nomes). O flex já chegou ao fim de yyin: apontá-lo para o arquivo
+// aberto de novo recomeça a leitura. Cada símbolo ilegal retorna 0 como o
+// fim, então são `ilegais` + 1 zeros.
+static void le_flex(const char* arquivo, long ilegais) {
+    FILE *f = fopen(arquivo, "r");
+    if (f == NULL) return;
+    yyin = f;
+    yylineno = 1;
+    for (long zeros = 0; zeros <= ilegais;) {
+        int tipo = yylex();
+        if (tipo == ID) free(yylval.sval);
+        if (tipo == 0) zeros++;
+    }
+    fclose(f);
+}
+
+static void le_manual(const char* arquivo) {
+    TokensFonte *t = lexico_abre(arquivo);
+    if (t == NULL) return;
+    const Token *tk;
+    while ((tk = lexico_proximo(t))->tipo != 0)
+        if (tk->tipo == ID) free(lexico_nome(t, tk));
+    lexico_libera(t);
+}
+
+int lexico_compara(const char* arquivo) {
+    FILE *f = fopen(arquivo, "r");
+    TokensFonte *t = f != NULL ? lexico_abre(arquivo) : NULL;
+    if (t == NULL) {
+        perror("Erro ao abrir arquivo de entrada");
+        if (f != NULL) fclose(f);
+        return 1;
+    }
+    yyin = f;
+    yylineno = 1;
+
+    // O flex retorna 0 no símbolo ilegal (depois de imprimir o erro) e
+    // continua na chamada seguinte; no fim, os dois têm de dar 0 de novo
+    long n = 0, ilegais = 0;
+    int diferentes = 0;
+    for (;;) {
+        int tipo = yylex();
+        const Token *tk = lexico_proximo(t);
+        int esperado = tk->tipo == TOKEN_ILEGAL ? 0 : tk->tipo;
+        int igual = tipo == esperado && yylineno == tk->linha;
+        if (igual && tipo == NUM) igual = yylval.ival == tk->valor;
+        if (tipo == ID) {
+            if (igual) {
+                char *nome = lexico_nome(t, tk);
+                igual = strcmp(nome, yylval.sval) == 0;
+                free(nome);
+            }
+            free(yylval.sval);
+        }
+        if (igual && tk->tipo == 0) igual = yylex() == 0;
+        if (!igual) {
+            printf("Léxicos divergem no token %ld: flex %d na linha %d, manual %d na linha %d "
+                   "(posição %u).\n", n + 1, tipo, yylineno, tk->tipo, tk->linha, tk->desloc);
+            diferentes = 1;
+            break;
+        }
+        if (tk->tipo == 0) break;
+        if (tk->tipo == TOKEN_ILEGAL) ilegais++;
+        n++;
+    }
+    lexico_libera(t);
+    fclose(f);
+    if (diferentes) return 1;
+
+    // Vazão: cada scanner sozinho sobre o arquivo inteiro
+    double t0 = agora();
+    le_flex(arquivo, ilegais);
+    double t1 = agora();
+    le_manual(arquivo);
+    double t2 = agora();
+
+    struct stat st;
+    double mb = stat(arquivo, &st) == 0 ? st.st_size / 1e6 : 0;
+    printf("Léxicos idênticos: %ld tokens.\n", n);
+    printf("flex: %.2f ms (%.1f MB/s); manual (%s): %.2f ms (%.1f MB/s).\n",
+           1000 * (t1 - t0), mb / (t1 - t0), lexico_simd(), 1000 * (t2 - t1), mb / (t2 - t1));
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef LEXICO_MANUAL_H
+#define LEXICO_MANUAL_H
+
+#include <stddef.h>
+#include "lexico_paralelo.h"
+
+// Scanner escrito à mão, alternativo ao do flex (lexer.l). Os espaços e as
+// sequências de letras/dígitos de identificadores e números são
+// classificados em blocos de 16 bytes (SSE2) ou 32 (AVX2, se o compilador
+// o habilitar, como em `make CFLAGS=-mavx2`), com o resto em código
+// escalar; as palavras reservadas são reconhecidas por um hash perfeito.
+// Produz a mesma sequência de tokens do flex (lexico_compara confere).
+
+typedef struct {
+    const unsigned char* s;
+    size_t pos, fim;        // Próximo byte a ler e fim do trecho
+    int linha;              // Linha corrente (ou quebras vistas, num pedaço)
+} Scanner;
+
+// Lê o próximo token de [pos, fim); tipo 0 no fim. Num ID, `valor` é o
+// comprimento do nome (o `tam` do token satura).
+void lexico_escaneia(Scanner* sc, Token* tk);
+
+// Conjunto de instruções usado na classificação ("AVX2", "SSE2" ou
+// "escalar")
+const char* lexico_simd(void);
+
+// Compara, token a token, o scanner do flex e este sobre `arquivo` (tipo,
+// linha, valor e texto dos nomes) e mede a vazão de cada um; imprime o
+// resultado e retorna 0 se forem idênticos
+int lexico_compara(const char* arquivo);
+
+#endif
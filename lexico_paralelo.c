@@ -0,0 +1,354 @@
+#include "lexico_paralelo.h"
+#include "lexico_manual.h"
+#include "ast.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define TAM_MIN_PEDACO (1 << 16)
+#define PEDACOS_POR_THREAD 4
+
+TokensFonte* tokens_entrada = NULL;
+
+// Nome internado: aponta para a sua primeira ocorrência no fonte mapeado
+typedef struct {
+    uint32_t desloc;
+    uint32_t tam;
+    uint32_t hash;
+} Nome;
+
+// Tabela hash de endereçamento aberto sobre os nomes
+typedef struct {
+    Nome* nomes;
+    int num, cap;
+    int* indices;           // Índice + 1 em `nomes` (0: vazio)
+    unsigned mascara;
+} Internador;
+
+typedef struct {
+    size_t ini, fim;        // [ini, fim) no fonte
+    Token* tokens;
+    int num, cap;
+    int linhas;             // Quebras de linha no pedaço
+    Internador nomes;
+    int* mapa;              // Índice local do nome -> índice global
+    int base_tokens;        // Posição do primeiro token no vetor final
+    int base_linha;         // Linha em que o pedaço começa
+} Pedaco;
+
+struct TokensFonte {
+    const char* fonte;
+    size_t tam;
+    Token* tokens;          // NULL na leitura sob demanda (lexico_abre)
+    int num, pos;
+    Internador nomes;
+    Scanner sc;             // Leitura sob demanda
+    Token atual;
+};
+
+// Pedaços a processar por um conjunto de threads
+typedef struct {
+    TokensFonte* t;
+    Pedaco* pedacos;
+    int n;
+    void (*processa)(TokensFonte* t, Pedaco* p);
+    atomic_int proximo;
+} Trabalho;
+
+static void* aloca(size_t tam) {
+    void *p = malloc(tam);
+    if (p == NULL) {
+        perror("Erro ao alocar memória para a análise léxica");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// ======================================================================
+// INTERNAÇÃO DE NOMES
+// ======================================================================
+
+static void internador_inicia(Internador* in, int cap) {
+    in->nomes = aloca(cap * sizeof(Nome));
+    in->num = 0;
+    in->cap = cap;
+    in->indices = calloc(2 * cap, sizeof(int));
+    if (in->indices == NULL) {
+        perror("Erro ao alocar memória para a análise léxica");
+        exit(EXIT_FAILURE);
+    }
+    in->mascara = 2 * cap - 1;
+}
+
+static void internador_libera(Internador* in) {
+    free(in->nomes);
+    free(in->indices);
+}
+
+// Dobra a tabela; a carga fica sempre abaixo de 1/2
+static void internador_cresce(Internador* in) {
+    Internador novo;
+    internador_inicia(&novo, 2 * in->cap);
+    memcpy(novo.nomes, in->nomes, in->num * sizeof(Nome));
+    novo.num = in->num;
+    for (int k = 0; k < in->num; k++) {
+        unsigned h = in->nomes[k].hash & novo.mascara;
+        while (novo.indices[h] != 0) h = (h + 1) & novo.mascara;
+        novo.indices[h] = k + 1;
+    }
+    internador_libera(in);
+    *in = novo;
+}
+
+static int interna(Internador* in, const char* fonte, uint32_t desloc, uint32_t tam, uint32_t hash) {
+    unsigned h = hash & in->mascara;
+    while (in->indices[h] != 0) {
+        const Nome *n = &in->nomes[in->indices[h] - 1];
+        if (n->hash == hash && n->tam == tam && memcmp(fonte + n->desloc, fonte + desloc, tam) == 0)
+            return in->indices[h] - 1;
+        h = (h + 1) & in->mascara;
+    }
+    if (in->num == in->cap) {
+        internador_cresce(in);
+        return interna(in, fonte, desloc, tam, hash);
+    }
+    in->nomes[in->num] = (Nome){ desloc, tam, hash };
+    in->indices[h] = ++in->num;
+    return in->num - 1;
+}
+
+// ======================================================================
+// TOKENIZAÇÃO DE UM PEDAÇO
+// ======================================================================
+
+static inline int espaco(unsigned char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+static uint32_t hash_nome(const char* s, size_t tam) {
+    uint32_t h = 2166136261u;
+    for (size_t k = 0; k < tam; k++) h = (h ^ (unsigned char)s[k]) * 16777619u;
+    return h;
+}
+
+static void acrescenta(Pedaco* p, const Token* tk) {
+    if (p->num == p->cap) {
+        p->cap *= 2;
+        p->tokens = realloc(p->tokens, p->cap * sizeof(Token));
+        if (p->tokens == NULL) {
+            perror("Erro ao alocar memória para a análise léxica");
+            exit(EXIT_FAILURE);
+        }
+    }
+    p->tokens[p->num++] = *tk;
+}
+
+// Os tokens do pedaço, com as linhas contadas a partir do seu início e os
+// nomes internados localmente
+static void tokeniza(TokensFonte* t, Pedaco* p) {
+    // Estimativa folgada (o que não for tocado nem chega a ser alocado pelo
+    // sistema); o fonte típico tem um token a cada 4 bytes
+    p->cap = 256 + (int)((p->fim - p->ini) / 2);
+    p->tokens = aloca(p->cap * sizeof(Token));
+    p->num = 0;
+    internador_inicia(&p->nomes, 256);
+
+    Scanner sc = { (const unsigned char*)t->fonte, p->ini, p->fim, 0 };
+    Token tk;
+    for (;;) {
+        lexico_escaneia(&sc, &tk);
+        if (tk.tipo == 0) break;
+        if (tk.tipo == ID) {
+            uint32_t tam = (uint32_t)tk.valor;
+            tk.valor = interna(&p->nomes, t->fonte, tk.desloc, tam, hash_nome(t->fonte + tk.desloc, tam));
+        }
+        acrescenta(p, &tk);
+    }
+    p->linhas = sc.linha;
+}
+
+// Copia os tokens do pedaço para o vetor final com as linhas absolutas e
+// os nomes na numeração global
+static void concatena(TokensFonte* t, Pedaco* p) {
+    Token *destino = t->tokens + p->base_tokens;
+    for (int k = 0; k < p->num; k++) {
+        Token tk = p->tokens[k];
+        tk.linha += p->base_linha;
+        if (tk.tipo == ID) tk.valor = p->mapa[tk.valor];
+        destino[k] = tk;
+    }
+    if (p->tokens != t->tokens) free(p->tokens);
+    free(p->mapa);
+    p->tokens = NULL;
+    p->mapa = NULL;
+}
+
+// ======================================================================
+// EM PARALELO
+// ======================================================================
+
+static void* trabalhador(void* arg) {
+    Trabalho *tr = arg;
+    for (;;) {
+        int k = atomic_fetch_add(&tr->proximo, 1);
+        if (k >= tr->n) break;
+        tr->processa(tr->t, &tr->pedacos[k]);
+    }
+    return NULL;
+}
+
+// Processa os pedaços com até `threads` threads, contando a chamadora
+static void executa(TokensFonte* t, Pedaco* pedacos, int n, int threads,
+                    void (*processa)(TokensFonte* t, Pedaco* p)) {
+    Trabalho tr = { .t = t, .pedacos = pedacos, .n = n, .processa = processa };
+    atomic_init(&tr.proximo, 0);
+
+    if (threads > n) threads = n;
+    pthread_t *ids = aloca((threads > 1 ? threads - 1 : 1) * sizeof(pthread_t));
+    int criadas = 0;
+    while (criadas < threads - 1 && pthread_create(&ids[criadas], NULL, trabalhador, &tr) == 0)
+        criadas++;
+    trabalhador(&tr);
+    for (int k = 0; k < criadas; k++) pthread_join(ids[k], NULL);
+    free(ids);
+}
+
+// Mapeia `arquivo` em memória; NULL se não for possível ou se ele passar
+// de 4 GiB (as posições dos tokens têm 32 bits)
+static TokensFonte* mapeia(const char* arquivo) {
+    int fd = open(arquivo, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size > UINT32_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    TokensFonte *t = calloc(1, sizeof(TokensFonte));
+    if (t == NULL) {
+        perror("Erro ao alocar memória para a análise léxica");
+        exit(EXIT_FAILURE);
+    }
+    t->tam = (size_t)st.st_size;
+    t->fonte = "";
+    if (t->tam > 0) {
+        void *m = mmap(NULL, t->tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            close(fd);
+            free(t);
+            return NULL;
+        }
+        t->fonte = m;
+    }
+    close(fd);
+    return t;
+}
+
+TokensFonte* lexico_abre(const char* arquivo) {
+    TokensFonte *t = mapeia(arquivo);
+    if (t == NULL) return NULL;
+    t->sc = (Scanner){ (const unsigned char*)t->fonte, 0, t->tam, 1 };
+    t->atual.tipo = -2;     // Nenhum token lido ainda
+    return t;
+}
+
+TokensFonte* lexico_paralelo(const char* arquivo, int threads) {
+    TokensFonte *t = mapeia(arquivo);
+    if (t == NULL) return NULL;
+
+    // Pedaços de pelo menos TAM_MIN_PEDACO, vários por thread para
+    // equilibrar a carga; cada um começa no primeiro espaço a partir da
+    // sua fração do arquivo
+    size_t n = 1;
+    if (threads > 1) {
+        n = (size_t)threads * PEDACOS_POR_THREAD;
+        if (n > t->tam / TAM_MIN_PEDACO + 1) n = t->tam / TAM_MIN_PEDACO + 1;
+    }
+    Pedaco *pedacos = calloc(n, sizeof(Pedaco));
+    if (pedacos == NULL) {
+        perror("Erro ao alocar memória para a análise léxica");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < n; k++) {
+        size_t ini = k == 0 ? 0 : t->tam / n * k;
+        if (k > 0 && ini < pedacos[k - 1].ini) ini = pedacos[k - 1].ini;
+        while (k > 0 && ini < t->tam && !espaco((unsigned char)t->fonte[ini])) ini++;
+        pedacos[k].ini = ini;
+        if (k > 0) pedacos[k - 1].fim = ini;
+    }
+    pedacos[n - 1].fim = t->tam;
+
+    executa(t, pedacos, (int)n, threads, tokeniza);
+
+    // Numeração global dos nomes e posição de cada pedaço no vetor final
+    internador_inicia(&t->nomes, 1024);
+    int num = 0, linha = 1;
+    for (size_t k = 0; k < n; k++) {
+        Pedaco *p = &pedacos[k];
+        p->mapa = aloca((p->nomes.num > 0 ? p->nomes.num : 1) * sizeof(int));
+        for (int j = 0; j < p->nomes.num; j++) {
+            const Nome *nm = &p->nomes.nomes[j];
+            p->mapa[j] = interna(&t->nomes, t->fonte, nm->desloc, nm->tam, nm->hash);
+        }
+        internador_libera(&p->nomes);
+        p->base_tokens = num;
+        p->base_linha = linha;
+        num += p->num;
+        linha += p->linhas;
+    }
+
+    // O vetor do primeiro pedaço cresce até o total e os outros são
+    // copiados depois dele: em fontes grandes o realloc só remapeia as
+    // páginas, e com uma thread não há cópia nenhuma
+    t->tokens = realloc(pedacos[0].tokens, (num + 1) * sizeof(Token));
+    if (t->tokens == NULL) {
+        perror("Erro ao alocar memória para a análise léxica");
+        exit(EXIT_FAILURE);
+    }
+    pedacos[0].tokens = t->tokens;
+    executa(t, pedacos, (int)n, threads, concatena);
+    t->tokens[num] = (Token){ .tipo = 0, .desloc = (uint32_t)t->tam, .linha = linha };
+    t->num = num + 1;
+    t->pos = 0;
+    free(pedacos);
+    return t;
+}
+
+void lexico_libera(TokensFonte* t) {
+    if (t == NULL) return;
+    if (t->tam > 0) munmap((void*)t->fonte, t->tam);
+    if (t->tokens != NULL) {
+        internador_libera(&t->nomes);
+        free(t->tokens);
+    }
+    free(t);
+}
+
+const Token* lexico_proximo(TokensFonte* t) {
+    if (t->tokens == NULL) {
+        if (t->atual.tipo != 0) lexico_escaneia(&t->sc, &t->atual);
+        return &t->atual;
+    }
+    const Token *tk = &t->tokens[t->pos];
+    if (t->pos < t->num - 1) t->pos++;
+    return tk;
+}
+
+char* lexico_nome(const TokensFonte* t, const Token* tk) {
+    uint32_t desloc = tk->desloc, tam = (uint32_t)tk->valor;
+    if (t->tokens != NULL) {
+        desloc = t->nomes.nomes[tk->valor].desloc;
+        tam = t->nomes.nomes[tk->valor].tam;
+    }
+    char *s = aloca(tam + 1);
+    memcpy(s, t->fonte + desloc, tam);
+    s[tam] = '\0';
+    return s;
+}
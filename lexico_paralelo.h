@@ -0,0 +1,47 @@
+#ifndef LEXICO_PARALELO_H
+#define LEXICO_PARALELO_H
+
+#include <stdint.h>
+
+// Análise léxica em paralelo de fontes grandes. Rascal não tem comentários
+// nem literais de cadeia (lexer.l), então todo espaço em branco é um ponto
+// de corte seguro: o arquivo é mapeado em memória e dividido em pedaços que
+// começam num espaço; cada pedaço é tokenizado por uma thread num vetor
+// próprio, com os identificadores internados localmente. Depois os vetores
+// são concatenados, com as linhas e os índices dos nomes ajustados, e o
+// parser lê deste vetor (parser.y) em vez de chamar o scanner do flex.
+// Tokens, valores, linhas e erros léxicos são os mesmos do flex.
+
+#define TOKEN_ILEGAL (-1)       // Símbolo ilegal; `valor` é o byte
+
+typedef struct {
+    int16_t tipo;       // Token do Bison (parser.tab.h), TOKEN_ILEGAL ou 0 no fim
+    uint16_t tam;       // Comprimento no fonte (saturado em UINT16_MAX)
+    uint32_t desloc;    // Posição no fonte
+    int32_t linha;
+    int32_t valor;      // NUM: o valor; ID: o índice do nome internado (ou o
+                        // comprimento do nome, na leitura sob demanda)
+} Token;
+
+typedef struct TokensFonte TokensFonte;
+
+// Tokeniza `arquivo` com até `threads` threads; NULL se não for possível
+// mapeá-lo (o chamador volta ao flex)
+TokensFonte* lexico_paralelo(const char* arquivo, int threads);
+
+// Lê `arquivo` pelo scanner manual (lexico_manual.h) sob demanda, um token
+// por chamada de lexico_proximo, sem montar o vetor; NULL se não for
+// possível mapeá-lo
+TokensFonte* lexico_abre(const char* arquivo);
+void lexico_libera(TokensFonte* t);
+
+// Próximo token; o último (tipo 0) se repete indefinidamente
+const Token* lexico_proximo(TokensFonte* t);
+
+// Cópia do nome do token ID `tk`, como o yylval.sval do flex
+char* lexico_nome(const TokensFonte* t, const Token* tk);
+
+// Quando não é NULL, o parser lê os tokens daqui
+extern TokensFonte* tokens_entrada;
+
+#endif
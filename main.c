@@ -1,35 +1,535 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include "ast.h"
+#include "tabela_simbolos.h"
+#include "semantico.h"
+#include "ordem_avaliacao.h"
+#include "mepa.h"
+#include "gerador_mepa.h"
+#include "otimizador_mepa.h"
+#include "cache_compilacao.h"
+#include "compilacao.h"
+#include "lexico_paralelo.h"
+#include "lexico_manual.h"
+#include "parser_incremental.h"
+#include "servidor.h"
+#include "observador.h"
+#include "eliminacao.h"
+#include "desenrolamento.h"
+#include "subexpressoes.h"
+#include "vivacidade.h"
+#include "grafo_chamadas.h"
+#include "memoizacao.h"
 
 // Declarado pelo Bison
 int yyparse(void);
+// Gerados pelo flex
 extern FILE *yyin;
+extern int yylineno;
+void yyrestart(FILE *f);
 
-int main(int argc, char **argv) {
+// Uso: calc [opções] entrada.ras [saida.mepa]  ("-" como entrada: a entrada padrão)
+//   --ast            imprime a AST (padrão quando não há arquivo de saída)
+//   --grafo          imprime o grafo de chamadas e o resumo de cada sub-rotina
+//                    (grafo_chamadas.h)
+//   --mepa-classico  gera CRVL/ARMZ com display em vez do endereçamento de dois níveis
+//   --sem-peephole   grava o código como sai do gerador, sem a otimização peephole
+//   --sem-eliminacao gera também as sub-rotinas inalcançáveis e as variáveis
+//                    nunca lidas (eliminacao.h)
+//   --desenrolar N   desenrola os laços contados por N (padrão:
+//                    DESENROLAMENTO_FATOR; 1: só a redução de força)
+//                    (desenrolamento.h)
+//   --sem-desenrolamento  não transforma os laços
+//   --sem-subexpressoes  calcula de novo as subexpressões repetidas em vez de
+//                    ler o valor já calculado (subexpressoes.h)
+//   --sem-compartilhamento  dá a cada local a sua posição no registro de
+//                    ativação, mesmo que não interfira com outras (vivacidade.h)
+//   --memoizar       guarda numa tabela da execução os resultados das funções
+//                    recursivas puras (memoizacao.h)
+//   --cache ARQUIVO  compilação incremental: reaproveita de ARQUIVO o código das
+//                    sub-rotinas que não mudaram e o atualiza ao final
+//   --fluxo          compila cada sub-rotina assim que o parser a reduz e a
+//                    libera em seguida, sem montar a AST do programa inteiro
+//   --paralelo       analisa e gera as sub-rotinas em paralelo
+//   --lexico-manual  lê a entrada pelo scanner escrito à mão (lexico_manual.c)
+//                    em vez do flex; padrão se compilado com `make LEXICO=manual`
+//   --lexico-flex    usa o scanner do flex
+//   --lexico-paralelo  tokeniza a entrada (mapeada em memória) em paralelo antes
+//                    do parsing, em vez de usar o scanner do flex
+//   --threads N      número de threads de --paralelo e --lexico-paralelo
+//                    (padrão: processadores)
+//   --incremental    lê a entrada (ou a entrada padrão) em blocos à medida que
+//                    chegam e os entrega ao parser push (parser_incremental.h)
+//   --servidor SOCKET  não compila: atende, com um conjunto de processos já
+//                    iniciados, os pedidos do cliente calcc (servidor.h)
+//   --trabalhadores N  processos de --servidor (padrão: processadores)
+//   --watch          recompila cada par entrada.ras saida.mepa da linha de
+//                    comando sempre que a entrada for gravada (observador.h)
+//   --compara-lexicos  só compara os tokens do flex e do scanner manual sobre a
+//                    entrada e mede a vazão de cada um
+//   --percursos-separados  faz a análise, a avaliação parcial, a ordenação e a
+//                    geração em uma descida cada, em vez de numa só (percurso.h);
+//                    para depuração
+//   --compara-percursos  só compila a entrada várias vezes nos dois modos de
+//                    percurso, medindo o tempo de cada um, e confere o código
+
+enum { LEXICO_FLEX, LEXICO_MANUAL, LEXICO_PARALELO };
+
+#ifdef LEXICO_PADRAO_MANUAL
+#define LEXICO_PADRAO LEXICO_MANUAL
+#else
+#define LEXICO_PADRAO LEXICO_FLEX
+#endif
 
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            perror("Erro ao abrir arquivo de entrada");
-            return 1;
+// Parsing pelo parser push, com a entrada lida de `fd` em blocos; retorna 0
+// como yyparse se o programa foi aceito, deixando a AST em raiz_ast
+static int parse_incremental(int fd) {
+    ParserIncremental *p = parser_inc_cria();
+    static char bloco[1 << 16];
+    EstadoParserInc estado = PARSER_INC_CONTINUA;
+    int falha = 0;
+
+    while (estado == PARSER_INC_CONTINUA) {
+        ssize_t n = read(fd, bloco, sizeof(bloco));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            perror("Erro ao ler a entrada");
+            falha = 1;
         }
+        if (n <= 0) break;
+        estado = parser_inc_alimenta(p, bloco, (size_t)n);
+    }
+    estado = parser_inc_termina(p, &raiz_ast);
+    parser_inc_libera(p);
+    return falha || estado != PARSER_INC_ACEITO;
+}
+
+typedef struct {
+    int imprime_ast, imprime_grafo, peephole, elimina, desenrola, subexpressoes, compartilha, memoiza, fluxo, paralelo,
+        threads, incremental, lexico;
+    ModoGeracao modo;
+    ModoPercurso percurso;
+    const char *arquivo_cache;
+} Opcoes;
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Compila `entrada` (NULL: a entrada padrão), já aberta em yyin, e fecha
+// yyin; grava em `saida` se não for NULL. Com `cache_memoria`, usa esse
+// cache, mantido pelo chamador, em vez do arquivo de --cache. Retorna o
+// código de saída e deixa o estado global (yyin, raiz_ast,
+// compilacao_em_fluxo, tokens_entrada) pronto para a próxima compilação.
+static int compila(const Opcoes* op, const char* entrada, const char* saida, CacheCompilacao* cache_memoria) {
+    yyrestart(yyin);
+    yylineno = 1;
+
+    // Os scanners manuais mapeiam o arquivo; a entrada padrão fica com o
+    // flex. O parser incremental tem o seu próprio.
+    if (!op->incremental && op->lexico != LEXICO_FLEX && entrada != NULL) {
+        tokens_entrada = op->lexico == LEXICO_PARALELO ? lexico_paralelo(entrada, op->threads) : lexico_abre(entrada);
+        if (tokens_entrada == NULL)
+            fprintf(stderr, "ALERTA: não foi possível mapear %s; usando o scanner do flex\n", entrada);
+    } else if (!op->incremental && op->lexico != LEXICO_PADRAO) {
+        fprintf(stderr, "ALERTA: o scanner manual requer arquivo de entrada; usando o do flex\n");
     }
 
+    TabelaSimbolos *ts = ts_cria();
+    CodigoMepa codigo;
+    CacheCompilacao *cache = cache_memoria;
+    int erros;
+
+    mepa_inicia(&codigo);
+    if (cache == NULL && saida && op->arquivo_cache) cache = cache_abre(op->arquivo_cache);
+    if (op->fluxo) compilacao_em_fluxo = compilacao_cria(ts, &codigo, op->modo, cache, op->percurso);
+
     printf("Iniciando parsing...\n");
 
-    if (yyparse() == 0) {
-        printf("Parsing concluído com sucesso!\n\n");
+    int erro_parsing = op->incremental ? parse_incremental(fileno(yyin)) : yyparse();
+    lexico_libera(tokens_entrada);
+    tokens_entrada = NULL;
+    if (entrada) fclose(yyin);
 
-        if (raiz_ast) {
-            ast_print_program(raiz_ast);
-            prog_free(raiz_ast);
-        } else {
+    if (erro_parsing != 0 || !raiz_ast) {
+        if (erro_parsing != 0)
+            printf("Erros encontrados durante o parsing.\n");
+        else
             printf("ATENÇÃO: raiz_ast == NULL (o parser não construiu a AST)\n");
+        compilacao_descarta(compilacao_em_fluxo);
+        compilacao_em_fluxo = NULL;
+        prog_free(raiz_ast);    // Reduzido antes de um erro depois do '.'
+        raiz_ast = NULL;
+        if (cache != cache_memoria) cache_libera(cache);
+        mepa_libera(&codigo);
+        ts_libera(ts);
+        return 1;
+    }
+
+    printf("Parsing concluído com sucesso!\n\n");
+
+    if (op->imprime_ast || !saida)
+        ast_print_program(raiz_ast);
+
+    if (op->imprime_grafo) {
+        GrafoChamadas *g = grafo_constroi(raiz_ast);
+        grafo_imprime(g, stdout);
+        grafo_libera(g);
+    }
+
+    // Em fluxo as sub-rotinas já foram geradas: não há o que eliminar
+    if (saida && op->elimina && !op->fluxo) {
+        EliminacaoCodigo el = elimina_codigo_morto(raiz_ast);
+        printf("Eliminação de código morto: %d sub-rotina(s), %d variável(is) e %d atribuição(ões) removidas.\n",
+               el.subrotinas, el.variaveis, el.atribuicoes);
+    }
+    if (saida && op->desenrola && !op->fluxo) {
+        DesenrolamentoLacos dl = desenrola_lacos(raiz_ast, op->desenrola);
+        printf("Desenrolamento de laços (fator %d): %d laço(s) desenrolado(s), %d só com redução de força; "
+               "%d multiplicação(ões) trocada(s) por %d temporária(s).\n",
+               op->desenrola, dl.lacos, dl.reduzidos, dl.multiplicacoes, dl.temporarias);
+    }
+    if (saida && op->subexpressoes && !op->fluxo) {
+        ReaproveitamentoSubexpressoes rs = reaproveita_subexpressoes(raiz_ast);
+        printf("Subexpressões comuns: %d cálculo(s) trocado(s) pela variável que já tinha o valor e %d "
+               "por %d temporária(s).\n", rs.variaveis, rs.repeticoes, rs.temporarias);
+    }
+    if (saida && op->compartilha && !op->fluxo) {
+        CompartilhamentoPosicoes cp = compartilha_posicoes(raiz_ast);
+        printf("Compartilhamento de posições: %d -> %d posições de locais nos registros de ativação "
+               "(o maior: %d -> %d); %d sub-rotina(s) reduzida(s).\n",
+               cp.antes, cp.depois, cp.maior_antes, cp.maior_depois, cp.subrotinas);
+    }
+    if (saida && op->memoiza && !op->fluxo)
+        printf("Memoização: %d função(ões) recursiva(s) pura(s) com tabela na execução.\n",
+               marca_memoizacao(raiz_ast));
+
+    if (op->fluxo) {
+        erros = compilacao_finaliza(compilacao_em_fluxo, raiz_ast->bloco_principal);
+        compilacao_em_fluxo = NULL;
+    } else if (op->paralelo) {
+        erros = compila_programa_paralelo(raiz_ast, ts, &codigo, op->modo, op->threads, op->percurso);
+    } else if (saida) {
+        erros = compila_programa(raiz_ast, ts, &codigo, op->modo, cache, op->percurso);
+    } else {
+        erros = analisa_semantica(raiz_ast, ts);
+    }
+
+    if (cache != NULL) {
+        if (erros == 0 && cache != cache_memoria) cache_grava(cache, op->arquivo_cache);
+        const EstatisticasCache *ec = cache_estatisticas(cache);
+        printf("Cache de compilação: %d acerto(s), %d falha(s); análise e geração evitadas: %.2f ms "
+               "(custo do cache: %.2f ms).\n", ec->acertos, ec->falhas,
+               1000 * ec->tempo_economizado, 1000 * ec->tempo_cache);
+        if (cache != cache_memoria) cache_libera(cache);
+    }
+
+    if (erros > 0) {
+        printf("Análise semântica encontrou %d erro(s).\n", erros);
+    } else if (saida) {
+        if (op->peephole) {
+            int antes = codigo.num_instrs;
+            otimiza_mepa(&codigo);
+            printf("Otimização peephole: %d -> %d instruções.\n", antes, codigo.num_instrs);
+        }
+
+        FILE *f = fopen(saida, "w");
+        if (!f) {
+            perror("Erro ao abrir arquivo de saída");
+            erros = 1;
+        } else {
+            mepa_escreve(f, &codigo);
+            fclose(f);
+            printf("Código MEPA gravado em %s (%d instruções).\n", saida, codigo.num_instrs);
+        }
+    }
+
+    mepa_libera(&codigo);
+    ts_libera(ts);
+    prog_free(raiz_ast);
+    raiz_ast = NULL;
+
+    return erros > 0;
+}
+
+// ==========================================
+// --compara-percursos
+// ==========================================
+
+#define COMPARACOES_PERCURSOS 20
+
+// Parsing de `entrada` pelo flex, deixando a AST em raiz_ast
+static int le_programa(const char* entrada) {
+    yyin = fopen(entrada, "r");
+    if (!yyin) {
+        perror("Erro ao abrir arquivo de entrada");
+        return 1;
+    }
+    yyrestart(yyin);
+    yylineno = 1;
+    int erro = yyparse();
+    fclose(yyin);
+    if (erro == 0 && raiz_ast != NULL) return 0;
+    prog_free(raiz_ast);
+    raiz_ast = NULL;
+    return 1;
+}
+
+// Compila `entrada` várias vezes em cada modo, alternando, com uma AST
+// nova a cada vez (os passes a modificam); só a compilação é medida
+static int mede_percursos(const Opcoes* op, const char* entrada) {
+    const ModoPercurso modos[2] = { PERCURSO_FUNDIDO, PERCURSO_SEPARADO };
+    double tempo[2] = { 0, 0 };
+    CodigoMepa codigo[2];
+
+    for (int r = 0; r < COMPARACOES_PERCURSOS; r++) {
+        for (int m = 0; m < 2; m++) {
+            if (le_programa(entrada) != 0) {
+                fprintf(stderr, "--compara-percursos: erro de sintaxe em %s\n", entrada);
+                if (r > 0 || m > 0) mepa_libera(&codigo[0]);
+                return 1;
+            }
+            if (op->elimina) elimina_codigo_morto(raiz_ast);
+            if (op->desenrola) desenrola_lacos(raiz_ast, op->desenrola);
+            if (op->subexpressoes) reaproveita_subexpressoes(raiz_ast);
+            if (op->compartilha) compartilha_posicoes(raiz_ast);
+            if (op->memoiza) marca_memoizacao(raiz_ast);
+
+            TabelaSimbolos *ts = ts_cria();
+            CodigoMepa cod;
+            mepa_inicia(&cod);
+            double inicio = agora();
+            int erros = compila_programa(raiz_ast, ts, &cod, op->modo, NULL, modos[m]);
+            tempo[m] += agora() - inicio;
+            ts_libera(ts);
+            prog_free(raiz_ast);
+            raiz_ast = NULL;
+
+            if (erros > 0) {
+                fprintf(stderr, "--compara-percursos: %s tem erros semânticos\n", entrada);
+                mepa_libera(&cod);
+                if (r > 0 || m > 0) mepa_libera(&codigo[0]);
+                return 1;
+            }
+            if (r == 0)
+                codigo[m] = cod;
+            else
+                mepa_libera(&cod);
         }
+    }
+
+    int iguais = codigo[0].num_instrs == codigo[1].num_instrs && codigo[0].num_rotulos == codigo[1].num_rotulos
+                 && memcmp(codigo[0].instrs, codigo[1].instrs, codigo[0].num_instrs * sizeof(InstrMepa)) == 0;
+    printf("Percursos fundidos: %.3f ms por compilação; separados: %.3f ms (%.2fx), em %d compilações "
+           "de cada.\n", 1000 * tempo[0] / COMPARACOES_PERCURSOS, 1000 * tempo[1] / COMPARACOES_PERCURSOS,
+           tempo[0] > 0 ? tempo[1] / tempo[0] : 0, COMPARACOES_PERCURSOS);
+    printf("Código %s (%d instruções).\n", iguais ? "idêntico" : "DIFERENTE", codigo[0].num_instrs);
+    mepa_libera(&codigo[0]);
+    mepa_libera(&codigo[1]);
+    return !iguais;
+}
+
+// ==========================================
+// --watch
+// ==========================================
+
+// Os pares entrada/saída observados, cada um com o seu cache em memória
+typedef struct {
+    const Opcoes* op;
+    char* const* arquivos;      // entrada, saída, entrada, saída...
+    CacheCompilacao** caches;
+} Observacao;
 
+static void recompila(int k, void* ctx) {
+    Observacao *o = ctx;
+    const char *entrada = o->arquivos[2 * k], *saida = o->arquivos[2 * k + 1];
+    double inicio = agora();
+
+    int status = 1;
+    yyin = fopen(entrada, "r");
+    if (!yyin)
+        perror("Erro ao abrir arquivo de entrada");
+    else
+        status = compila(o->op, entrada, saida, o->caches[k]);
+
+    // Só uma compilação sem erros diz quais fragmentos ainda servem
+    cache_recomeca(o->caches[k], status == 0);
+    printf("[watch] %s: %s em %.2f ms\n\n", entrada, status == 0 ? "recompilado" : "com erros",
+           1000 * (agora() - inicio));
+    fflush(stdout);
+}
+
+static int observa(Opcoes* op, char* const* arquivos, int n) {
+    if (n == 0 || n % 2 != 0) {
+        fprintf(stderr, "--watch requer pares entrada.ras saida.mepa\n");
+        return 1;
+    }
+    if (op->paralelo || op->arquivo_cache) {
+        fprintf(stderr, "ALERTA: --watch mantém o cache de compilação em memória e não combina com "
+                        "--paralelo nem --cache; ignorados\n");
+        op->paralelo = 0;
+        op->arquivo_cache = NULL;
+    }
+
+    int pares = n / 2;
+    Observacao o = { op, arquivos, malloc(pares * sizeof(CacheCompilacao*)) };
+    char **entradas = malloc(pares * sizeof(char*));
+    if (o.caches == NULL || entradas == NULL) {
+        perror("Erro ao alocar memória para --watch");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < pares; k++) {
+        o.caches[k] = cache_abre(NULL);
+        entradas[k] = arquivos[2 * k];
+        recompila(k, &o);
+    }
+    return observa_arquivos(entradas, pares, recompila, &o);
+}
+
+// Uma execução do compilador com a linha de comando `argv`; retorna o
+// código de saída. Roda também nos processos do servidor, um pedido após o
+// outro.
+static int calc_executa(int argc, char **argv) {
+    Opcoes op = { .peephole = 1, .elimina = 1, .desenrola = DESENROLAMENTO_FATOR, .subexpressoes = 1,
+                  .compartilha = 1, .lexico = LEXICO_PADRAO, .modo = MODO_DOIS_NIVEIS, .percurso = PERCURSO_FUNDIDO };
+    const char *entrada = NULL, *saida = NULL;
+    int compara = 0, percursos = 0, observacao = 0;
+    char **posicionais = malloc(argc * sizeof(char*));
+    int num_posicionais = 0;
+    if (posicionais == NULL) {
+        perror("Erro ao alocar memória para os argumentos");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "--ast") == 0)
+            op.imprime_ast = 1;
+        else if (strcmp(argv[k], "--grafo") == 0)
+            op.imprime_grafo = 1;
+        else if (strcmp(argv[k], "--mepa-classico") == 0)
+            op.modo = MODO_CLASSICO;
+        else if (strcmp(argv[k], "--sem-peephole") == 0)
+            op.peephole = 0;
+        else if (strcmp(argv[k], "--sem-eliminacao") == 0)
+            op.elimina = 0;
+        else if (strcmp(argv[k], "--desenrolar") == 0 && k + 1 < argc)
+            op.desenrola = atoi(argv[++k]);
+        else if (strcmp(argv[k], "--sem-desenrolamento") == 0)
+            op.desenrola = 0;
+        else if (strcmp(argv[k], "--sem-subexpressoes") == 0)
+            op.subexpressoes = 0;
+        else if (strcmp(argv[k], "--sem-compartilhamento") == 0)
+            op.compartilha = 0;
+        else if (strcmp(argv[k], "--memoizar") == 0)
+            op.memoiza = 1;
+        else if (strcmp(argv[k], "--cache") == 0 && k + 1 < argc)
+            op.arquivo_cache = argv[++k];
+        else if (strcmp(argv[k], "--fluxo") == 0)
+            op.fluxo = 1;
+        else if (strcmp(argv[k], "--paralelo") == 0)
+            op.paralelo = 1;
+        else if (strcmp(argv[k], "--lexico-manual") == 0)
+            op.lexico = LEXICO_MANUAL;
+        else if (strcmp(argv[k], "--lexico-flex") == 0)
+            op.lexico = LEXICO_FLEX;
+        else if (strcmp(argv[k], "--lexico-paralelo") == 0)
+            op.lexico = LEXICO_PARALELO;
+        else if (strcmp(argv[k], "--incremental") == 0)
+            op.incremental = 1;
+        else if (strcmp(argv[k], "--compara-lexicos") == 0)
+            compara = 1;
+        else if (strcmp(argv[k], "--percursos-separados") == 0)
+            op.percurso = PERCURSO_SEPARADO;
+        else if (strcmp(argv[k], "--compara-percursos") == 0)
+            percursos = 1;
+        else if (strcmp(argv[k], "--watch") == 0)
+            observacao = 1;
+        else if (strcmp(argv[k], "--threads") == 0 && k + 1 < argc)
+            op.threads = atoi(argv[++k]);
+        else if ((strcmp(argv[k], "--servidor") == 0 || strcmp(argv[k], "--trabalhadores") == 0) && k + 1 < argc)
+            k++;    // Tratadas em main
+        else
+            posicionais[num_posicionais++] = argv[k];
+    }
+    if (num_posicionais > 0) entrada = posicionais[0];
+    if (num_posicionais > 1) saida = posicionais[num_posicionais - 1];
+    if (entrada && strcmp(entrada, "-") == 0) entrada = NULL;
+
+    if (!observacao) {
+        yyin = stdin;
+        if (entrada) {
+            yyin = fopen(entrada, "r");
+            if (!yyin) {
+                perror("Erro ao abrir arquivo de entrada");
+                free(posicionais);
+                return 1;
+            }
+        }
+    }
+
+    // A AST inteira só existe fora do fluxo
+    if (op.fluxo && (op.imprime_ast || op.imprime_grafo || !saida)) {
+        fprintf(stderr, "ALERTA: --fluxo requer arquivo de saída e não combina com --ast nem --grafo; ignorado\n");
+        op.fluxo = 0;
+    }
+    if (op.paralelo && (op.fluxo || op.arquivo_cache || !saida)) {
+        fprintf(stderr, "ALERTA: --paralelo requer arquivo de saída e não combina com --fluxo nem --cache; ignorado\n");
+        op.paralelo = 0;
+    }
+    if (op.memoiza && (op.fluxo || op.modo == MODO_CLASSICO)) {
+        fprintf(stderr, "ALERTA: --memoizar não combina com --fluxo nem --mepa-classico; ignorado\n");
+        op.memoiza = 0;
+    }
+    if (op.desenrola < 0) {
+        fprintf(stderr, "ALERTA: fator de --desenrolar negativo; usando %d\n", DESENROLAMENTO_FATOR);
+        op.desenrola = DESENROLAMENTO_FATOR;
+    }
+    if (op.threads <= 0) op.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    int status;
+    if (observacao) {
+        status = observa(&op, posicionais, num_posicionais);
+    } else if (compara) {
+        if (entrada == NULL) {
+            fprintf(stderr, "--compara-lexicos requer arquivo de entrada\n");
+            status = 1;
+        } else {
+            fclose(yyin);
+            status = lexico_compara(entrada);
+        }
+    } else if (percursos) {
+        if (entrada == NULL) {
+            fprintf(stderr, "--compara-percursos requer arquivo de entrada\n");
+            status = 1;
+        } else {
+            fclose(yyin);
+            status = mede_percursos(&op, entrada);
+        }
     } else {
-        printf("Erros encontrados durante o parsing.\n");
+        status = compila(&op, entrada, saida, NULL);
+    }
+    free(posicionais);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    const char *caminho_socket = NULL;
+    int trabalhadores = 0;
+
+    for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "--servidor") == 0 && k + 1 < argc)
+            caminho_socket = argv[++k];
+        else if (strcmp(argv[k], "--trabalhadores") == 0 && k + 1 < argc)
+            trabalhadores = atoi(argv[++k]);
     }
+    if (caminho_socket == NULL) return calc_executa(argc, argv);
 
-    return 0;
-}
\ No newline at end of file
+    if (trabalhadores <= 0) trabalhadores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return servidor_executa(caminho_socket, trabalhadores, calc_executa);
+}
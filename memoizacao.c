@@ -0,0 +1,26 @@
+#include "memoizacao.h"
+#include "grafo_chamadas.h"
+
+static int tipos_simples(const ParamDecl* p) {
+    for (; p != NULL; p = p->prox)
+        if (p->tipo_param != T_INT && p->tipo_param != T_BOOL) return 0;
+    return 1;
+}
+
+int marca_memoizacao(Programa* p) {
+    GrafoChamadas *g = grafo_constroi(p);
+    int marcadas = 0;
+
+    for (int k = 0; k < grafo_num_nos(g); k++) {
+        const NoGrafo *no = grafo_no(g, k);
+        Decl *d = no->decl;
+        if (d == NULL || d->tipo != DECL_FUNCTION || d->morta) continue;
+        if (!no->recursiva || !grafo_pura(g, k) || d->u.subrot.params == NULL) continue;
+        if (!tipos_simples(d->u.subrot.params)) continue;
+        d->memoizada = 1;
+        marcadas++;
+    }
+
+    grafo_libera(g);
+    return marcadas;
+}
@@ -0,0 +1,23 @@
+#ifndef MEMOIZACAO_H
+#define MEMOIZACAO_H
+
+#include "ast.h"
+
+// Memoização automática (calc --memoizar), decidida na AST antes da
+// análise semântica: uma função recursiva e pura pelo grafo de chamadas
+// (grafo_chamadas.h: sem read nem write e sem tocar globais, nem ela nem
+// o que chama), com ao menos um parâmetro (inteiros e booleanos, os tipos
+// da linguagem), é marcada `memoizada` na declaração. O resultado dela só
+// depende dos argumentos, então o gerador a envolve numa tabela da
+// execução (mepa_memo.h): MEMC na entrada responde pela tabela quando os
+// argumentos já foram vistos, e MEMG antes do retorno grava o resultado
+// sob os argumentos da entrada, que o MEMC guarda (o corpo pode atribuir
+// aos parâmetros).
+// Chamadas que falham ou não terminam não chegam a gravar nada.
+//
+// Só no modo de dois níveis (MEMC retorna como o RTSR) e, como a
+// eliminação, não com --fluxo, que não tem o programa inteiro.
+
+int marca_memoizacao(Programa* p);  // Retorna o número de funções marcadas
+
+#endif
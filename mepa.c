@@ -0,0 +1,330 @@
+#include "mepa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// ======================================================================
+// TABELA DE INSTRUÇÕES
+// ======================================================================
+
+// Operandos além de min_operandos são opcionais (valor -1 quando ausentes)
+static const struct {
+    const char* nome;
+    int min_operandos;
+    int num_operandos;
+    int usa_rotulo;
+} info_ops[MEPA_NUM_OPS] = {
+    [MEPA_INPP] = { "INPP", 0, 2, 0 },
+    [MEPA_PARA] = { "PARA", 0, 0, 0 },
+    [MEPA_AMEM] = { "AMEM", 1, 1, 0 },
+    [MEPA_DMEM] = { "DMEM", 1, 1, 0 },
+    [MEPA_CRCT] = { "CRCT", 1, 1, 0 },
+    [MEPA_CRVL] = { "CRVL", 2, 2, 0 },
+    [MEPA_ARMZ] = { "ARMZ", 2, 2, 0 },
+    [MEPA_CRGB] = { "CRGB", 1, 1, 0 },
+    [MEPA_ARGB] = { "ARGB", 1, 1, 0 },
+    [MEPA_CRLC] = { "CRLC", 1, 1, 0 },
+    [MEPA_ARLC] = { "ARLC", 1, 1, 0 },
+    [MEPA_SOMA] = { "SOMA", 0, 0, 0 },
+    [MEPA_SUBT] = { "SUBT", 0, 0, 0 },
+    [MEPA_MULT] = { "MULT", 0, 0, 0 },
+    [MEPA_DIVI] = { "DIVI", 0, 0, 0 },
+    [MEPA_INVR] = { "INVR", 0, 0, 0 },
+    [MEPA_CONJ] = { "CONJ", 0, 0, 0 },
+    [MEPA_DISJ] = { "DISJ", 0, 0, 0 },
+    [MEPA_NEGA] = { "NEGA", 0, 0, 0 },
+    [MEPA_CMME] = { "CMME", 0, 0, 0 },
+    [MEPA_CMMA] = { "CMMA", 0, 0, 0 },
+    [MEPA_CMIG] = { "CMIG", 0, 0, 0 },
+    [MEPA_CMDG] = { "CMDG", 0, 0, 0 },
+    [MEPA_CMEG] = { "CMEG", 0, 0, 0 },
+    [MEPA_CMAG] = { "CMAG", 0, 0, 0 },
+    [MEPA_DSVS] = { "DSVS", 1, 1, 1 },
+    [MEPA_DSVF] = { "DSVF", 1, 1, 1 },
+    [MEPA_NADA] = { "NADA", 0, 0, 0 },
+    [MEPA_LEIT] = { "LEIT", 0, 0, 0 },
+    [MEPA_IMPR] = { "IMPR", 0, 0, 0 },
+    [MEPA_CHPR] = { "CHPR", 1, 1, 1 },
+    [MEPA_ENPR] = { "ENPR", 1, 1, 0 },
+    [MEPA_RTPR] = { "RTPR", 2, 2, 0 },
+    [MEPA_CHSR] = { "CHSR", 2, 3, 1 },
+    [MEPA_RTSR] = { "RTSR", 2, 2, 0 },
+    [MEPA_CTSR] = { "CTSR", 2, 3, 1 },
+    [MEPA_MEMC] = { "MEMC", 2, 2, 0 },
+    [MEPA_MEMG] = { "MEMG", 1, 1, 1 },
+};
+
+const char* mepa_nome_op(OpMepa op) {
+    if (op < 0 || op >= MEPA_NUM_OPS) return "????";
+    return info_ops[op].nome;
+}
+
+int mepa_num_operandos(OpMepa op) {
+    return info_ops[op].num_operandos;
+}
+
+int mepa_op_usa_rotulo(OpMepa op) {
+    return info_ops[op].usa_rotulo;
+}
+
+int mepa_efeito_pilha(const InstrMepa* i) {
+    switch (i->op) {
+        case MEPA_AMEM: return i->a;
+        case MEPA_DMEM: return -i->a;
+
+        case MEPA_CRCT: case MEPA_CRVL: case MEPA_CRGB: case MEPA_CRLC:
+        case MEPA_LEIT:
+            return 1;
+
+        case MEPA_ARMZ: case MEPA_ARGB: case MEPA_ARLC:
+        case MEPA_SOMA: case MEPA_SUBT: case MEPA_MULT: case MEPA_DIVI:
+        case MEPA_CONJ: case MEPA_DISJ:
+        case MEPA_CMME: case MEPA_CMMA: case MEPA_CMIG: case MEPA_CMDG:
+        case MEPA_CMEG: case MEPA_CMAG:
+        case MEPA_DSVF: case MEPA_IMPR:
+            return -1;
+
+        default:
+            return 0;
+    }
+}
+
+// ======================================================================
+// CONSTRUÇÃO DO CÓDIGO
+// ======================================================================
+
+void mepa_inicia(CodigoMepa* c) {
+    c->instrs = NULL;
+    c->num_instrs = 0;
+    c->capacidade = 0;
+    c->num_rotulos = 0;
+    c->rotulo_pendente = -1;
+    c->linha_corrente = 0;
+    c->nomes = NULL;
+    c->cap_nomes = 0;
+}
+
+void mepa_libera(CodigoMepa* c) {
+    for (int r = 0; r < c->cap_nomes; r++) free(c->nomes[r]);
+    free(c->nomes);
+    free(c->instrs);
+    mepa_inicia(c);
+}
+
+int mepa_emite(CodigoMepa* c, OpMepa op, int a, int b) {
+    if (c->num_instrs == c->capacidade) {
+        c->capacidade = c->capacidade ? 2 * c->capacidade : 256;
+        c->instrs = realloc(c->instrs, c->capacidade * sizeof(InstrMepa));
+        if (c->instrs == NULL) {
+            perror("Erro ao alocar memória para o código MEPA");
+            exit(EXIT_FAILURE);
+        }
+    }
+    InstrMepa *i = &c->instrs[c->num_instrs];
+    i->op = op;
+    i->a = a;
+    i->b = b;
+    i->c = -1;
+    i->rotulo = c->rotulo_pendente;
+    i->linha = c->linha_corrente;
+    c->rotulo_pendente = -1;
+    return c->num_instrs++;
+}
+
+int mepa_novo_rotulo(CodigoMepa* c) {
+    return c->num_rotulos++;
+}
+
+void mepa_define_rotulo(CodigoMepa* c, int rotulo) {
+    if (c->rotulo_pendente >= 0) mepa_emite(c, MEPA_NADA, 0, 0);
+    int idx = mepa_emite(c, MEPA_NADA, 0, 0);
+    c->instrs[idx].rotulo = rotulo;
+}
+
+void mepa_rotula_proxima(CodigoMepa* c, int rotulo) {
+    if (c->rotulo_pendente >= 0) mepa_emite(c, MEPA_NADA, 0, 0);
+    c->rotulo_pendente = rotulo;
+}
+
+void mepa_nomeia_rotulo(CodigoMepa* c, int rotulo, const char* nome) {
+    if (rotulo >= c->cap_nomes) {
+        int cap = c->cap_nomes ? c->cap_nomes : 16;
+        while (cap <= rotulo) cap *= 2;
+        c->nomes = realloc(c->nomes, cap * sizeof(char*));
+        if (c->nomes == NULL) {
+            perror("Erro ao alocar memória para o código MEPA");
+            exit(EXIT_FAILURE);
+        }
+        for (int r = c->cap_nomes; r < cap; r++) c->nomes[r] = NULL;
+        c->cap_nomes = cap;
+    }
+    free(c->nomes[rotulo]);
+    c->nomes[rotulo] = nome ? strdup(nome) : NULL;
+}
+
+const char* mepa_nome_rotulo(const CodigoMepa* c, int rotulo) {
+    return rotulo >= 0 && rotulo < c->cap_nomes ? c->nomes[rotulo] : NULL;
+}
+
+// ======================================================================
+// FORMATO TEXTUAL
+// ======================================================================
+
+#define COLUNA_COMENTARIO 28
+
+void mepa_escreve(FILE* saida, const CodigoMepa* c) {
+    int linha = 0;
+
+    for (int k = 0; k < c->num_instrs; k++) {
+        const InstrMepa *i = &c->instrs[k];
+        char texto[96];
+        int n = 0;
+
+        if (i->rotulo >= 0 && mepa_nome_rotulo(c, i->rotulo))
+            fprintf(saida, "; rotina %s\n", mepa_nome_rotulo(c, i->rotulo));
+
+        if (i->rotulo >= 0)
+            n += snprintf(texto + n, sizeof(texto) - n, "R%02d: ", i->rotulo);
+        else
+            n += snprintf(texto + n, sizeof(texto) - n, "     ");
+
+        n += snprintf(texto + n, sizeof(texto) - n, "%s", mepa_nome_op(i->op));
+
+        int ops[3] = { i->a, i->b, i->c };
+        for (int k = 0; k < info_ops[i->op].num_operandos; k++) {
+            if (k >= info_ops[i->op].min_operandos && ops[k] < 0) break;
+            n += snprintf(texto + n, sizeof(texto) - n, k == 0 ? " " : ",");
+            if (k == 0 && mepa_op_usa_rotulo(i->op))
+                n += snprintf(texto + n, sizeof(texto) - n, "R%02d", ops[k]);
+            else
+                n += snprintf(texto + n, sizeof(texto) - n, "%d", ops[k]);
+        }
+
+        if (i->linha > 0 && i->linha != linha) {
+            fprintf(saida, "%-*s; linha %d\n", COLUNA_COMENTARIO, texto, i->linha);
+            linha = i->linha;
+        } else {
+            fprintf(saida, "%s\n", texto);
+        }
+    }
+}
+
+// Lê um rótulo no formato "R<número>"; retorna -1 se não for um rótulo
+static int le_rotulo(const char** p) {
+    const char *s = *p;
+    if (*s != 'R' || !isdigit((unsigned char)s[1])) return -1;
+    s++;
+    int r = (int)strtol(s, (char**)&s, 10);
+    *p = s;
+    return r;
+}
+
+static void pula_espacos(const char** p) {
+    while (**p == ' ' || **p == '\t' || **p == '\r') (*p)++;
+}
+
+int mepa_le(FILE* entrada, CodigoMepa* c) {
+    char linha[256];
+    int num_linha = 0;
+    char *nome_pendente = NULL;  // De "; rotina NOME", para o próximo rótulo
+
+    mepa_inicia(c);
+
+    while (fgets(linha, sizeof(linha), entrada)) {
+        const char *p = linha;
+        num_linha++;
+
+        // Comentários: "; linha N" vale a partir desta instrução
+        char *comentario = strchr(linha, ';');
+        if (comentario != NULL) {
+            char nome_rotina[64];
+            int n_linha;
+            if (sscanf(comentario, "; linha %d", &n_linha) == 1) {
+                c->linha_corrente = n_linha;
+            } else if (sscanf(comentario, "; rotina %63s", nome_rotina) == 1) {
+                free(nome_pendente);
+                nome_pendente = strdup(nome_rotina);
+            }
+            *comentario = '\0';
+        }
+
+        pula_espacos(&p);
+        if (*p == '\n' || *p == '\0') continue;
+
+        // Rótulo opcional ("R00:")
+        int rotulo = -1;
+        const char *q = p;
+        int r = le_rotulo(&q);
+        if (r >= 0 && *q == ':') {
+            rotulo = r;
+            p = q + 1;
+            pula_espacos(&p);
+        }
+
+        // Mnemônico
+        char nome[8];
+        int n = 0;
+        while (isalpha((unsigned char)*p) && n < 7) nome[n++] = *p++;
+        nome[n] = '\0';
+
+        int op;
+        for (op = 0; op < MEPA_NUM_OPS; op++)
+            if (strcmp(nome, info_ops[op].nome) == 0) break;
+
+        if (op == MEPA_NUM_OPS) {
+            fprintf(stderr, "ERRO MEPA na linha %d: instrução desconhecida '%s'\n", num_linha, nome);
+            free(nome_pendente);
+            mepa_libera(c);
+            return 1;
+        }
+
+        // Operandos
+        int ops[3] = { 0, 0, -1 };
+        for (int k = 0; k < info_ops[op].num_operandos; k++) {
+            pula_espacos(&p);
+            if (k >= info_ops[op].min_operandos) {
+                ops[k] = -1;
+                if (k == 0 ? (*p == '\n' || *p == '\0') : *p != ',') continue;
+            }
+            if (k > 0) {
+                if (*p == ',') p++;
+                pula_espacos(&p);
+            }
+            if (info_ops[op].usa_rotulo && k == 0) {
+                ops[k] = le_rotulo(&p);
+            } else {
+                char *fim;
+                long v = strtol(p, &fim, 10);
+                if (fim == p) {
+                    p = NULL;
+                } else {
+                    ops[k] = (int)v;
+                    p = fim;
+                }
+            }
+            if (p == NULL || (info_ops[op].usa_rotulo && k == 0 && ops[k] < 0)) {
+                fprintf(stderr, "ERRO MEPA na linha %d: operando inválido para %s\n", num_linha, nome);
+                free(nome_pendente);
+                mepa_libera(c);
+                return 1;
+            }
+        }
+
+        int idx = mepa_emite(c, (OpMepa)op, ops[0], ops[1]);
+        c->instrs[idx].c = ops[2];
+        c->instrs[idx].rotulo = rotulo;
+
+        if (rotulo >= c->num_rotulos) c->num_rotulos = rotulo + 1;
+        if (info_ops[op].usa_rotulo && ops[0] >= c->num_rotulos) c->num_rotulos = ops[0] + 1;
+
+        if (rotulo >= 0 && nome_pendente != NULL) {
+            mepa_nomeia_rotulo(c, rotulo, nome_pendente);
+            free(nome_pendente);
+            nome_pendente = NULL;
+        }
+    }
+
+    free(nome_pendente);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef MEPA_H
+#define MEPA_H
+
+#include <stdio.h>
+
+// ----------------------------------------------------------------------
+// 1. Conjunto de Instruções da MEPA
+// ----------------------------------------------------------------------
+
+typedef enum {
+    MEPA_INPP,  // Inicia programa principal (opcional: m,t; ver mepa_vm.h)
+    MEPA_PARA,  // Para a execução
+    MEPA_AMEM,  // Aloca n posições de memória
+    MEPA_DMEM,  // Desaloca n posições de memória
+    MEPA_CRCT,  // Carrega constante
+
+    // Acesso genérico a variáveis (nível k, deslocamento n) via display
+    MEPA_CRVL,
+    MEPA_ARMZ,
+
+    // Acesso especializado para os dois níveis léxicos de Rascal:
+    // globais têm endereço absoluto e locais são relativas à base do
+    // registro de ativação corrente (sem display nem elo estático)
+    MEPA_CRGB,  // Carrega global:  M[n]
+    MEPA_ARGB,  // Armazena global: M[n]
+    MEPA_CRLC,  // Carrega local:   M[base + n]
+    MEPA_ARLC,  // Armazena local:  M[base + n]
+
+    // Aritméticas e lógicas
+    MEPA_SOMA, MEPA_SUBT, MEPA_MULT, MEPA_DIVI, MEPA_INVR,
+    MEPA_CONJ, MEPA_DISJ, MEPA_NEGA,
+
+    // Comparações
+    MEPA_CMME, MEPA_CMMA, MEPA_CMIG, MEPA_CMDG, MEPA_CMEG, MEPA_CMAG,
+
+    // Desvios
+    MEPA_DSVS, MEPA_DSVF, MEPA_NADA,
+
+    // Entrada e saída
+    MEPA_LEIT, MEPA_IMPR,
+
+    // Sub-rotinas (forma genérica, com display)
+    MEPA_CHPR,  // Chama procedimento
+    MEPA_ENPR,  // Entra no procedimento de nível k
+    MEPA_RTPR,  // Retorna do procedimento de nível k com n parâmetros
+
+    // Sub-rotinas (forma de dois níveis, sem display: só há uma base local)
+    MEPA_CHSR,  // Chama a sub-rotina p: CHPR+ENPR+AMEM l fundidas (opcional: d)
+    MEPA_RTSR,  // DMEM l+RTPR n fundidas
+    MEPA_CTSR,  // Chamada terminal de p: troca as locais do registro corrente
+                // pelas l de p e desvia, sem empilhar ligação (opcional: d)
+
+    // Memoização de funções (mepa_memo.h)
+    MEPA_MEMC,  // Consulta a tabela da função com os n argumentos do registro:
+                // se estiverem lá, põe o valor no retorno e faz RTSR l,n
+    MEPA_MEMG,  // Grava na tabela do MEMC p o retorno, com os argumentos
+                // que o MEMC guardou na entrada
+
+    MEPA_NUM_OPS
+} OpMepa;
+
+// Uma instrução MEPA. Enquanto o código está em construção (ou acabou de
+// ser lido de um arquivo), o operando de desvios e chamadas é um número
+// de rótulo; após mepa_carrega (mepa_vm.h) passa a ser o endereço.
+typedef struct {
+    OpMepa op;
+    int a;       // 1º operando (constante, deslocamento, nível, rótulo...)
+    int b;       // 2º operando (quando houver)
+    int c;       // 3º operando (CHSR e CTSR; -1 se ausente)
+    int rotulo;  // Rótulo definido nesta instrução (-1 se nenhum)
+    int linha;   // Linha do código-fonte que a gerou (0 se desconhecida)
+} InstrMepa;
+
+// Buffer de instruções gerado pelo compilador
+typedef struct {
+    InstrMepa* instrs;
+    int num_instrs;
+    int capacidade;
+    int num_rotulos;
+    int rotulo_pendente;  // Rótulo a ser posto na próxima instrução emitida
+    int linha_corrente;   // Linha do fonte atribuída às instruções emitidas
+    char** nomes;         // Nome da sub-rotina de cada rótulo de entrada (ou NULL)
+    int cap_nomes;
+} CodigoMepa;
+
+// ----------------------------------------------------------------------
+// 2. Construção do Código
+// ----------------------------------------------------------------------
+
+void mepa_inicia(CodigoMepa* c);
+void mepa_libera(CodigoMepa* c);
+
+int mepa_emite(CodigoMepa* c, OpMepa op, int a, int b);
+int mepa_novo_rotulo(CodigoMepa* c);
+void mepa_define_rotulo(CodigoMepa* c, int rotulo); // Emite "Rn: NADA"
+void mepa_rotula_proxima(CodigoMepa* c, int rotulo); // Rotula a próxima instrução
+
+// Nome (da sub-rotina) associado a um rótulo; usado pelo perfilador
+void mepa_nomeia_rotulo(CodigoMepa* c, int rotulo, const char* nome);
+const char* mepa_nome_rotulo(const CodigoMepa* c, int rotulo); // NULL se não tiver
+
+// ----------------------------------------------------------------------
+// 3. Informações sobre as Instruções
+// ----------------------------------------------------------------------
+
+const char* mepa_nome_op(OpMepa op);
+int mepa_num_operandos(OpMepa op);
+int mepa_op_usa_rotulo(OpMepa op); // 1º operando é rótulo: DSVS, DSVF, CHPR, CHSR, CTSR e MEMG
+
+// Variação da altura da pilha causada pela instrução. Chamadas (CHPR,
+// CHSR, CTSR) contam 0: o efeito depende da sub-rotina chamada.
+int mepa_efeito_pilha(const InstrMepa* i);
+
+// ----------------------------------------------------------------------
+// 4. Formato Textual (arquivo .mepa)
+// ----------------------------------------------------------------------
+
+// Tudo após ';' é comentário. Dois comentários carregam informação para o
+// perfilador: "; linha N" ao fim de uma instrução (vale para ela e as
+// seguintes, até o próximo) e "; rotina NOME" sozinho numa linha, que
+// nomeia o rótulo da instrução seguinte.
+
+void mepa_escreve(FILE* saida, const CodigoMepa* c);
+int mepa_le(FILE* entrada, CodigoMepa* c); // Retorna 0 em caso de sucesso
+
+#endif
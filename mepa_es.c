@@ -0,0 +1,116 @@
+#include "mepa_es.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+
+static char* novo_buffer(void) {
+    char *buf = malloc(MEPA_ES_TAM_BUFFER);
+    if (buf == NULL) {
+        perror("Erro ao alocar o buffer de entrada/saída da MEPA");
+        exit(EXIT_FAILURE);
+    }
+    return buf;
+}
+
+// ======================================================================
+// SAÍDA
+// ======================================================================
+
+void mepa_saida_inicia(SaidaMepa* s, FILE* arquivo) {
+    s->arquivo = arquivo;
+    s->buf = novo_buffer();
+    s->pos = 0;
+}
+
+void mepa_saida_descarrega(SaidaMepa* s) {
+    if (s->pos > 0) fwrite(s->buf, 1, s->pos, s->arquivo);
+    fflush(s->arquivo);
+    s->pos = 0;
+}
+
+void mepa_saida_libera(SaidaMepa* s) {
+    mepa_saida_descarrega(s);
+    free(s->buf);
+    s->buf = NULL;
+}
+
+void mepa_escreve_inteiro(SaidaMepa* s, int v) {
+    char digitos[10];
+    unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;
+    int n = 0;
+
+    // Sinal, até 10 dígitos e '\n'
+    if (s->pos > MEPA_ES_TAM_BUFFER - 12) mepa_saida_descarrega(s);
+
+    do {
+        digitos[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+
+    if (v < 0) s->buf[s->pos++] = '-';
+    while (n > 0) s->buf[s->pos++] = digitos[--n];
+    s->buf[s->pos++] = '\n';
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+void mepa_entrada_inicia(EntradaMepa* e, FILE* arquivo, SaidaMepa* saida) {
+    e->fd = fileno(arquivo);
+    e->buf = novo_buffer();
+    e->pos = e->fim = 0;
+    e->saida = saida;
+}
+
+void mepa_entrada_libera(EntradaMepa* e) {
+    free(e->buf);
+    e->buf = NULL;
+}
+
+// Lê o próximo bloco; retorna 0 no fim da entrada ou em erro
+static int recarrega(EntradaMepa* e) {
+    if (e->saida != NULL) mepa_saida_descarrega(e->saida);
+
+    ssize_t n;
+    do {
+        n = read(e->fd, e->buf, MEPA_ES_TAM_BUFFER);
+    } while (n < 0 && errno == EINTR);
+
+    e->pos = 0;
+    e->fim = n > 0 ? (int)n : 0;
+    return e->fim > 0;
+}
+
+// Próximo caractere sem consumi-lo (-1 no fim da entrada)
+static inline int espia(EntradaMepa* e) {
+    if (e->pos == e->fim && !recarrega(e)) return -1;
+    return (unsigned char)e->buf[e->pos];
+}
+
+int mepa_le_inteiro(EntradaMepa* e, int* v) {
+    int c = espia(e);
+    while (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+        e->pos++;
+        c = espia(e);
+    }
+
+    int negativo = c == '-';
+    if (c == '-' || c == '+') {
+        e->pos++;
+        c = espia(e);
+    }
+    if (c < '0' || c > '9') return 1;
+
+    // Acumula sem sinal: valores fora do intervalo de int dão a volta
+    unsigned u = 0;
+    do {
+        u = u * 10 + (unsigned)(c - '0');
+        e->pos++;
+        c = espia(e);
+    } while (c >= '0' && c <= '9');
+
+    *v = negativo ? (int)(0u - u) : (int)u;
+    return 0;
+}
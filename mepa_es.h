@@ -0,0 +1,43 @@
+#ifndef MEPA_ES_H
+#define MEPA_ES_H
+
+#include <stdio.h>
+
+// Entrada e saída de inteiros da MEPA (LEIT/IMPR) com buffers grandes e
+// conversão feita à mão, sem uma chamada de scanf/printf por valor.
+// A entrada é lida do descritor do arquivo em blocos; a saída acumula no
+// buffer e é gravada quando ele enche, antes de a entrada ter de esperar
+// por mais dados (para que um programa interativo mostre o que escreveu
+// antes de ler) e ao fim da execução.
+
+#define MEPA_ES_TAM_BUFFER (1 << 16)
+
+typedef struct {
+    FILE* arquivo;
+    char* buf;
+    int pos;
+} SaidaMepa;
+
+typedef struct {
+    int fd;
+    char* buf;
+    int pos, fim;
+    SaidaMepa* saida;       // Descarregada antes de cada leitura de bloco (pode ser NULL)
+} EntradaMepa;
+
+void mepa_saida_inicia(SaidaMepa* s, FILE* arquivo);
+void mepa_saida_descarrega(SaidaMepa* s);
+void mepa_saida_libera(SaidaMepa* s); // Descarrega e libera o buffer
+
+void mepa_entrada_inicia(EntradaMepa* e, FILE* arquivo, SaidaMepa* saida);
+void mepa_entrada_libera(EntradaMepa* e);
+
+// Lê um inteiro decimal (com sinal opcional) após espaços em branco, como
+// "%d"; retorna 0 em caso de sucesso e 1 no fim da entrada ou se não houver
+// um número
+int mepa_le_inteiro(EntradaMepa* e, int* v);
+
+// Escreve o inteiro seguido de '\n'
+void mepa_escreve_inteiro(SaidaMepa* s, int v);
+
+#endif
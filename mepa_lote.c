@@ -0,0 +1,88 @@
+#include "mepa_lote.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef struct {
+    const ProgramaMepa* p;
+    const char* const* entradas;
+    const char* const* saidas;
+    int n;
+    atomic_int proxima;     // Próxima instância a executar
+    atomic_int falhas;
+    atomic_llong instrucoes;
+} Lote;
+
+static void executa_instancia(Lote* l, int k) {
+    FILE *entrada = fopen(l->entradas[k], "r");
+    if (entrada == NULL) {
+        perror(l->entradas[k]);
+        atomic_fetch_add(&l->falhas, 1);
+        return;
+    }
+    FILE *saida = fopen(l->saidas[k], "w");
+    if (saida == NULL) {
+        perror(l->saidas[k]);
+        fclose(entrada);
+        atomic_fetch_add(&l->falhas, 1);
+        return;
+    }
+
+    EstatisticasMepa est;
+    if (mepa_executa(l->p, entrada, saida, &est) != 0) {
+        fprintf(stderr, "%s: execução interrompida por erro\n", l->entradas[k]);
+        atomic_fetch_add(&l->falhas, 1);
+    }
+    atomic_fetch_add(&l->instrucoes, est.instrucoes);
+
+    fclose(entrada);
+    if (fclose(saida) != 0) {
+        perror(l->saidas[k]);
+        atomic_fetch_add(&l->falhas, 1);
+    }
+}
+
+static void* trabalhador(void* arg) {
+    Lote *l = arg;
+    for (;;) {
+        int k = atomic_fetch_add(&l->proxima, 1);
+        if (k >= l->n) break;
+        executa_instancia(l, k);
+    }
+    return NULL;
+}
+
+int mepa_executa_lote(const ProgramaMepa* p, const char* const* entradas, const char* const* saidas,
+                      int n, int threads, EstatisticasLote* est) {
+    Lote l = { .p = p, .entradas = entradas, .saidas = saidas, .n = n };
+    atomic_init(&l.proxima, 0);
+    atomic_init(&l.falhas, 0);
+    atomic_init(&l.instrucoes, 0);
+
+    if (threads > n) threads = n;
+    if (threads <= 1) {
+        trabalhador(&l);
+    } else {
+        pthread_t *ids = malloc(threads * sizeof(pthread_t));
+        if (ids == NULL) {
+            perror("Erro ao alocar as threads do lote");
+            exit(EXIT_FAILURE);
+        }
+
+        // A thread chamadora também trabalha
+        int criadas = 0;
+        while (criadas < threads - 1 && pthread_create(&ids[criadas], NULL, trabalhador, &l) == 0)
+            criadas++;
+        trabalhador(&l);
+        for (int t = 0; t < criadas; t++) pthread_join(ids[t], NULL);
+        free(ids);
+    }
+
+    if (est != NULL) {
+        est->instancias = n;
+        est->falhas = atomic_load(&l.falhas);
+        est->instrucoes = atomic_load(&l.instrucoes);
+    }
+    return atomic_load(&l.falhas);
+}
@@ -0,0 +1,24 @@
+#ifndef MEPA_LOTE_H
+#define MEPA_LOTE_H
+
+#include "mepa_vm.h"
+
+// Execução em lote: o mesmo programa, carregado uma única vez, roda uma
+// instância independente para cada arquivo de entrada, distribuídas entre
+// `threads` threads. O ProgramaMepa é só lido durante a execução e fica
+// compartilhado; cada instância tem a sua memória (pilha de dados), os
+// seus buffers de E/S e os seus arquivos, de modo que iniciar uma
+// instância custa um malloc e dois fopen.
+typedef struct {
+    int instancias;
+    int falhas;             // Instâncias com erro de execução ou de arquivo
+    long long instrucoes;   // Soma das instruções executadas
+} EstatisticasLote;
+
+// Executa `entradas[k]` gravando a saída em `saidas[k]`, para k < n; com
+// threads <= 1 tudo roda na thread chamadora. Retorna o número de falhas;
+// `est` pode ser NULL.
+int mepa_executa_lote(const ProgramaMepa* p, const char* const* entradas, const char* const* saidas,
+                      int n, int threads, EstatisticasLote* est);
+
+#endif
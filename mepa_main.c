@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mepa.h"
+#include "mepa_vm.h"
+#include "mepa_perfil.h"
+#include "mepa_lote.h"
+
+// Interpretador da MEPA: mepa [opções] programa.mepa
+//   --stats            estatísticas da execução em stderr
+//   --sem-verificador  executa no laço protegido mesmo programas verificados
+//                      (para comparar o desempenho das duas variantes)
+//   --sem-fusao        não funde superinstruções na carga (--no-fuse)
+//   --perfil-pares     conta os pares de instruções consecutivas executados
+//                      e lista os mais frequentes em stderr
+//   --perfil           perfil plano (sub-rotinas, linhas do fonte e
+//                      instruções) em stderr
+//   --pilhas ARQUIVO   perfil e pilhas de chamadas no formato "folded" dos
+//                      flame graphs em ARQUIVO
+//
+// Em lote: mepa --lote [--threads N] [--stats] programa.mepa entrada...
+//   executa uma instância do programa para cada arquivo de entrada, em N
+//   threads (padrão: número de processadores), gravando a saída de cada
+//   uma em ENTRADA.saida
+
+#define NUM_PARES_LISTADOS 20
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void lista_pares(long long pares[MEPA_NUM_OPS][MEPA_NUM_OPS]) {
+    long long total = 0;
+    for (int a = 0; a < MEPA_NUM_OPS; a++)
+        for (int b = 0; b < MEPA_NUM_OPS; b++)
+            total += pares[a][b];
+
+    fprintf(stderr, "Pares de instruções mais frequentes (%lld no total):\n", total);
+    for (int n = 0; n < NUM_PARES_LISTADOS && total > 0; n++) {
+        int ma = 0, mb = 0;
+        for (int a = 0; a < MEPA_NUM_OPS; a++)
+            for (int b = 0; b < MEPA_NUM_OPS; b++)
+                if (pares[a][b] > pares[ma][mb]) ma = a, mb = b;
+        if (pares[ma][mb] == 0) break;
+        fprintf(stderr, "  %6.2f%%  %s %s  (%lld)\n", 100.0 * pares[ma][mb] / total,
+                mepa_nome_op(ma), mepa_nome_op(mb), pares[ma][mb]);
+        pares[ma][mb] = 0;
+    }
+}
+
+static int executa_lote(const ProgramaMepa* prog, char** entradas, int n, int threads, int mostra_stats) {
+    char **saidas = malloc((n > 0 ? n : 1) * sizeof(char*));
+    if (saidas == NULL) {
+        perror("Erro ao alocar memória");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < n; k++) {
+        size_t tam = strlen(entradas[k]) + sizeof(".saida");
+        saidas[k] = malloc(tam);
+        if (saidas[k] == NULL) {
+            perror("Erro ao alocar memória");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(saidas[k], tam, "%s.saida", entradas[k]);
+    }
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    EstatisticasLote est;
+    double inicio = agora();
+    int falhas = mepa_executa_lote(prog, (const char* const*)entradas, (const char* const*)saidas,
+                                   n, threads, &est);
+    double tempo = agora() - inicio;
+
+    if (mostra_stats) {
+        fprintf(stderr, "Instâncias: %d (%d com falha) em %d threads\n", est.instancias, est.falhas,
+                threads < n ? threads : n);
+        fprintf(stderr, "Instruções executadas: %lld\n", est.instrucoes);
+        fprintf(stderr, "Tempo de execução: %.3f s (%.0f instâncias/s)\n", tempo,
+                tempo > 0 ? n / tempo : 0.0);
+    }
+
+    for (int k = 0; k < n; k++) free(saidas[k]);
+    free(saidas);
+    return falhas > 0;
+}
+
+int main(int argc, char **argv) {
+    const char *arquivo = NULL, *arquivo_pilhas = NULL;
+    int mostra_stats = 0, protegido = 0, perfil_pares = 0, perfil = 0, opcoes = 0;
+    int lote = 0, threads = 0, num_entradas = 0;
+    char **entradas = malloc(argc * sizeof(char*));
+    if (entradas == NULL) {
+        perror("Erro ao alocar memória");
+        return 1;
+    }
+
+    for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "--stats") == 0)
+            mostra_stats = 1;
+        else if (strcmp(argv[k], "--sem-verificador") == 0)
+            protegido = 1;
+        else if (strcmp(argv[k], "--sem-fusao") == 0 || strcmp(argv[k], "--no-fuse") == 0)
+            opcoes |= MEPA_SEM_FUSAO;
+        else if (strcmp(argv[k], "--perfil-pares") == 0)
+            perfil_pares = 1;
+        else if (strcmp(argv[k], "--perfil") == 0)
+            perfil = 1;
+        else if (strcmp(argv[k], "--pilhas") == 0 && k + 1 < argc)
+            perfil = 1, arquivo_pilhas = argv[++k];
+        else if (strcmp(argv[k], "--lote") == 0)
+            lote = 1;
+        else if (strcmp(argv[k], "--threads") == 0 && k + 1 < argc)
+            threads = atoi(argv[++k]);
+        else if (lote && arquivo != NULL)
+            entradas[num_entradas++] = argv[k];
+        else
+            arquivo = argv[k];
+    }
+
+    if (arquivo == NULL || (lote && (perfil || perfil_pares))) {
+        fprintf(stderr, "Uso: %s [--stats] [--sem-verificador] [--sem-fusao] [--perfil-pares]\n"
+                        "         [--perfil] [--pilhas arquivo] programa.mepa\n"
+                        "       %s --lote [--threads n] [--stats] [--sem-verificador] [--sem-fusao]\n"
+                        "         programa.mepa entrada...\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(arquivo, "r");
+    if (!f) {
+        perror("Erro ao abrir programa MEPA");
+        return 1;
+    }
+
+    CodigoMepa codigo;
+    int falhou = mepa_le(f, &codigo);
+    fclose(f);
+    if (falhou) return 1;
+
+    // Os perfis são sempre das instruções originais
+    if (perfil_pares || perfil) opcoes |= MEPA_SEM_FUSAO;
+
+    ProgramaMepa prog;
+    falhou = mepa_carrega(&codigo, &prog, opcoes);
+    mepa_libera(&codigo);
+    if (falhou) return 1;
+    if (protegido) prog.verificado = 0;
+
+    if (lote) {
+        int resultado = executa_lote(&prog, entradas, num_entradas, threads, mostra_stats);
+        free(entradas);
+        mepa_descarrega(&prog);
+        return resultado;
+    }
+    free(entradas);
+
+    if (perfil_pares) {
+        static long long pares[MEPA_NUM_OPS][MEPA_NUM_OPS];
+        int resultado = mepa_perfil_pares(&prog, stdin, stdout, pares);
+        lista_pares(pares);
+        mepa_descarrega(&prog);
+        return resultado;
+    }
+
+    EstatisticasMepa est;
+    PerfilMepa perf;
+    if (perfil) mepa_perfil_inicia(&perf, &prog);
+
+    double inicio = agora();
+    int resultado = perfil ? mepa_perfila(&prog, stdin, stdout, &est, &perf)
+                           : mepa_executa(&prog, stdin, stdout, &est);
+    double tempo = agora() - inicio;
+
+    if (mostra_stats) {
+        fprintf(stderr, "Instruções executadas: %lld\n", est.instrucoes);
+        if (est.pilha_max >= 0)
+            fprintf(stderr, "Pilha máxima: %d\n", est.pilha_max + 1);
+        fprintf(stderr, "Memória alocada: %d%s\n", est.memoria,
+                prog.anotado ? " (profundidade calculada pelo compilador)" : "");
+        fprintf(stderr, "Laço de execução: %s\n", prog.verificado ? "verificado" : "protegido");
+        if (prog.num_memos > 0)
+            fprintf(stderr, "Memoização: %d tabela(s), %lld acerto(s), %lld falta(s), %lld remoção(ões)\n",
+                    prog.num_memos, est.memo_acertos, est.memo_faltas, est.memo_remocoes);
+        fprintf(stderr, "Tempo de execução: %.3f s\n", tempo);
+    }
+
+    if (perfil) {
+        mepa_perfil_imprime(stderr, &prog, &perf);
+        if (arquivo_pilhas != NULL) {
+            FILE *fp = fopen(arquivo_pilhas, "w");
+            if (fp == NULL) {
+                perror("Erro ao abrir arquivo de pilhas");
+            } else {
+                mepa_perfil_pilhas(fp, &prog, &perf);
+                fclose(fp);
+            }
+        }
+        mepa_perfil_libera(&perf);
+    }
+
+    mepa_descarrega(&prog);
+    return resultado;
+}
@@ -0,0 +1,128 @@
+#include "mepa_memo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_CONJUNTOS (MEPA_MEMO_ENTRADAS / MEPA_MEMO_VIAS)
+
+void mepa_memo_inicia(MemoMepa* m, int num_tabelas) {
+    m->num_tabelas = num_tabelas;
+    m->tabelas = num_tabelas > 0 ? calloc(num_tabelas, sizeof(TabelaMemo)) : NULL;
+    if (num_tabelas > 0 && m->tabelas == NULL) {
+        perror("Erro ao alocar as tabelas de memoização da MEPA");
+        exit(EXIT_FAILURE);
+    }
+    m->acertos = m->faltas = m->remocoes = 0;
+    m->chaves = NULL;
+    m->num_chaves = m->cap_chaves = 0;
+}
+
+void mepa_memo_libera(MemoMepa* m) {
+    for (int t = 0; t < m->num_tabelas; t++) {
+        free(m->tabelas[t].entradas);
+        free(m->tabelas[t].usadas);
+    }
+    free(m->tabelas);
+    m->tabelas = NULL;
+    m->num_tabelas = 0;
+    free(m->chaves);
+    m->chaves = NULL;
+    m->num_chaves = m->cap_chaves = 0;
+}
+
+static unsigned conjunto(const int* args, int n) {
+    unsigned long long h = 0x9e3779b97f4a7c15ull;
+    for (int k = 0; k < n; k++) {
+        h ^= (unsigned)args[k];
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    return (unsigned)(h % NUM_CONJUNTOS);
+}
+
+int mepa_memo_consulta(MemoMepa* m, int t, const int* args, int n, int* valor) {
+    TabelaMemo *tab = &m->tabelas[t];
+    if (tab->entradas == NULL) {
+        m->faltas++;
+        return 0;
+    }
+
+    unsigned c = conjunto(args, n);
+    int tam = n + 1, *vias = &tab->entradas[(size_t)c * MEPA_MEMO_VIAS * tam];
+    for (int v = 0; v < tab->usadas[c]; v++) {
+        int *e = &vias[v * tam];
+        if (memcmp(e, args, n * sizeof(int)) != 0) continue;
+
+        // Para a frente do conjunto
+        *valor = e[n];
+        if (v > 0) {
+            int achada[tam];
+            memcpy(achada, e, tam * sizeof(int));
+            memmove(&vias[tam], vias, v * tam * sizeof(int));
+            memcpy(vias, achada, tam * sizeof(int));
+        }
+        m->acertos++;
+        return 1;
+    }
+    m->faltas++;
+    return 0;
+}
+
+void mepa_memo_grava(MemoMepa* m, int t, const int* args, int n, int valor) {
+    TabelaMemo *tab = &m->tabelas[t];
+    int tam = n + 1;
+    if (tab->entradas == NULL) {
+        tab->num_args = n;
+        tab->entradas = malloc((size_t)MEPA_MEMO_ENTRADAS * tam * sizeof(int));
+        tab->usadas = calloc(NUM_CONJUNTOS, 1);
+        if (tab->entradas == NULL || tab->usadas == NULL) {
+            perror("Erro ao alocar as tabelas de memoização da MEPA");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // A chave pode já estar lá, gravada por uma chamada aninhada com os
+    // mesmos argumentos: atualiza no lugar (o valor é o mesmo)
+    unsigned c = conjunto(args, n);
+    int *vias = &tab->entradas[(size_t)c * MEPA_MEMO_VIAS * tam];
+    for (int v = 0; v < tab->usadas[c]; v++) {
+        if (memcmp(&vias[v * tam], args, n * sizeof(int)) == 0) {
+            vias[v * tam + n] = valor;
+            return;
+        }
+    }
+
+    if (tab->usadas[c] == MEPA_MEMO_VIAS)
+        m->remocoes++;
+    else
+        tab->usadas[c]++;
+    memmove(&vias[tam], vias, (tab->usadas[c] - 1) * tam * sizeof(int));
+    memcpy(vias, args, n * sizeof(int));
+    vias[n] = valor;
+}
+
+void mepa_memo_empilha(MemoMepa* m, int base, const int* args, int n) {
+    if (m->num_chaves + n + 2 > m->cap_chaves) {
+        while (m->num_chaves + n + 2 > m->cap_chaves) m->cap_chaves = m->cap_chaves ? 2 * m->cap_chaves : 256;
+        m->chaves = realloc(m->chaves, m->cap_chaves * sizeof(int));
+        if (m->chaves == NULL) {
+            perror("Erro ao alocar as chaves de memoização da MEPA");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(&m->chaves[m->num_chaves], args, n * sizeof(int));
+    m->num_chaves += n;
+    m->chaves[m->num_chaves++] = n;
+    m->chaves[m->num_chaves++] = base;
+}
+
+const int* mepa_memo_desempilha(MemoMepa* m, int base) {
+    // As chaves de registros mais altos são de chamadas que saíram por CTSR
+    while (m->num_chaves > 0 && m->chaves[m->num_chaves - 1] > base)
+        m->num_chaves -= m->chaves[m->num_chaves - 2] + 2;
+    if (m->num_chaves == 0 || m->chaves[m->num_chaves - 1] != base) return NULL;
+
+    int n = m->chaves[m->num_chaves - 2];
+    m->num_chaves -= n + 2;
+    return &m->chaves[m->num_chaves];
+}
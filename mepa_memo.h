@@ -0,0 +1,49 @@
+#ifndef MEPA_MEMO_H
+#define MEPA_MEMO_H
+
+// Tabelas de memoização das funções marcadas pelo compilador (calc
+// --memoizar): uma por instrução MEMC do programa, criada na primeira
+// gravação. A chave é a tupla dos n argumentos; o valor, o retorno.
+//
+// Cada tabela tem no máximo MEPA_MEMO_ENTRADAS entradas, em conjuntos de
+// MEPA_MEMO_VIAS (hash dos argumentos módulo o número de conjuntos).
+// Dentro de um conjunto as entradas ficam da mais para a menos usada:
+// um acerto leva a entrada para a frente e, com o conjunto cheio, uma
+// gravação descarta a última (LRU no conjunto). As tabelas são de uma
+// execução: instâncias do lote não compartilham nada.
+
+#define MEPA_MEMO_ENTRADAS (1 << 14)   // Por tabela
+#define MEPA_MEMO_VIAS 4
+
+typedef struct {
+    int num_args;
+    int* entradas;          // Conjuntos de VIAS entradas: argumentos e valor
+    unsigned char* usadas;  // Entradas ocupadas em cada conjunto
+} TabelaMemo;
+
+typedef struct {
+    TabelaMemo* tabelas;
+    int num_tabelas;
+    long long acertos, faltas, remocoes;
+    int* chaves;            // Pilha das chamadas em curso: argumentos, n e base do registro
+    int num_chaves, cap_chaves;
+} MemoMepa;
+
+void mepa_memo_inicia(MemoMepa* m, int num_tabelas);
+void mepa_memo_libera(MemoMepa* m);
+
+// Procura os `n` argumentos na tabela `t`; retorna 1 e o valor em *valor
+// se estiverem lá
+int mepa_memo_consulta(MemoMepa* m, int t, const int* args, int n, int* valor);
+void mepa_memo_grava(MemoMepa* m, int t, const int* args, int n, int valor);
+
+// Chaves das chamadas em curso. O MEMC que não acha os argumentos guarda
+// uma cópia deles com a base do registro, e o MEMG grava com a cópia: o
+// corpo pode ter mudado os parâmetros. Uma chamada que sai por CTSR não
+// chega ao MEMG; a chave dela fica acima das chamadas de registro mais
+// baixo e é descartada pelo próximo MEMG de uma delas. Retorna NULL se não
+// há chave para `base` (o MEMG não grava).
+void mepa_memo_empilha(MemoMepa* m, int base, const int* args, int n);
+const int* mepa_memo_desempilha(MemoMepa* m, int base);
+
+#endif
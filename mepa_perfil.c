@@ -0,0 +1,183 @@
+#include "mepa_perfil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_INSTRUCOES_LISTADAS 20
+
+static void* perf_calloc(size_t n, size_t tam) {
+    void *ptr = calloc(n > 0 ? n : 1, tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o perfilador MEPA");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// ======================================================================
+// COLETA
+// ======================================================================
+
+static int novo_no(PerfilMepa* perf, int pai, int entrada) {
+    if (perf->num_nos == perf->cap_nos) {
+        perf->cap_nos = perf->cap_nos ? 2 * perf->cap_nos : 64;
+        perf->nos = realloc(perf->nos, perf->cap_nos * sizeof(NoChamadas));
+        if (perf->nos == NULL) {
+            perror("Erro ao alocar memória para o perfilador MEPA");
+            exit(EXIT_FAILURE);
+        }
+    }
+    NoChamadas *n = &perf->nos[perf->num_nos];
+    n->pai = pai;
+    n->entrada = entrada;
+    n->filho = n->irmao = -1;
+    n->ciclos = n->instrucoes = 0;
+    return perf->num_nos++;
+}
+
+void mepa_perfil_inicia(PerfilMepa* perf, const ProgramaMepa* p) {
+    perf->execucoes = perf_calloc(p->tamanho, sizeof(long long));
+    perf->ciclos = perf_calloc(p->tamanho, sizeof(long long));
+    perf->rotina = perf_calloc(p->tamanho, sizeof(int));
+    perf->nos = NULL;
+    perf->num_nos = perf->cap_nos = 0;
+    novo_no(perf, -1, 0);
+}
+
+void mepa_perfil_libera(PerfilMepa* perf) {
+    free(perf->execucoes);
+    free(perf->ciclos);
+    free(perf->rotina);
+    free(perf->nos);
+    memset(perf, 0, sizeof(*perf));
+}
+
+int mepa_perfil_filho(PerfilMepa* perf, int no, int entrada) {
+    for (int f = perf->nos[no].filho; f >= 0; f = perf->nos[f].irmao)
+        if (perf->nos[f].entrada == entrada) return f;
+
+    int f = novo_no(perf, no, entrada);
+    perf->nos[f].irmao = perf->nos[no].filho;
+    perf->nos[no].filho = f;
+    return f;
+}
+
+// ======================================================================
+// RELATÓRIOS
+// ======================================================================
+
+static const char* nome_rotina(const ProgramaMepa* p, int entrada, char* buf, size_t tam) {
+    if (entrada == 0) return "principal";
+    if (p->nomes != NULL && p->nomes[entrada] != NULL) return p->nomes[entrada];
+    snprintf(buf, tam, "rotina_%d", entrada);
+    return buf;
+}
+
+typedef struct {
+    int chave;
+    long long ciclos;
+    long long contagem;
+} Linha;
+
+static int compara_linhas(const void* a, const void* b) {
+    const Linha *x = a, *y = b;
+    if (x->ciclos != y->ciclos) return x->ciclos < y->ciclos ? 1 : -1;
+    return x->chave - y->chave;
+}
+
+static double porcento(long long v, long long total) {
+    return total > 0 ? 100.0 * v / total : 0.0;
+}
+
+void mepa_perfil_imprime(FILE* f, const ProgramaMepa* p, const PerfilMepa* perf) {
+    char buf[32];
+    long long total = 0;
+    for (int n = 0; n < perf->num_nos; n++) total += perf->nos[n].ciclos;
+
+    fprintf(f, "Perfil da execução: %lld %s no total\n", total, MEPA_PERFIL_UNIDADE);
+
+    // Por sub-rotina: soma dos nós de todas as pilhas em que ela está no topo
+    Linha *rot = perf_calloc(p->tamanho, sizeof(Linha));
+    int num_rot = 0;
+    for (int n = 0; n < perf->num_nos; n++) {
+        int r;
+        for (r = 0; r < num_rot && rot[r].chave != perf->nos[n].entrada; r++) { }
+        if (r == num_rot) rot[num_rot++].chave = perf->nos[n].entrada;
+        rot[r].ciclos += perf->nos[n].ciclos;
+        rot[r].contagem += perf->nos[n].instrucoes;
+    }
+    qsort(rot, num_rot, sizeof(Linha), compara_linhas);
+
+    fprintf(f, "\nPor sub-rotina (tempo próprio):\n");
+    fprintf(f, "  %7s %14s %14s  %s\n", "%", MEPA_PERFIL_UNIDADE, "instruções", "sub-rotina");
+    for (int r = 0; r < num_rot; r++)
+        fprintf(f, "  %7.2f %14lld %14lld  %s\n", porcento(rot[r].ciclos, total), rot[r].ciclos,
+                rot[r].contagem, nome_rotina(p, rot[r].chave, buf, sizeof(buf)));
+
+    // Por linha do fonte (instruções sem linha conhecida ficam na linha 0)
+    int max_linha = 0;
+    for (int k = 0; k < p->tamanho; k++)
+        if (p->codigo[k].linha > max_linha) max_linha = p->codigo[k].linha;
+
+    Linha *lin = perf_calloc(max_linha + 1, sizeof(Linha));
+    int *rotina_linha = perf_calloc(max_linha + 1, sizeof(int));
+    for (int l = 0; l <= max_linha; l++) lin[l].chave = l;
+    for (int k = 0; k < p->tamanho; k++) {
+        int l = p->codigo[k].linha;
+        if (perf->execucoes[k] > 0 && lin[l].contagem == 0) rotina_linha[l] = perf->rotina[k];
+        lin[l].ciclos += perf->ciclos[k];
+        lin[l].contagem += perf->execucoes[k];
+    }
+    qsort(lin, max_linha + 1, sizeof(Linha), compara_linhas);
+
+    fprintf(f, "\nPor linha do fonte:\n");
+    fprintf(f, "  %7s %14s %14s  %6s  %s\n", "%", MEPA_PERFIL_UNIDADE, "instruções", "linha", "sub-rotina");
+    for (int l = 0; l <= max_linha && lin[l].contagem > 0; l++) {
+        if (lin[l].chave == 0)
+            fprintf(f, "  %7.2f %14lld %14lld  %6s  %s\n", porcento(lin[l].ciclos, total), lin[l].ciclos,
+                    lin[l].contagem, "?", "-");
+        else
+            fprintf(f, "  %7.2f %14lld %14lld  %6d  %s\n", porcento(lin[l].ciclos, total), lin[l].ciclos,
+                    lin[l].contagem, lin[l].chave, nome_rotina(p, rotina_linha[lin[l].chave], buf, sizeof(buf)));
+    }
+
+    // Instruções mais caras
+    Linha *ins = perf_calloc(p->tamanho, sizeof(Linha));
+    for (int k = 0; k < p->tamanho; k++) {
+        ins[k].chave = k;
+        ins[k].ciclos = perf->ciclos[k];
+        ins[k].contagem = perf->execucoes[k];
+    }
+    qsort(ins, p->tamanho, sizeof(Linha), compara_linhas);
+
+    fprintf(f, "\nInstruções mais caras:\n");
+    fprintf(f, "  %7s %14s %14s  %8s  %-6s %s\n", "%", MEPA_PERFIL_UNIDADE, "execuções", "endereço", "instr.", "linha");
+    for (int n = 0; n < NUM_INSTRUCOES_LISTADAS && n < p->tamanho && ins[n].contagem > 0; n++) {
+        const InstrMepa *i = &p->codigo[ins[n].chave];
+        fprintf(f, "  %7.2f %14lld %14lld  %8d  %-6s %d\n", porcento(ins[n].ciclos, total), ins[n].ciclos,
+                ins[n].contagem, ins[n].chave, mepa_vm_nome_op(i->op), i->linha);
+    }
+
+    free(rot);
+    free(lin);
+    free(rotina_linha);
+    free(ins);
+}
+
+void mepa_perfil_pilhas(FILE* f, const ProgramaMepa* p, const PerfilMepa* perf) {
+    int *caminho = perf_calloc(perf->num_nos, sizeof(int));
+    char buf[32];
+
+    for (int n = 0; n < perf->num_nos; n++) {
+        if (perf->nos[n].ciclos == 0) continue;
+
+        int prof = 0;
+        for (int m = n; m >= 0; m = perf->nos[m].pai) caminho[prof++] = m;
+
+        for (int d = prof - 1; d >= 0; d--)
+            fprintf(f, "%s%s", nome_rotina(p, perf->nos[caminho[d]].entrada, buf, sizeof(buf)), d > 0 ? ";" : "");
+        fprintf(f, " %lld\n", perf->nos[n].ciclos);
+    }
+
+    free(caminho);
+}
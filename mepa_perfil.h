@@ -0,0 +1,69 @@
+#ifndef MEPA_PERFIL_H
+#define MEPA_PERFIL_H
+
+#include <stdio.h>
+#include <time.h>
+#include "mepa_vm.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MEPA_PERFIL_UNIDADE "ciclos"
+#else
+#define MEPA_PERFIL_UNIDADE "ns"
+#endif
+
+// Perfil de uma execução: quantas vezes cada instrução executou e quanto
+// tempo (ciclos do TSC, ou ns de clock_gettime fora do x86) foi gasto nela
+// e em cada pilha de chamadas. O tempo é medido a cada instrução, então só
+// a proporção entre as partes é significativa: o próprio perfilador
+// acrescenta um custo quase fixo por instrução.
+//
+// As pilhas de chamadas formam uma árvore: cada nó é uma sequência
+// distinta de sub-rotinas ativas a partir do programa principal (nó 0).
+typedef struct {
+    int pai;                // -1 na raiz
+    int entrada;            // Endereço da sub-rotina (0 no programa principal)
+    int filho, irmao;       // Primeiro filho e próximo irmão (-1 se nenhum)
+    long long ciclos;       // Tempo próprio (sem o das sub-rotinas chamadas)
+    long long instrucoes;
+} NoChamadas;
+
+typedef struct {
+    long long* execucoes;   // Por instrução
+    long long* ciclos;      // Por instrução
+    int* rotina;            // Entrada da sub-rotina em que cada instrução executou
+    NoChamadas* nos;
+    int num_nos;
+    int cap_nos;
+} PerfilMepa;
+
+static inline unsigned long long mepa_perfil_relogio(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ull + t.tv_nsec;
+#endif
+}
+
+void mepa_perfil_inicia(PerfilMepa* perf, const ProgramaMepa* p);
+void mepa_perfil_libera(PerfilMepa* perf);
+
+// Nó filho de `no` para uma chamada a `entrada` (criado na primeira vez)
+int mepa_perfil_filho(PerfilMepa* perf, int no, int entrada);
+
+// Executa o programa (sem superinstruções) coletando o perfil; o laço
+// instrumentado fica em mepa_vm.c, junto das demais variantes, e os
+// laços normais não têm custo algum com o perfilador
+int mepa_perfila(const ProgramaMepa* p, FILE* entrada, FILE* saida,
+                 EstatisticasMepa* est, PerfilMepa* perf);
+
+// Perfil plano: por sub-rotina, por linha do fonte e por instrução
+void mepa_perfil_imprime(FILE* f, const ProgramaMepa* p, const PerfilMepa* perf);
+
+// Pilhas no formato "folded" (principal;fib;fib 1234), aceito por
+// flamegraph.pl e ferramentas compatíveis
+void mepa_perfil_pilhas(FILE* f, const ProgramaMepa* p, const PerfilMepa* perf);
+
+#endif
@@ -0,0 +1,366 @@
+#include "mepa_verificador.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+typedef struct {
+    int entrada;
+    int locais;         // l dos CHSR que a chamam
+    int profundidade;   // d dos CHSR (m do INPP no programa principal)
+    int num_params;     // n do RTSR (-1 enquanto nenhum foi encontrado)
+    int menor_desloc;   // Menor deslocamento negativo usado em CRLC/ARLC
+    int altura_max;
+} Rotina;
+
+typedef struct {
+    int instr;          // Índice do CHSR (ou do CTSR)
+    int altura;         // Altura de operandos de quem chama no momento (CTSR: a rotina)
+} Chamada;
+
+typedef struct {
+    const ProgramaMepa* p;
+    int num_globais;
+    int* dono;          // Rotina a que cada instrução pertence (-1: inalcançável)
+    int* altura;        // Altura de operandos antes de cada instrução (-1: não visitada)
+    int* rotina_de;     // Rotina cuja entrada é a instrução (-1 se nenhuma)
+    int* pilha;         // Pilha de trabalho dos percursos
+    Rotina* rotinas;
+    int num_rotinas;
+    Chamada* chamadas;
+    int num_chamadas;
+    Chamada* terminais;
+    int num_terminais;
+} Verificador;
+
+static void* ver_malloc(size_t n) {
+    void *ptr = malloc(n > 0 ? n : 1);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o verificador MEPA");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static int falha(const Verificador* v, int k, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "ERRO DE VERIFICAÇÃO na instrução %d (%s): ", k, mepa_nome_op(v->p->codigo[k].op));
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return 1;
+}
+
+// Valores retirados da pilha antes de a instrução empilhar o resultado
+static int consumo(const InstrMepa* i) {
+    switch (i->op) {
+        case MEPA_SOMA: case MEPA_SUBT: case MEPA_MULT: case MEPA_DIVI:
+        case MEPA_CONJ: case MEPA_DISJ:
+        case MEPA_CMME: case MEPA_CMMA: case MEPA_CMIG: case MEPA_CMDG:
+        case MEPA_CMEG: case MEPA_CMAG:
+            return 2;
+        case MEPA_INVR: case MEPA_NEGA:
+        case MEPA_ARGB: case MEPA_ARLC: case MEPA_DSVF: case MEPA_IMPR:
+            return 1;
+        case MEPA_DMEM:
+            return i->a;
+        default:
+            return 0;
+    }
+}
+
+// Sucessores de k no fluxo de controle dentro da mesma rotina (CHSR
+// continua em k + 1 quando a chamada retorna). Retorna -1 se a execução
+// passaria do fim do programa.
+static int sucessores(const ProgramaMepa* p, int k, int suc[2]) {
+    const InstrMepa *i = &p->codigo[k];
+    int n = 0;
+
+    switch (i->op) {
+        case MEPA_PARA:
+        case MEPA_RTSR:
+        case MEPA_CTSR:
+            return 0;
+        case MEPA_DSVS:
+            suc[0] = i->a;
+            return 1;
+        case MEPA_DSVF:
+            suc[n++] = i->a;
+            break;
+        default:
+            break;
+    }
+
+    if (k + 1 >= p->tamanho) return -1;
+    suc[n++] = k + 1;
+    return n;
+}
+
+// ======================================================================
+// FASE 1: ROTINAS E POSSE DAS INSTRUÇÕES
+// ======================================================================
+
+static int identifica_rotinas(Verificador* v) {
+    const ProgramaMepa *p = v->p;
+
+    if (p->codigo[0].op != MEPA_INPP)
+        return falha(v, 0, "o programa deve começar com INPP");
+
+    // Rotina 0 é o programa principal
+    v->rotinas[0] = (Rotina){ 0, 0, p->codigo[0].a, 0, 0, 0 };
+    v->rotina_de[0] = 0;
+    v->num_rotinas = 1;
+
+    for (int k = 0; k < p->tamanho; k++) {
+        const InstrMepa *i = &p->codigo[k];
+        if (i->op == MEPA_INPP && k != 0)
+            return falha(v, k, "INPP fora do início do programa");
+        if (i->op != MEPA_CHSR && i->op != MEPA_CTSR) continue;
+
+        if (i->b < 0 || i->c < 0)
+            return falha(v, k, "CHSR sem número de locais ou profundidade");
+
+        int r = v->rotina_de[i->a];
+        if (r < 0) {
+            r = v->num_rotinas++;
+            v->rotinas[r] = (Rotina){ i->a, i->b, i->c, -1, 0, 0 };
+            v->rotina_de[i->a] = r;
+        } else if (r == 0) {
+            return falha(v, k, "chamada ao início do programa principal");
+        } else if (v->rotinas[r].locais != i->b || v->rotinas[r].profundidade != i->c) {
+            return falha(v, k, "chamadas à instrução %d com locais/profundidade diferentes", i->a);
+        }
+    }
+
+    // Cada instrução alcançável pertence a uma única rotina
+    for (int r = 0; r < v->num_rotinas; r++) {
+        int topo = 0;
+        v->pilha[topo++] = v->rotinas[r].entrada;
+        v->dono[v->rotinas[r].entrada] = r;
+
+        while (topo > 0) {
+            int k = v->pilha[--topo];
+            const InstrMepa *i = &p->codigo[k];
+            int suc[2];
+
+            if (i->op == MEPA_RTSR) {
+                if (r == 0) return falha(v, k, "RTSR no programa principal");
+                if (i->a != v->rotinas[r].locais)
+                    return falha(v, k, "RTSR libera %d locais, mas a sub-rotina aloca %d", i->a, v->rotinas[r].locais);
+                if (i->b < 0) return falha(v, k, "número de parâmetros negativo");
+                if (v->rotinas[r].num_params >= 0 && v->rotinas[r].num_params != i->b)
+                    return falha(v, k, "RTSR com número de parâmetros diferente dos demais da sub-rotina");
+                v->rotinas[r].num_params = i->b;
+            }
+
+            int n = sucessores(p, k, suc);
+            if (n < 0) return falha(v, k, "a execução passaria do fim do programa");
+
+            for (int j = 0; j < n; j++) {
+                int d = suc[j];
+                if (v->dono[d] == r) continue;
+                if (v->dono[d] >= 0 || v->rotina_de[d] >= 0)
+                    return falha(v, k, "desvio para código de outra rotina (instrução %d)", d);
+                v->dono[d] = r;
+                v->pilha[topo++] = d;
+            }
+        }
+
+    }
+
+    // Nunca retorna: o n é o do RTSR que fica, inalcançável, no fim do
+    // código dela (0 se não houver). Qualquer n é seguro: quem chama tem de
+    // ter empilhado os n argumentos.
+    for (int r = 1; r < v->num_rotinas; r++) {
+        if (v->rotinas[r].num_params >= 0) continue;
+        v->rotinas[r].num_params = 0;
+        for (int k = v->rotinas[r].entrada + 1; k < p->tamanho && v->rotina_de[k] < 0; k++) {
+            if (v->dono[k] >= 0 && v->dono[k] != r) break;
+            if (p->codigo[k].op == MEPA_RTSR && v->dono[k] < 0) {
+                if (p->codigo[k].b > 0) v->rotinas[r].num_params = p->codigo[k].b;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// ======================================================================
+// FASE 2: ALTURA DA PILHA E ACESSOS À MEMÓRIA
+// ======================================================================
+
+static int verifica_instr(Verificador* v, int r, int k, int h, int* h_saida) {
+    const InstrMepa *i = &v->p->codigo[k];
+    Rotina *rot = &v->rotinas[r];
+
+    if (h < consumo(i))
+        return falha(v, k, "pilha de operandos com %d valor(es), a instrução retira %d", h, consumo(i));
+
+    switch (i->op) {
+        case MEPA_AMEM:
+        case MEPA_DMEM:
+            if (i->a < 0) return falha(v, k, "quantidade negativa");
+            break;
+
+        case MEPA_CRGB:
+        case MEPA_ARGB:
+            if (i->a < 0 || i->a >= v->num_globais)
+                return falha(v, k, "global %d fora das %d alocadas", i->a, v->num_globais);
+            break;
+
+        case MEPA_CRLC:
+        case MEPA_ARLC:
+            if (r == 0) return falha(v, k, "acesso local no programa principal");
+            if (i->a >= rot->locais || (i->a < 0 && i->a > -3) || i->a < -(rot->num_params + 3))
+                return falha(v, k, "deslocamento %d fora do registro de ativação", i->a);
+            if (i->a < rot->menor_desloc) rot->menor_desloc = i->a;
+            break;
+
+        case MEPA_RTSR:
+            if (h != 0) return falha(v, k, "retorno com %d operando(s) na pilha", h);
+            break;
+
+        case MEPA_CHSR: {
+            const Rotina *chamado = &v->rotinas[v->rotina_de[i->a]];
+            if (h < chamado->num_params)
+                return falha(v, k, "chamada com %d valor(es) na pilha para %d parâmetro(s)", h, chamado->num_params);
+            v->chamadas[v->num_chamadas++] = (Chamada){ k, h };
+            *h_saida = h - chamado->num_params;
+            return 0;
+        }
+
+        case MEPA_CTSR: {
+            // O chamado retorna a quem chamou esta rotina
+            const Rotina *chamado = &v->rotinas[v->rotina_de[i->a]];
+            if (r == 0) return falha(v, k, "chamada terminal no programa principal");
+            if (h != 0) return falha(v, k, "chamada terminal com %d operando(s) na pilha", h);
+            if (chamado->num_params != rot->num_params)
+                return falha(v, k, "chamada terminal de sub-rotina com %d parâmetro(s) para uma com %d",
+                             rot->num_params, chamado->num_params);
+            v->terminais[v->num_terminais++] = (Chamada){ k, r };
+            break;
+        }
+
+        case MEPA_MEMC:
+            // Num acerto retorna como o RTSR, com o valor no retorno
+            if (r == 0) return falha(v, k, "memoização no programa principal");
+            if (h != 0) return falha(v, k, "consulta à memoização com %d operando(s) na pilha", h);
+            if (i->a != rot->locais || i->b != rot->num_params)
+                return falha(v, k, "MEMC %d,%d numa sub-rotina com %d locais e %d parâmetro(s)",
+                             i->a, i->b, rot->locais, rot->num_params);
+            rot->menor_desloc = -(rot->num_params + 3);
+            break;
+
+        case MEPA_MEMG:
+            if (v->dono[i->a] != r || v->p->codigo[i->a].op != MEPA_MEMC)
+                return falha(v, k, "MEMG sem o MEMC da própria sub-rotina");
+            break;
+
+        case MEPA_CRVL: case MEPA_ARMZ: case MEPA_CHPR: case MEPA_ENPR: case MEPA_RTPR:
+            return falha(v, k, "instrução da forma genérica (display) não é verificável");
+
+        default:
+            if (i->op < 0 || i->op >= MEPA_NUM_OPS) return falha(v, k, "instrução inválida");
+            break;
+    }
+
+    *h_saida = h + mepa_efeito_pilha(i);
+    return 0;
+}
+
+static int verifica_alturas(Verificador* v) {
+    const ProgramaMepa *p = v->p;
+
+    for (int r = 0; r < v->num_rotinas; r++) {
+        int topo = 0;
+        v->pilha[topo++] = v->rotinas[r].entrada;
+        v->altura[v->rotinas[r].entrada] = 0;
+
+        while (topo > 0) {
+            int k = v->pilha[--topo];
+            int h = v->altura[k], h_saida, suc[2];
+
+            if (verifica_instr(v, r, k, h, &h_saida)) return 1;
+            if (h_saida > v->rotinas[r].altura_max) v->rotinas[r].altura_max = h_saida;
+
+            int n = sucessores(p, k, suc);
+            for (int j = 0; j < n; j++) {
+                int d = suc[j];
+                if (v->altura[d] < 0) {
+                    v->altura[d] = h_saida;
+                    v->pilha[topo++] = d;
+                } else if (v->altura[d] != h_saida) {
+                    return falha(v, d, "altura da pilha inconsistente (%d e %d)", v->altura[d], h_saida);
+                }
+            }
+        }
+
+        Rotina *rot = &v->rotinas[r];
+        if (rot->altura_max > rot->profundidade)
+            return falha(v, rot->entrada, "profundidade anotada %d, mas a pilha chega a %d",
+                         rot->profundidade, rot->altura_max);
+    }
+
+    // Uma rotina que termina chamando uma função devolve o retorno dela
+    // (mesmo n, mesma posição): para quem a chama, também é uma função
+    for (int mudou = 1; mudou; ) {
+        mudou = 0;
+        for (int t = 0; t < v->num_terminais; t++) {
+            Rotina *rot = &v->rotinas[v->terminais[t].altura];
+            const Rotina *chamado = &v->rotinas[v->rotina_de[p->codigo[v->terminais[t].instr].a]];
+            int retorno = -(rot->num_params + 3);
+            if (chamado->menor_desloc == retorno && rot->menor_desloc > retorno) {
+                rot->menor_desloc = retorno;
+                mudou = 1;
+            }
+        }
+    }
+
+    // Quem chama uma função deve ter reservado o espaço do retorno
+    for (int c = 0; c < v->num_chamadas; c++) {
+        const Rotina *chamado = &v->rotinas[v->rotina_de[p->codigo[v->chamadas[c].instr].a]];
+        int funcao = chamado->menor_desloc == -(chamado->num_params + 3);
+        if (v->chamadas[c].altura < chamado->num_params + funcao)
+            return falha(v, v->chamadas[c].instr, "chamada de função sem espaço para o retorno");
+    }
+
+    return 0;
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+int mepa_verifica(const ProgramaMepa* p) {
+    if (p->tamanho == 0) {
+        fprintf(stderr, "ERRO DE VERIFICAÇÃO: programa vazio\n");
+        return 1;
+    }
+
+    Verificador v = { 0 };
+    int n = p->tamanho;
+    v.p = p;
+    v.dono = ver_malloc(n * sizeof(int));
+    v.altura = ver_malloc(n * sizeof(int));
+    v.rotina_de = ver_malloc(n * sizeof(int));
+    v.pilha = ver_malloc(n * sizeof(int));
+    v.rotinas = ver_malloc(n * sizeof(Rotina));
+    v.chamadas = ver_malloc(n * sizeof(Chamada));
+    v.terminais = ver_malloc(n * sizeof(Chamada));
+
+    for (int k = 0; k < n; k++) v.dono[k] = v.altura[k] = v.rotina_de[k] = -1;
+
+    v.num_globais = (n > 1 && p->codigo[1].op == MEPA_AMEM) ? p->codigo[1].a : 0;
+
+    int resultado = identifica_rotinas(&v) || verifica_alturas(&v);
+
+    free(v.dono);
+    free(v.altura);
+    free(v.rotina_de);
+    free(v.pilha);
+    free(v.rotinas);
+    free(v.chamadas);
+    free(v.terminais);
+    return resultado;
+}
@@ -0,0 +1,34 @@
+#ifndef MEPA_VERIFICADOR_H
+#define MEPA_VERIFICADOR_H
+
+#include "mepa_vm.h"
+
+// Verificação de um programa MEPA anotado (INPP m,t e CHSR p,l,d) feita
+// uma única vez na carga. Se aprovado, o laço de interpretação pode
+// dispensar todas as verificações por instrução, pois fica garantido que:
+//   - todo desvio cai dentro do programa e a execução nunca passa do fim;
+//   - cada sub-rotina (alvo de CHSR ou CTSR) só é alcançada pela própria
+//     entrada;
+//   - a altura da pilha de operandos é a mesma por todos os caminhos que
+//     chegam a uma instrução, nunca fica negativa e não passa de d
+//     (ou de m no programa principal);
+//   - CRGB/ARGB acessam globais alocadas pelo AMEM inicial e CRLC/ARLC
+//     acessam locais (0..l-1), parâmetros ou o retorno da própria sub-rotina;
+//   - todo CHSR de uma mesma sub-rotina usa o mesmo l e d, coincidindo com
+//     o RTSR l,n, e quem chama empilhou os n argumentos (mais o espaço de
+//     retorno se a sub-rotina for uma função);
+//   - uma chamada terminal (CTSR) é feita com a pilha de operandos vazia,
+//     de uma sub-rotina para outra com o mesmo n, e quem chama a primeira
+//     reservou o retorno se a segunda for uma função;
+//   - MEMC l,n, que pode retornar como o RTSR, tem a pilha de operandos
+//     vazia e os l e n da sub-rotina, que passa a ser uma função, e todo
+//     MEMG se refere ao MEMC da própria sub-rotina.
+// O n de uma sub-rotina que nunca retorna é o do RTSR inalcançável que o
+// compilador deixa no fim dela.
+// Só a forma de dois níveis é verificável: programas com CRVL/ARMZ/CHPR/
+// ENPR/RTPR continuam no laço com verificações.
+//
+// Retorna 0 se o programa foi aprovado; caso contrário imprime o motivo.
+int mepa_verifica(const ProgramaMepa* p);
+
+#endif
@@ -0,0 +1,251 @@
+#include "mepa_vm.h"
+#include "mepa_verificador.h"
+#include "mepa_perfil.h"
+#include "mepa_es.h"
+#include "mepa_memo.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ======================================================================
+// SUPERINSTRUÇÕES
+// ======================================================================
+
+static const struct {
+    const char* nome;
+    int tamanho;
+    OpMepa ops[3];
+} superinstrucoes[MEPA_NUM_OPS_VM - MEPA_NUM_OPS] = {
+    [MEPA_CRLC_CRCT_SOMA - MEPA_NUM_OPS] = { "CRLC+CRCT+SOMA", 3, { MEPA_CRLC, MEPA_CRCT, MEPA_SOMA } },
+    [MEPA_CRLC_CRCT_SUBT - MEPA_NUM_OPS] = { "CRLC+CRCT+SUBT", 3, { MEPA_CRLC, MEPA_CRCT, MEPA_SUBT } },
+    [MEPA_CRGB_CRCT_SOMA - MEPA_NUM_OPS] = { "CRGB+CRCT+SOMA", 3, { MEPA_CRGB, MEPA_CRCT, MEPA_SOMA } },
+    [MEPA_CRLC_CRLC_MULT - MEPA_NUM_OPS] = { "CRLC+CRLC+MULT", 3, { MEPA_CRLC, MEPA_CRLC, MEPA_MULT } },
+    [MEPA_CRLC_CRCT - MEPA_NUM_OPS]      = { "CRLC+CRCT", 2, { MEPA_CRLC, MEPA_CRCT } },
+    [MEPA_CRGB_CRCT - MEPA_NUM_OPS]      = { "CRGB+CRCT", 2, { MEPA_CRGB, MEPA_CRCT } },
+    [MEPA_CMME_DSVF - MEPA_NUM_OPS]      = { "CMME+DSVF", 2, { MEPA_CMME, MEPA_DSVF } },
+    [MEPA_CMMA_DSVF - MEPA_NUM_OPS]      = { "CMMA+DSVF", 2, { MEPA_CMMA, MEPA_DSVF } },
+    [MEPA_CMIG_DSVF - MEPA_NUM_OPS]      = { "CMIG+DSVF", 2, { MEPA_CMIG, MEPA_DSVF } },
+    [MEPA_CMDG_DSVF - MEPA_NUM_OPS]      = { "CMDG+DSVF", 2, { MEPA_CMDG, MEPA_DSVF } },
+    [MEPA_CMEG_DSVF - MEPA_NUM_OPS]      = { "CMEG+DSVF", 2, { MEPA_CMEG, MEPA_DSVF } },
+    [MEPA_CMAG_DSVF - MEPA_NUM_OPS]      = { "CMAG+DSVF", 2, { MEPA_CMAG, MEPA_DSVF } },
+};
+
+const char* mepa_vm_nome_op(int op) {
+    if (op >= MEPA_NUM_OPS && op < MEPA_NUM_OPS_VM)
+        return superinstrucoes[op - MEPA_NUM_OPS].nome;
+    return mepa_nome_op((OpMepa)op);
+}
+
+// Troca a primeira instrução de cada sequência pela superinstrução
+// correspondente (a mais longa, pela ordem da tabela). A varredura segue
+// para a instrução seguinte, e não para o fim da sequência, para que as
+// instruções no meio dela também sejam fundidas quando forem alvo de desvio.
+static void funde_superinstrucoes(ProgramaMepa* p) {
+    for (int k = 0; k < p->tamanho; k++) {
+        for (int f = 0; f < MEPA_NUM_OPS_VM - MEPA_NUM_OPS; f++) {
+            int t = superinstrucoes[f].tamanho, casa = k + t <= p->tamanho;
+            for (int j = 0; j < t && casa; j++)
+                casa = p->codigo[k + j].op == superinstrucoes[f].ops[j];
+            if (!casa) continue;
+
+            InstrMepa fundida = { (OpMepa)(MEPA_NUM_OPS + f), -1, -1, -1,
+                                  p->codigo[k].rotulo, p->codigo[k].linha };
+            int *operandos[3] = { &fundida.a, &fundida.b, &fundida.c }, n = 0;
+            for (int j = 0; j < t; j++)
+                if (mepa_num_operandos(p->codigo[k + j].op) > 0)
+                    *operandos[n++] = p->codigo[k + j].a;
+            p->codigo[k] = fundida;
+            break;
+        }
+    }
+}
+
+// ======================================================================
+// CARGA
+// ======================================================================
+
+int mepa_carrega(const CodigoMepa* c, ProgramaMepa* p, int opcoes) {
+    int *endereco = malloc((c->num_rotulos > 0 ? c->num_rotulos : 1) * sizeof(int));
+    if (endereco == NULL) {
+        perror("Erro ao alocar memória para a carga do programa MEPA");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < c->num_rotulos; r++) endereco[r] = -1;
+
+    for (int k = 0; k < c->num_instrs; k++) {
+        int r = c->instrs[k].rotulo;
+        if (r < 0) continue;
+        if (endereco[r] >= 0) {
+            fprintf(stderr, "ERRO MEPA: rótulo R%02d definido mais de uma vez\n", r);
+            free(endereco);
+            return 1;
+        }
+        endereco[r] = k;
+    }
+
+    p->tamanho = c->num_instrs;
+    p->nomes = NULL;
+    p->codigo = malloc((c->num_instrs > 0 ? c->num_instrs : 1) * sizeof(InstrMepa));
+    if (p->codigo == NULL) {
+        perror("Erro ao alocar memória para a carga do programa MEPA");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(p->codigo, c->instrs, c->num_instrs * sizeof(InstrMepa));
+
+    for (int k = 0; k < p->tamanho; k++) {
+        InstrMepa *i = &p->codigo[k];
+        if (!mepa_op_usa_rotulo(i->op)) continue;
+        if (i->a < 0 || i->a >= c->num_rotulos || endereco[i->a] < 0) {
+            fprintf(stderr, "ERRO MEPA: rótulo R%02d não definido\n", i->a);
+            free(endereco);
+            mepa_descarrega(p);
+            return 1;
+        }
+        i->a = endereco[i->a];
+    }
+
+    // Tabelas de memoização: uma por MEMC, na ordem do código
+    p->num_memos = 0;
+    for (int k = 0; k < p->tamanho; k++)
+        if (p->codigo[k].op == MEPA_MEMC) p->codigo[k].c = p->num_memos++;
+    for (int k = 0; k < p->tamanho; k++) {
+        const InstrMepa *i = &p->codigo[k];
+        if (i->op == MEPA_MEMG && p->codigo[i->a].op != MEPA_MEMC) {
+            fprintf(stderr, "ERRO MEPA: MEMG na instrução %d não se refere a um MEMC\n", k);
+            free(endereco);
+            mepa_descarrega(p);
+            return 1;
+        }
+    }
+
+    // Nomes das sub-rotinas, pelo endereço da entrada (para o perfilador)
+    for (int r = 0; r < c->num_rotulos; r++) {
+        if (mepa_nome_rotulo(c, r) == NULL || endereco[r] < 0) continue;
+        if (p->nomes == NULL) p->nomes = calloc(p->tamanho, sizeof(char*));
+        if (p->nomes == NULL) {
+            perror("Erro ao alocar memória para a carga do programa MEPA");
+            exit(EXIT_FAILURE);
+        }
+        free(p->nomes[endereco[r]]);
+        p->nomes[endereco[r]] = strdup(mepa_nome_rotulo(c, r));
+    }
+
+    free(endereco);
+
+    // Anotações de profundidade (só valem se nenhuma instrução empilha
+    // registros de ativação fora do controle do compilador)
+    p->anotado = p->tamanho > 0 && p->codigo[0].op == MEPA_INPP && p->codigo[0].a >= 0;
+    for (int k = 0; k < p->tamanho && p->anotado; k++) {
+        const InstrMepa *i = &p->codigo[k];
+        if (i->op == MEPA_CHPR || i->op == MEPA_ENPR || ((i->op == MEPA_CHSR || i->op == MEPA_CTSR) && i->c < 0))
+            p->anotado = 0;
+    }
+
+    p->memoria = MEPA_TAM_MEMORIA;
+    if (p->anotado) {
+        if (p->codigo[0].b > 0) p->memoria = p->codigo[0].b;
+        if (p->codigo[0].a > p->memoria) {
+            fprintf(stderr, "ERRO MEPA: o programa requer %d posições de memória\n", p->codigo[0].a);
+            mepa_descarrega(p);
+            return 1;
+        }
+    }
+
+    // Programas anotados têm de passar pelo verificador: o laço rápido
+    // confia nas profundidades e não confere mais nada a cada instrução
+    p->verificado = 0;
+    if (p->anotado) {
+        if (mepa_verifica(p)) {
+            mepa_descarrega(p);
+            return 1;
+        }
+        p->verificado = 1;
+    }
+
+    if (!(opcoes & MEPA_SEM_FUSAO)) funde_superinstrucoes(p);
+
+    return 0;
+}
+
+void mepa_descarrega(ProgramaMepa* p) {
+    if (p->nomes != NULL)
+        for (int k = 0; k < p->tamanho; k++) free(p->nomes[k]);
+    free(p->nomes);
+    p->nomes = NULL;
+    free(p->codigo);
+    p->codigo = NULL;
+    p->tamanho = 0;
+}
+
+// ======================================================================
+// EXECUÇÃO
+// ======================================================================
+
+// O laço é instanciado em variantes: protegido, com verificação de pilha,
+// endereços e desvios a cada instrução; para programas aprovados pelo
+// verificador na carga, sem elas (o estouro só é conferido nas chamadas);
+// e protegido com instrumentação, contando os pares de instruções para
+// mepa_perfil_pares ou medindo o tempo para mepa_perfila.
+
+// Soma, subtração e multiplicação em complemento de 2, em unsigned: o
+// estouro dá a volta, como no compilador (dobra_constantes), em vez de ser
+// comportamento indefinido
+#define ARIT(x, op, y) ((int)((unsigned)(x) op (unsigned)(y)))
+
+#define LACO_FUNCAO executa_protegido
+#define LACO_VERIFICADO 0
+#define LACO_PARES 0
+#define LACO_PERFIL 0
+#include "mepa_vm_laco.h"
+#undef LACO_FUNCAO
+#undef LACO_VERIFICADO
+#undef LACO_PARES
+#undef LACO_PERFIL
+
+#define LACO_FUNCAO executa_verificado
+#define LACO_VERIFICADO 1
+#define LACO_PARES 0
+#define LACO_PERFIL 0
+#include "mepa_vm_laco.h"
+#undef LACO_FUNCAO
+#undef LACO_VERIFICADO
+#undef LACO_PARES
+#undef LACO_PERFIL
+
+#define LACO_FUNCAO executa_pares
+#define LACO_VERIFICADO 0
+#define LACO_PARES 1
+#define LACO_PERFIL 0
+#include "mepa_vm_laco.h"
+#undef LACO_FUNCAO
+#undef LACO_VERIFICADO
+#undef LACO_PARES
+#undef LACO_PERFIL
+
+#define LACO_FUNCAO executa_perfil
+#define LACO_VERIFICADO 0
+#define LACO_PARES 0
+#define LACO_PERFIL 1
+#include "mepa_vm_laco.h"
+#undef LACO_FUNCAO
+#undef LACO_VERIFICADO
+#undef LACO_PARES
+#undef LACO_PERFIL
+
+int mepa_executa(const ProgramaMepa* p, FILE* entrada, FILE* saida, EstatisticasMepa* est) {
+    if (p->verificado)
+        return executa_verificado(p, entrada, saida, est, NULL, NULL);
+    return executa_protegido(p, entrada, saida, est, NULL, NULL);
+}
+
+int mepa_perfil_pares(const ProgramaMepa* p, FILE* entrada, FILE* saida,
+                      long long pares[MEPA_NUM_OPS][MEPA_NUM_OPS]) {
+    memset(pares, 0, MEPA_NUM_OPS * sizeof(pares[0]));
+    return executa_pares(p, entrada, saida, NULL, pares, NULL);
+}
+
+int mepa_perfila(const ProgramaMepa* p, FILE* entrada, FILE* saida,
+                 EstatisticasMepa* est, PerfilMepa* perf) {
+    return executa_perfil(p, entrada, saida, est, NULL, perf);
+}
@@ -0,0 +1,92 @@
+#ifndef MEPA_VM_H
+#define MEPA_VM_H
+
+#include <stdio.h>
+#include "mepa.h"
+
+#define MEPA_TAM_MEMORIA (1 << 20) // Posições da memória de dados (pilha)
+#define MEPA_MAX_NIVEIS  16        // Entradas do display (CRVL/ARMZ/ENPR/RTPR)
+
+// Programa pronto para execução: os operandos de DSVS/DSVF/CHPR já são
+// endereços de instrução (e não mais números de rótulo). Cada MEMC recebe
+// no operando c o número da sua tabela de memoização (mepa_memo.h), e o
+// operando de cada MEMG é o endereço de um MEMC.
+//
+// Programas gerados pelo compilador no modo de dois níveis são anotados
+// com as profundidades de pilha calculadas estaticamente:
+//   INPP m,t   m = posições usadas pelo programa principal (globais e
+//              operandos); t = total exato da execução, ou 0 quando há
+//              recursão e o total não é limitado
+//   CHSR p,l,d d = profundidade máxima de operandos da sub-rotina p
+//   CTSR p,l,d idem, na chamada terminal (que reaproveita o registro)
+// Nesse caso a memória é pré-alocada com exatamente t posições (quando
+// t > 0). Programas anotados passam pelo verificador (mepa_verificador.h)
+// na carga e, se aprovados, rodam num laço sem verificações por instrução,
+// em que o estouro da pilha só é conferido a cada chamada.
+//
+// Na carga, sequências frequentes são fundidas em superinstruções (ver
+// OpFundida): a primeira instrução da sequência é trocada pela
+// superinstrução, que executa a sequência inteira e salta as demais. As
+// outras instruções ficam no lugar, então desvios para o meio da
+// sequência continuam válidos.
+typedef struct {
+    InstrMepa* codigo;
+    int tamanho;
+    int anotado;
+    int verificado;         // Aprovado por mepa_verifica (laço sem verificações)
+    int memoria;            // Posições da memória de dados a alocar
+    char** nomes;           // Nome da sub-rotina que começa em cada endereço (ou NULL)
+    int num_memos;          // Tabelas de memoização (instruções MEMC)
+} ProgramaMepa;
+
+// Superinstruções, escolhidas pelo perfil de pares (mepa --perfil-pares)
+// do código gerado para os testes. Só existem no programa carregado,
+// nunca no formato textual; os operandos são os das instruções fundidas,
+// na ordem (a, b, c).
+typedef enum {
+    MEPA_CRLC_CRCT_SOMA = MEPA_NUM_OPS,  // Local + constante
+    MEPA_CRLC_CRCT_SUBT,                 // Local - constante
+    MEPA_CRGB_CRCT_SOMA,                 // Global + constante
+    MEPA_CRLC_CRLC_MULT,                 // Local * local
+    MEPA_CRLC_CRCT,                      // Local e constante (antes de comparar, dividir...)
+    MEPA_CRGB_CRCT,
+    MEPA_CMME_DSVF,                      // Compara e desvia se falso
+    MEPA_CMMA_DSVF,
+    MEPA_CMIG_DSVF,
+    MEPA_CMDG_DSVF,
+    MEPA_CMEG_DSVF,
+    MEPA_CMAG_DSVF,
+    MEPA_NUM_OPS_VM
+} OpFundida;
+
+// Nome de uma instrução, incluindo as superinstruções ("CMME+DSVF")
+const char* mepa_vm_nome_op(int op);
+
+typedef struct {
+    long long instrucoes;   // Instruções executadas
+    int pilha_max;          // Maior posição ocupada (-1 se não medida)
+    int memoria;            // Posições alocadas para a memória de dados
+    long long memo_acertos; // Consultas de MEMC respondidas pela tabela
+    long long memo_faltas;
+    long long memo_remocoes; // Entradas descartadas com o conjunto cheio
+} EstatisticasMepa;
+
+// Opções de mepa_carrega
+#define MEPA_SEM_FUSAO 1   // Não funde superinstruções (para comparação)
+
+// Resolve os rótulos de `c`, verifica programas anotados e funde as
+// superinstruções; retorna 0 em caso de sucesso
+int mepa_carrega(const CodigoMepa* c, ProgramaMepa* p, int opcoes);
+void mepa_descarrega(ProgramaMepa* p);
+
+// Executa até PARA; retorna 0 em caso de sucesso e 1 em erro de execução.
+// `est` pode ser NULL.
+int mepa_executa(const ProgramaMepa* p, FILE* entrada, FILE* saida, EstatisticasMepa* est);
+
+// Executa o programa (sem superinstruções) contando em pares[a][b] quantas
+// vezes a instrução b executou logo após a; é o perfil usado para escolher
+// as superinstruções
+int mepa_perfil_pares(const ProgramaMepa* p, FILE* entrada, FILE* saida,
+                      long long pares[MEPA_NUM_OPS][MEPA_NUM_OPS]);
+
+#endif
@@ -0,0 +1,410 @@
+// Laço de interpretação da MEPA, incluído por mepa_vm.c uma vez para cada
+// variante. Antes de incluir, defina:
+//   LACO_FUNCAO   nome da função gerada
+//   LACO_PARES    1 para contar a frequência de cada par de instruções
+//                 consecutivas em `pares` (perfil para escolher as
+//                 superinstruções)
+//   LACO_PERFIL   1 para medir o tempo de cada instrução e manter a pilha
+//                 de chamadas em `perfil` (mepa_perfil.h)
+//   LACO_VERIFICADO 1 se o programa foi aprovado por mepa_verifica: desvios,
+//                 alturas de pilha e endereços já foram conferidos na carga,
+//                 e o estouro só é verificado na chamada (CHSR ou CTSR
+//                 p,l,d) e não a cada empilhamento
+
+#define FALHA(msg) do { msg_erro = (msg); goto erro; } while (0)
+
+// Superinstruções: `n` é o número de instruções originais saltadas
+#define SALTA(n) do { i += (n); contador += (n); } while (0)
+#define COMPARA_DESVIA(cmp) do { \
+        VERIFICA_POP(2); \
+        s -= 2; \
+        contador++; \
+        if (M[s + 1] cmp M[s + 2]) i++; else i = ins->a; \
+    } while (0)
+
+#if LACO_VERIFICADO
+#define EMPILHA(v) do { M[++s] = (v); } while (0)
+#define ATUALIZA_MAX() do { } while (0)
+#define VERIFICA_POP(n) do { } while (0)
+#define VERIFICA_END(e) do { } while (0)
+#define VERIFICA_NIVEL(k) do { } while (0)
+#else
+#define EMPILHA(v) do { \
+        if (s + 1 >= tam) FALHA("estouro da pilha"); \
+        M[++s] = (v); \
+        if (s > pilha_max) pilha_max = s; \
+    } while (0)
+#define ATUALIZA_MAX() do { if (s > pilha_max) pilha_max = s; } while (0)
+#define VERIFICA_POP(n) do { if (s - (n) < -1) FALHA("pilha vazia"); } while (0)
+#define VERIFICA_END(e) do { if ((e) < 0 || (e) > s) FALHA("acesso fora da memória alocada"); } while (0)
+#define VERIFICA_NIVEL(k) do { if ((k) < 0 || (k) >= MEPA_MAX_NIVEIS) FALHA("nível léxico inválido"); } while (0)
+#endif
+
+static int LACO_FUNCAO(const ProgramaMepa* p, FILE* entrada, FILE* saida, EstatisticasMepa* est,
+                       long long (*pares)[MEPA_NUM_OPS], PerfilMepa* perfil) {
+    const int tam = p->memoria;
+    int *M = malloc(tam * sizeof(int));
+    int D[MEPA_MAX_NIVEIS] = { 0 };
+    int i = 0, s = -1, pilha_max = -1, end, v;
+    long long contador = 0;
+#if LACO_PARES
+    int anterior = MEPA_INPP;
+#endif
+#if LACO_PERFIL
+    // O tempo entre duas leituras do relógio é da instrução anterior,
+    // no nó de chamadas em que ela executou
+    int no = 0, k_anterior = -1, no_anterior = 0;
+    unsigned long long relogio = mepa_perfil_relogio();
+#endif
+    const char *msg_erro = NULL;
+    int resultado = 0;
+    SaidaMepa sai;
+    EntradaMepa ent;
+    MemoMepa memo;
+
+    if (M == NULL) {
+        perror("Erro ao alocar a memória da MEPA");
+        exit(EXIT_FAILURE);
+    }
+    mepa_saida_inicia(&sai, saida);
+    mepa_entrada_inicia(&ent, entrada, &sai);
+    mepa_memo_inicia(&memo, p->num_memos);
+
+    for (;;) {
+#if !LACO_VERIFICADO
+        if (i < 0 || i >= p->tamanho) FALHA("execução fora do programa");
+#endif
+
+        const InstrMepa *ins = &p->codigo[i++];
+        contador++;
+#if LACO_PARES
+        if (contador > 1) pares[anterior][ins->op]++;
+        anterior = ins->op;
+#endif
+#if LACO_PERFIL
+        {
+            unsigned long long t = mepa_perfil_relogio();
+            if (k_anterior >= 0) {
+                perfil->ciclos[k_anterior] += t - relogio;
+                perfil->nos[no_anterior].ciclos += t - relogio;
+            }
+            relogio = t;
+            k_anterior = i - 1;
+            no_anterior = no;
+            perfil->execucoes[i - 1]++;
+            perfil->rotina[i - 1] = perfil->nos[no].entrada;
+            perfil->nos[no].instrucoes++;
+        }
+#endif
+
+        switch ((int)ins->op) {
+            case MEPA_INPP:
+                s = -1;
+                D[0] = 0;
+                break;
+
+            case MEPA_PARA:
+                goto fim;
+
+            case MEPA_AMEM:
+#if !LACO_VERIFICADO
+                if (ins->a < 0) FALHA("AMEM com quantidade negativa");
+                if (s + ins->a >= tam) FALHA("estouro da pilha");
+#endif
+                s += ins->a;
+                ATUALIZA_MAX();
+                break;
+
+            case MEPA_DMEM:
+                VERIFICA_POP(ins->a);
+                s -= ins->a;
+                break;
+
+            case MEPA_CRCT:
+                EMPILHA(ins->a);
+                break;
+
+            case MEPA_CRVL:
+                VERIFICA_NIVEL(ins->a);
+                end = D[ins->a] + ins->b;
+                VERIFICA_END(end);
+                EMPILHA(M[end]);
+                break;
+
+            case MEPA_ARMZ:
+                VERIFICA_NIVEL(ins->a);
+                VERIFICA_POP(1);
+                end = D[ins->a] + ins->b;
+                VERIFICA_END(end);
+                M[end] = M[s--];
+                break;
+
+            case MEPA_CRGB:
+                VERIFICA_END(ins->a);
+                EMPILHA(M[ins->a]);
+                break;
+
+            case MEPA_ARGB:
+                VERIFICA_POP(1);
+                VERIFICA_END(ins->a);
+                M[ins->a] = M[s--];
+                break;
+
+            case MEPA_CRLC:
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                EMPILHA(M[end]);
+                break;
+
+            case MEPA_ARLC:
+                VERIFICA_POP(1);
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                M[end] = M[s--];
+                break;
+
+            case MEPA_SOMA: VERIFICA_POP(2); M[s - 1] = ARIT(M[s - 1], +, M[s]); s--; break;
+            case MEPA_SUBT: VERIFICA_POP(2); M[s - 1] = ARIT(M[s - 1], -, M[s]); s--; break;
+            case MEPA_MULT: VERIFICA_POP(2); M[s - 1] = ARIT(M[s - 1], *, M[s]); s--; break;
+
+            case MEPA_DIVI:
+                VERIFICA_POP(2);
+                if (M[s] == 0) FALHA("divisão por zero");
+                if (M[s - 1] == INT_MIN && M[s] == -1) FALHA("estouro na divisão");
+                M[s - 1] = M[s - 1] / M[s];
+                s--;
+                break;
+
+            case MEPA_INVR: VERIFICA_POP(1); M[s] = ARIT(0, -, M[s]); break;
+            case MEPA_NEGA: VERIFICA_POP(1); M[s] = 1 - M[s]; break;
+            case MEPA_CONJ: VERIFICA_POP(2); M[s - 1] = M[s - 1] && M[s]; s--; break;
+            case MEPA_DISJ: VERIFICA_POP(2); M[s - 1] = M[s - 1] || M[s]; s--; break;
+
+            case MEPA_CMME: VERIFICA_POP(2); M[s - 1] = M[s - 1] <  M[s]; s--; break;
+            case MEPA_CMMA: VERIFICA_POP(2); M[s - 1] = M[s - 1] >  M[s]; s--; break;
+            case MEPA_CMIG: VERIFICA_POP(2); M[s - 1] = M[s - 1] == M[s]; s--; break;
+            case MEPA_CMDG: VERIFICA_POP(2); M[s - 1] = M[s - 1] != M[s]; s--; break;
+            case MEPA_CMEG: VERIFICA_POP(2); M[s - 1] = M[s - 1] <= M[s]; s--; break;
+            case MEPA_CMAG: VERIFICA_POP(2); M[s - 1] = M[s - 1] >= M[s]; s--; break;
+
+            case MEPA_DSVS:
+                i = ins->a;
+                break;
+
+            case MEPA_DSVF:
+                VERIFICA_POP(1);
+                if (M[s--] == 0) i = ins->a;
+                break;
+
+            case MEPA_NADA:
+                break;
+
+            case MEPA_LEIT:
+                if (mepa_le_inteiro(&ent, &v)) FALHA("leitura de inteiro falhou");
+                EMPILHA(v);
+                break;
+
+            case MEPA_IMPR:
+                VERIFICA_POP(1);
+                mepa_escreve_inteiro(&sai, M[s--]);
+                break;
+
+            case MEPA_CHPR:
+                EMPILHA(i);
+                i = ins->a;
+#if LACO_PERFIL
+                no = mepa_perfil_filho(perfil, no, ins->a);
+#endif
+                break;
+
+            case MEPA_ENPR:
+                VERIFICA_NIVEL(ins->a);
+                EMPILHA(D[ins->a]);
+                D[ins->a] = s + 1;
+                break;
+
+            case MEPA_RTPR:
+                VERIFICA_NIVEL(ins->a);
+                VERIFICA_POP(ins->b + 2);
+                D[ins->a] = M[s];
+                i = M[s - 1];
+                s -= ins->b + 2;
+#if LACO_PERFIL
+                if (perfil->nos[no].pai >= 0) no = perfil->nos[no].pai;
+#endif
+                break;
+
+            case MEPA_CHSR:
+#if LACO_VERIFICADO
+                // Única verificação de estouro: o registro inteiro (ligação,
+                // locais e a pilha de operandos calculada pelo compilador)
+                if (s + 2 + ins->b + ins->c >= tam) FALHA("estouro da pilha");
+#else
+                if (ins->b < 0 || s + 2 + ins->b >= tam) FALHA("estouro da pilha");
+#endif
+                M[s + 1] = i;
+                M[s + 2] = D[1];
+                s += 2;
+                D[1] = s + 1;
+                s += ins->b;
+                ATUALIZA_MAX();
+                i = ins->a;
+#if LACO_PERFIL
+                no = mepa_perfil_filho(perfil, no, ins->a);
+#endif
+                break;
+
+            case MEPA_CTSR:
+                // Chamada terminal: a ligação e os parâmetros (já com os
+                // argumentos) ficam, e as locais passam a ser as do chamado
+#if LACO_VERIFICADO
+                if (D[1] - 1 + ins->b + ins->c >= tam) FALHA("estouro da pilha");
+#else
+                if (ins->b < 0 || D[1] - 1 + ins->b >= tam) FALHA("estouro da pilha");
+#endif
+                s = D[1] - 1 + ins->b;
+                ATUALIZA_MAX();
+                i = ins->a;
+#if LACO_PERFIL
+                if (perfil->nos[no].pai >= 0) no = perfil->nos[no].pai;
+                no = mepa_perfil_filho(perfil, no, ins->a);
+#endif
+                break;
+
+            case MEPA_RTSR:
+                VERIFICA_POP(ins->a + ins->b + 2);
+                s -= ins->a;
+                D[1] = M[s];
+                i = M[s - 1];
+                s -= ins->b + 2;
+#if LACO_PERFIL
+                if (perfil->nos[no].pai >= 0) no = perfil->nos[no].pai;
+#endif
+                break;
+
+            case MEPA_MEMC:
+                // Os n argumentos estão logo abaixo da ligação e o retorno
+                // abaixo deles; num acerto, sai como RTSR l,n
+#if !LACO_VERIFICADO
+                if (ins->b < 0 || D[1] - ins->b - 3 < 0 || D[1] - 3 > s) FALHA("MEMC fora de um registro de ativação");
+#endif
+                if (!mepa_memo_consulta(&memo, ins->c, &M[D[1] - ins->b - 2], ins->b, &v)) {
+                    mepa_memo_empilha(&memo, D[1], &M[D[1] - ins->b - 2], ins->b);
+                    break;
+                }
+                M[D[1] - ins->b - 3] = v;
+                VERIFICA_POP(ins->a + ins->b + 2);
+                s -= ins->a;
+                D[1] = M[s];
+                i = M[s - 1];
+                s -= ins->b + 2;
+#if LACO_PERFIL
+                if (perfil->nos[no].pai >= 0) no = perfil->nos[no].pai;
+#endif
+                break;
+
+            case MEPA_MEMG: {
+                // Com os argumentos da entrada, guardados pelo MEMC
+                const InstrMepa *memc = &p->codigo[ins->a];
+#if !LACO_VERIFICADO
+                if (D[1] - memc->b - 3 < 0 || D[1] - 3 > s) FALHA("MEMG fora de um registro de ativação");
+#endif
+                const int *args = mepa_memo_desempilha(&memo, D[1]);
+                if (args != NULL) mepa_memo_grava(&memo, memc->c, args, memc->b, M[D[1] - memc->b - 3]);
+            } break;
+
+            // Superinstruções (ver OpFundida em mepa_vm.h)
+            case MEPA_CRLC_CRCT_SOMA:
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                EMPILHA(ARIT(M[end], +, ins->b));
+                SALTA(2);
+                break;
+
+            case MEPA_CRLC_CRCT_SUBT:
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                EMPILHA(ARIT(M[end], -, ins->b));
+                SALTA(2);
+                break;
+
+            case MEPA_CRGB_CRCT_SOMA:
+                VERIFICA_END(ins->a);
+                EMPILHA(ARIT(M[ins->a], +, ins->b));
+                SALTA(2);
+                break;
+
+            case MEPA_CRLC_CRLC_MULT:
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                v = M[end];
+                end = D[1] + ins->b;
+                VERIFICA_END(end);
+                EMPILHA(ARIT(v, *, M[end]));
+                SALTA(2);
+                break;
+
+            case MEPA_CRLC_CRCT:
+                end = D[1] + ins->a;
+                VERIFICA_END(end);
+                EMPILHA(M[end]);
+                EMPILHA(ins->b);
+                SALTA(1);
+                break;
+
+            case MEPA_CRGB_CRCT:
+                VERIFICA_END(ins->a);
+                EMPILHA(M[ins->a]);
+                EMPILHA(ins->b);
+                SALTA(1);
+                break;
+
+            case MEPA_CMME_DSVF: COMPARA_DESVIA(<);  break;
+            case MEPA_CMMA_DSVF: COMPARA_DESVIA(>);  break;
+            case MEPA_CMIG_DSVF: COMPARA_DESVIA(==); break;
+            case MEPA_CMDG_DSVF: COMPARA_DESVIA(!=); break;
+            case MEPA_CMEG_DSVF: COMPARA_DESVIA(<=); break;
+            case MEPA_CMAG_DSVF: COMPARA_DESVIA(>=); break;
+
+            default:
+                FALHA("instrução inválida");
+        }
+    }
+
+erro:
+    mepa_saida_descarrega(&sai);
+    fprintf(stderr, "ERRO DE EXECUÇÃO na instrução %d (%s): %s\n",
+            i - 1, i > 0 && i <= p->tamanho ? mepa_vm_nome_op(p->codigo[i - 1].op) : "?", msg_erro);
+    resultado = 1;
+
+fim:
+#if LACO_PERFIL
+    if (k_anterior >= 0) {
+        unsigned long long t = mepa_perfil_relogio();
+        perfil->ciclos[k_anterior] += t - relogio;
+        perfil->nos[no_anterior].ciclos += t - relogio;
+    }
+#endif
+    mepa_saida_libera(&sai);
+    mepa_entrada_libera(&ent);
+    if (est != NULL) {
+        est->instrucoes = contador;
+        est->pilha_max = pilha_max;
+        est->memoria = tam;
+        est->memo_acertos = memo.acertos;
+        est->memo_faltas = memo.faltas;
+        est->memo_remocoes = memo.remocoes;
+    }
+    mepa_memo_libera(&memo);
+    free(M);
+    return resultado;
+}
+
+#undef FALHA
+#undef SALTA
+#undef COMPARA_DESVIA
+#undef EMPILHA
+#undef ATUALIZA_MAX
+#undef VERIFICA_POP
+#undef VERIFICA_END
+#undef VERIFICA_NIVEL
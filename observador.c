@@ -0,0 +1,92 @@
+#include "observador.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Um arquivo observado: o watch do seu diretório e o nome dentro dele
+typedef struct {
+    int wd;
+    const char* nome;
+    int pendente;
+} Observado;
+
+static int adiciona(int fd, Observado* o, const char* arquivo) {
+    const char *barra = strrchr(arquivo, '/');
+    o->nome = barra ? barra + 1 : arquivo;
+
+    // O diretório de "a.ras" é ".", o de "/a.ras" é "/"
+    char *dir = strdup(barra ? arquivo : ".");
+    if (dir == NULL) {
+        perror("Erro ao alocar memória para o observador");
+        exit(EXIT_FAILURE);
+    }
+    if (barra) dir[barra == arquivo ? 1 : barra - arquivo] = '\0';
+
+    // Um diretório já observado devolve o mesmo wd
+    o->wd = inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (o->wd < 0) fprintf(stderr, "Erro ao observar %s: %s\n", dir, strerror(errno));
+    free(dir);
+    return o->wd >= 0;
+}
+
+// Marca como pendentes os arquivos citados nos eventos de buf[0, tam)
+static void marca(Observado* obs, int n, const char* buf, ssize_t tam) {
+    for (ssize_t p = 0; p < tam; ) {
+        const struct inotify_event *ev = (const struct inotify_event*)(buf + p);
+        p += sizeof(struct inotify_event) + ev->len;
+        if (ev->len == 0) continue;
+        for (int k = 0; k < n; k++)
+            if (obs[k].wd == ev->wd && strcmp(obs[k].nome, ev->name) == 0) obs[k].pendente = 1;
+    }
+}
+
+int observa_arquivos(char* const* arquivos, int n, void (*recompila)(int k, void* ctx), void* ctx) {
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) {
+        perror("Erro ao iniciar o inotify");
+        return 1;
+    }
+
+    Observado *obs = calloc(n, sizeof(Observado));
+    if (obs == NULL) {
+        perror("Erro ao alocar memória para o observador");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < n; k++) {
+        if (!adiciona(fd, &obs[k], arquivos[k])) {
+            free(obs);
+            close(fd);
+            return 1;
+        }
+    }
+    printf("[watch] Observando %d arquivo(s); Ctrl+C encerra.\n", n);
+    fflush(stdout);
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t tam = read(fd, buf, sizeof(buf));
+        if (tam < 0 && errno == EINTR) continue;
+        if (tam <= 0) break;
+        marca(obs, n, buf, tam);
+
+        // Junta os eventos que já estão na fila
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        while (poll(&pfd, 1, 0) > 0 && (tam = read(fd, buf, sizeof(buf))) > 0)
+            marca(obs, n, buf, tam);
+
+        for (int k = 0; k < n; k++) {
+            if (!obs[k].pendente) continue;
+            obs[k].pendente = 0;
+            recompila(k, ctx);
+        }
+    }
+
+    perror("Erro ao ler eventos do inotify");
+    free(obs);
+    close(fd);
+    return 1;
+}
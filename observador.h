@@ -0,0 +1,21 @@
+#ifndef OBSERVADOR_H
+#define OBSERVADOR_H
+
+// Modo de observação (`calc --watch`): espera, com inotify, que algum dos
+// arquivos observados seja gravado e chama o callback de recompilação para
+// cada um. O que é observado é o diretório de cada arquivo, não o arquivo:
+// os editores costumam gravar num arquivo temporário e renomeá-lo por cima
+// do original, o que troca o inode (e um observador no arquivo antigo não
+// veria mais nada). Valem o fechamento de um arquivo aberto para escrita
+// (IN_CLOSE_WRITE) e a chegada de um por rename (IN_MOVED_TO), ou seja,
+// só conteúdo completo.
+//
+// Os eventos que já chegaram quando o primeiro é lido são tratados juntos:
+// um arquivo gravado várias vezes seguidas (ou gravado e renomeado) é
+// recompilado uma vez só.
+
+// Observa `arquivos[0..n)` e chama `recompila(k, ctx)` a cada gravação de
+// arquivos[k]; só retorna se o inotify falhar (1)
+int observa_arquivos(char* const* arquivos, int n, void (*recompila)(int k, void* ctx), void* ctx);
+
+#endif
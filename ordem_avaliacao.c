@@ -0,0 +1,261 @@
+#include "ordem_avaliacao.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Resumo de uma subexpressão usado para decidir se a troca é segura
+typedef struct {
+    int necessidade;  // Posições de pilha (Sethi–Ullman)
+    int chamada;      // Contém chamada de função
+    int global;       // Lê variável global
+    int divisao;      // Contém div (pode falhar em tempo de execução)
+} InfoExpr;
+
+static _Thread_local int num_trocas = 0; // Por thread (compilação em paralelo)
+
+static int maximo(int a, int b) {
+    return a > b ? a : b;
+}
+
+// Operador equivalente com os operandos trocados (0 se não houver)
+static int op_trocado(int op) {
+    switch (op) {
+        case '+': case '*': case AND: case OR: case IGUAL: case DIF:
+            return op;
+        case MENOR: return MAIOR;
+        case MAIOR: return MENOR;
+        case MENOR_IGUAL: return MAIOR_IGUAL;
+        case MAIOR_IGUAL: return MENOR_IGUAL;
+        default: return 0;
+    }
+}
+
+// `a` pode ser avaliado antes de `b` sem mudar o comportamento observável?
+static int pode_antecipar(const InfoExpr* a, const InfoExpr* b) {
+    if (!a->chamada) return !b->chamada || (!a->global && !a->divisao);
+    return !b->chamada && !b->global && !b->divisao;
+}
+
+// Resumo de `e` a partir dos resumos dos filhos, na ordem do percurso
+// (argumentos; esquerda e direita); com `reordena`, troca os operandos
+// de um BIN se compensar. Um nó já substituído por uma constante
+// (avaliacao_parcial.h) ignora os filhos que tinha.
+static InfoExpr combina(TabelaSimbolos* ts, Expr* e, const InfoExpr* filhos, int reordena) {
+    InfoExpr r = { 1, 0, 0, 0 };
+    Simbolo *s;
+
+    switch (e->tipo) {
+        case EXPR_NUM:
+        case EXPR_BOOL:
+            break;
+
+        case EXPR_VAR:
+            s = ts_busca(ts, e->u.id);
+            if (s != NULL && s->categoria == CAT_FUNCAO)
+                r.chamada = 1;  // AMEM 1 (retorno), sem argumentos
+            else if (s != NULL && s->nivel == NIVEL_GLOBAL)
+                r.global = 1;
+            break;
+
+        case EXPR_CALL_FUNC: {
+            // AMEM 1 (retorno) seguido dos argumentos, empilhados em ordem
+            r.chamada = 1;
+            int j = 1;
+            for (Expr *a = e->u.func.args_lista; a != NULL; a = a->prox, j++, filhos++) {
+                r.necessidade = maximo(r.necessidade, j + filhos->necessidade);
+                r.global |= filhos->global;
+                r.divisao |= filhos->divisao;
+            }
+        } break;
+
+        case EXPR_UN:
+            r = filhos[0];
+            break;
+
+        case EXPR_BIN: {
+            InfoExpr esq = filhos[0], dir = filhos[1];
+
+            // Em ordem, o resultado da esquerda ocupa uma posição durante a direita
+            int em_ordem = maximo(esq.necessidade, 1 + dir.necessidade);
+            int trocado = maximo(dir.necessidade, 1 + esq.necessidade);
+            int op = op_trocado(e->u.bin.op);
+
+            if (reordena && op != 0 && trocado < em_ordem && pode_antecipar(&dir, &esq)) {
+                Expr *tmp = e->u.bin.esq;
+                e->u.bin.esq = e->u.bin.dir;
+                e->u.bin.dir = tmp;
+                e->u.bin.op = op;
+                em_ordem = trocado;
+                num_trocas++;
+            }
+
+            r.necessidade = em_ordem;
+            r.chamada = esq.chamada || dir.chamada;
+            r.global = esq.global || dir.global;
+            r.divisao = esq.divisao || dir.divisao || e->u.bin.op == DIV;
+        } break;
+    }
+
+    return r;
+}
+
+// Sem reordenar, direto na árvore
+static InfoExpr analisa(TabelaSimbolos* ts, Expr* e) {
+    Expr *filho = NULL;
+    int n = 0;
+    switch (e->tipo) {
+        case EXPR_BIN: filho = e->u.bin.esq; n = 2; break;
+        case EXPR_UN: filho = e->u.un.arg; n = 1; break;
+        case EXPR_CALL_FUNC:
+            filho = e->u.func.args_lista;
+            for (Expr *a = filho; a != NULL; a = a->prox) n++;
+            break;
+        default: break;
+    }
+
+    InfoExpr *filhos = malloc((n > 0 ? n : 1) * sizeof(InfoExpr));
+    if (filhos == NULL) {
+        perror("Erro ao alocar memória para a ordenação");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < n; k++) {
+        filhos[k] = analisa(ts, filho);
+        filho = (e->tipo == EXPR_BIN) ? e->u.bin.dir : filho->prox;
+    }
+    InfoExpr r = combina(ts, e, filhos, 0);
+    free(filhos);
+    return r;
+}
+
+int necessidade_pilha(TabelaSimbolos* ts, Expr* e) {
+    return analisa(ts, e).necessidade;
+}
+
+// ======================================================================
+// PASSE
+// ======================================================================
+
+// Cada expressão deixa o seu resumo na pilha, no pos; o do pai é feito
+// dos que os filhos deixaram acima da marca posta no pre
+struct OrdenacaoAvaliacao {
+    TabelaSimbolos* ts;
+    InfoExpr* resumos;
+    int num_resumos, cap_resumos;
+    int* marcas;
+    int num_marcas, cap_marcas;
+};
+
+static void* cresce(void* v, int num, int* cap, size_t tam) {
+    if (num < *cap) return v;
+    *cap = *cap ? 2 * *cap : 64;
+    v = realloc(v, *cap * tam);
+    if (v == NULL) {
+        perror("Erro ao alocar memória para a ordenação");
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+OrdenacaoAvaliacao* ordenacao_cria(void) {
+    OrdenacaoAvaliacao *o = calloc(1, sizeof(OrdenacaoAvaliacao));
+    if (o == NULL) {
+        perror("Erro ao alocar memória para a ordenação");
+        exit(EXIT_FAILURE);
+    }
+    return o;
+}
+
+void ordenacao_libera(OrdenacaoAvaliacao* o) {
+    if (o == NULL) return;
+    free(o->resumos);
+    free(o->marcas);
+    free(o);
+}
+
+static void or_inicio(void* estado, TabelaSimbolos* ts, Simbolo* s) {
+    OrdenacaoAvaliacao *o = estado;
+    (void)s;
+    o->ts = ts;
+    o->num_resumos = o->num_marcas = 0;
+}
+
+static int or_pre(void* estado, Expr* e) {
+    OrdenacaoAvaliacao *o = estado;
+    (void)e;
+    o->marcas = cresce(o->marcas, o->num_marcas, &o->cap_marcas, sizeof(int));
+    o->marcas[o->num_marcas++] = o->num_resumos;
+    return 1;
+}
+
+static void or_pos(void* estado, Expr* e) {
+    OrdenacaoAvaliacao *o = estado;
+    int marca = o->marcas[--o->num_marcas];
+    InfoExpr r = combina(o->ts, e, &o->resumos[marca], 1);
+    o->num_resumos = marca;
+    o->resumos = cresce(o->resumos, o->num_resumos, &o->cap_resumos, sizeof(InfoExpr));
+    o->resumos[o->num_resumos++] = r;
+}
+
+// O resumo de uma expressão de comando não é usado
+static void or_entre_cmd(void* estado, Comando* c, int k, Expr* e) {
+    OrdenacaoAvaliacao *o = estado;
+    (void)c; (void)k; (void)e;
+    o->num_resumos = 0;
+}
+
+const Passe passe_ordenacao = {
+    .nome = "ordenação da avaliação",
+    .exige_sem_erros = 1,
+    .inicio = or_inicio,
+    .pre_expr = {
+        [EXPR_NUM] = or_pre, [EXPR_VAR] = or_pre, [EXPR_BOOL] = or_pre,
+        [EXPR_BIN] = or_pre, [EXPR_UN] = or_pre, [EXPR_CALL_FUNC] = or_pre,
+    },
+    .pos_expr = {
+        [EXPR_NUM] = or_pos, [EXPR_VAR] = or_pos, [EXPR_BOOL] = or_pos,
+        [EXPR_BIN] = or_pos, [EXPR_UN] = or_pos, [EXPR_CALL_FUNC] = or_pos,
+    },
+    .entre_cmd = {
+        [CMD_ATRIB] = or_entre_cmd, [CMD_IF] = or_entre_cmd, [CMD_WHILE] = or_entre_cmd,
+        [CMD_WRITE] = or_entre_cmd, [CMD_CALL_PROC] = or_entre_cmd,
+    },
+};
+
+// ======================================================================
+// PERCURSO DO PROGRAMA
+// ======================================================================
+
+static int ordena(TabelaSimbolos* ts, Simbolo* s, Comando* comandos) {
+    int antes = num_trocas;
+    OrdenacaoAvaliacao *o = ordenacao_cria();
+    Percurso p;
+    percurso_inicia(&p, PERCURSO_SEPARADO);
+    percurso_adiciona(&p, &passe_ordenacao, o);
+    if (s != NULL)
+        percorre_subrotina(&p, ts, s);
+    else
+        percorre_principal(&p, ts, comandos);
+    ordenacao_libera(o);
+    return num_trocas - antes;
+}
+
+int ordena_subrotina(TabelaSimbolos* ts, Simbolo* s) {
+    return ordena(ts, s, NULL);
+}
+
+int ordena_principal(TabelaSimbolos* ts, Comando* comandos) {
+    return ordena(ts, NULL, comandos);
+}
+
+int ordena_avaliacao(Programa* p, TabelaSimbolos* ts) {
+    Bloco *b = p->bloco_principal;
+    int trocas = 0;
+
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        Simbolo *s = ts_busca_escopo(ts->global, d->u.subrot.nome);
+        if (s == NULL || s->decl != d) continue;
+        trocas += ordena_subrotina(ts, s);
+    }
+
+    return trocas + ordena_principal(ts, b->comandos);
+}
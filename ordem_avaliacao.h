@@ -0,0 +1,34 @@
+#ifndef ORDEM_AVALIACAO_H
+#define ORDEM_AVALIACAO_H
+
+#include "ast.h"
+#include "tabela_simbolos.h"
+#include "percurso.h"
+
+// Numeração de Sethi–Ullman adaptada à máquina de pilha: posições de
+// pilha necessárias para avaliar `e` (sem contar os registros de ativação
+// das funções chamadas).
+int necessidade_pilha(TabelaSimbolos* ts, Expr* e);
+
+// Percorre o programa trocando os operandos de operações comutativas
+// (e invertendo comparações: a < b vira b > a) quando isso reduz a
+// profundidade da pilha. A troca só é feita se não puder alterar o
+// resultado: um operando com chamada de função nunca passa à frente de
+// outro que chame funções, leia globais ou possa falhar (div).
+// Deve ser executada após analisa_semantica; retorna o número de trocas.
+int ordena_avaliacao(Programa* p, TabelaSimbolos* ts);
+
+// O mesmo para uma sub-rotina ou para os comandos do programa principal
+int ordena_subrotina(TabelaSimbolos* ts, Simbolo* s);
+int ordena_principal(TabelaSimbolos* ts, Comando* comandos);
+
+// A ordenação como passe de um percurso (percurso.h): a troca é decidida
+// no pos de cada BIN, com os resumos que os filhos deixaram numa pilha do
+// estado; fundida à geração, a expressão já sai ordenada
+typedef struct OrdenacaoAvaliacao OrdenacaoAvaliacao;
+
+extern const Passe passe_ordenacao;
+OrdenacaoAvaliacao* ordenacao_cria(void);
+void ordenacao_libera(OrdenacaoAvaliacao* o);
+
+#endif
@@ -0,0 +1,349 @@
+#include "otimizador_mepa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#define QUALQUER MEPA_NUM_OPS  // Coringa nos padrões
+
+static void* otm_malloc(size_t n) {
+    void *ptr = malloc(n > 0 ? n : 1);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o otimizador MEPA");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// Transforma a instrução em NADA, preservando o rótulo (o NADA é
+// removido depois por remove_nada, que passa o rótulo adiante)
+static void anula(InstrMepa* i) {
+    i->op = MEPA_NADA;
+    i->a = i->b = 0;
+    i->c = -1;
+}
+
+// Instrução em que cada rótulo está definido (-1 se em nenhuma)
+static int* mapeia_rotulos(const CodigoMepa* c) {
+    int *endereco = otm_malloc(c->num_rotulos * sizeof(int));
+    for (int r = 0; r < c->num_rotulos; r++) endereco[r] = -1;
+    for (int k = 0; k < c->num_instrs; k++)
+        if (c->instrs[k].rotulo >= 0) endereco[c->instrs[k].rotulo] = k;
+    return endereco;
+}
+
+// ======================================================================
+// PADRÕES
+// ======================================================================
+
+// CRxx v; ARxx v: armazena na variável o valor que acabou de ler dela
+static int carrega_armazena(InstrMepa* j) {
+    if (j[0].a != j[1].a || j[0].b != j[1].b) return 0;
+    anula(&j[0]);
+    anula(&j[1]);
+    return 1;
+}
+
+// CRCT e; OP: elemento neutro (x + 0, x - 0, x * 1, x div 1)
+static int elemento_neutro(InstrMepa* j) {
+    int neutro = (j[1].op == MEPA_SOMA || j[1].op == MEPA_SUBT) ? 0 : 1;
+    if (j[0].a != neutro) return 0;
+    anula(&j[0]);
+    anula(&j[1]);
+    return 1;
+}
+
+static int dobra_unaria(InstrMepa* j) {
+    if (j[1].op == MEPA_INVR)
+        j[0].a = (int)(0u - (unsigned)j[0].a);
+    else
+        j[0].a = (int)(1u - (unsigned)j[0].a);
+    anula(&j[1]);
+    return 1;
+}
+
+// INVR; INVR e NEGA; NEGA (NEGA é 1 - x, então também se anula)
+static int inversas(InstrMepa* j) {
+    anula(&j[0]);
+    anula(&j[1]);
+    return 1;
+}
+
+// CRCT k; DSVF R: o desvio é sempre ou nunca tomado
+static int desvio_constante(InstrMepa* j) {
+    if (j[0].a == 0) {
+        j[1].op = MEPA_DSVS;
+    } else {
+        anula(&j[1]);
+    }
+    anula(&j[0]);
+    return 1;
+}
+
+static int memoria_vazia(InstrMepa* j) {
+    if (j[0].a != 0) return 0;
+    anula(&j[0]);
+    return 1;
+}
+
+// AMEM a; AMEM b e DMEM a; DMEM b
+static int junta_memoria(InstrMepa* j) {
+    j[0].a += j[1].a;
+    anula(&j[1]);
+    return 1;
+}
+
+// CRCT a; CRCT b; OP
+static int dobra_constantes(InstrMepa* j) {
+    unsigned a = (unsigned)j[0].a, b = (unsigned)j[1].a;
+    int x = j[0].a, y = j[1].a, r;
+
+    switch (j[2].op) {
+        case MEPA_SOMA: r = (int)(a + b); break;
+        case MEPA_SUBT: r = (int)(a - b); break;
+        case MEPA_MULT: r = (int)(a * b); break;
+        case MEPA_DIVI:
+            if (y == 0 || (x == INT_MIN && y == -1)) return 0; // Falha em tempo de execução
+            r = x / y;
+            break;
+        case MEPA_CONJ: r = x && y; break;
+        case MEPA_DISJ: r = x || y; break;
+        case MEPA_CMME: r = x <  y; break;
+        case MEPA_CMMA: r = x >  y; break;
+        case MEPA_CMIG: r = x == y; break;
+        case MEPA_CMDG: r = x != y; break;
+        case MEPA_CMEG: r = x <= y; break;
+        case MEPA_CMAG: r = x >= y; break;
+        default: return 0;
+    }
+
+    j[0].a = r;
+    anula(&j[1]);
+    anula(&j[2]);
+    return 1;
+}
+
+// Padrões aplicados a janelas de instruções consecutivas. Só a primeira
+// instrução da janela pode ter rótulo: nas demais chegaria um desvio.
+static const struct {
+    int tamanho;
+    OpMepa ops[3];
+    int (*reescreve)(InstrMepa* j);
+} padroes[] = {
+    { 2, { MEPA_CRGB, MEPA_ARGB }, carrega_armazena },
+    { 2, { MEPA_CRLC, MEPA_ARLC }, carrega_armazena },
+    { 2, { MEPA_CRVL, MEPA_ARMZ }, carrega_armazena },
+    { 2, { MEPA_CRCT, MEPA_SOMA }, elemento_neutro },
+    { 2, { MEPA_CRCT, MEPA_SUBT }, elemento_neutro },
+    { 2, { MEPA_CRCT, MEPA_MULT }, elemento_neutro },
+    { 2, { MEPA_CRCT, MEPA_DIVI }, elemento_neutro },
+    { 2, { MEPA_CRCT, MEPA_INVR }, dobra_unaria },
+    { 2, { MEPA_CRCT, MEPA_NEGA }, dobra_unaria },
+    { 2, { MEPA_INVR, MEPA_INVR }, inversas },
+    { 2, { MEPA_NEGA, MEPA_NEGA }, inversas },
+    { 2, { MEPA_CRCT, MEPA_DSVF }, desvio_constante },
+    { 1, { MEPA_AMEM }, memoria_vazia },
+    { 1, { MEPA_DMEM }, memoria_vazia },
+    { 2, { MEPA_AMEM, MEPA_AMEM }, junta_memoria },
+    { 2, { MEPA_DMEM, MEPA_DMEM }, junta_memoria },
+    { 3, { MEPA_CRCT, MEPA_CRCT, QUALQUER }, dobra_constantes },
+};
+
+static int aplica_padroes(CodigoMepa* c) {
+    int mudou = 0;
+
+    for (int k = 0; k < c->num_instrs; k++) {
+        for (size_t p = 0; p < sizeof(padroes) / sizeof(padroes[0]); p++) {
+            int t = padroes[p].tamanho, casa = k + t <= c->num_instrs;
+            for (int j = 0; j < t && casa; j++) {
+                const InstrMepa *i = &c->instrs[k + j];
+                if ((padroes[p].ops[j] != QUALQUER && i->op != padroes[p].ops[j]) || (j > 0 && i->rotulo >= 0))
+                    casa = 0;
+            }
+            if (casa && padroes[p].reescreve(&c->instrs[k])) {
+                mudou = 1;
+                break;
+            }
+        }
+    }
+
+    return mudou;
+}
+
+// ======================================================================
+// CÓDIGO INALCANÇÁVEL E RÓTULOS
+// ======================================================================
+
+static int remove_inalcancavel(CodigoMepa* c) {
+    int n = c->num_instrs, topo = 0, mudou = 0;
+    int *endereco = mapeia_rotulos(c);
+    int *usos = otm_malloc(c->num_rotulos * sizeof(int));
+    int *pilha = otm_malloc(n * sizeof(int));
+    char *alcancavel = otm_malloc(n);
+    char *entrada = otm_malloc(n);
+
+    for (int r = 0; r < c->num_rotulos; r++) usos[r] = 0;
+    for (int k = 0; k < n; k++) alcancavel[k] = entrada[k] = 0;
+
+    if (n > 0) {
+        alcancavel[0] = 1;
+        pilha[topo++] = 0;
+    }
+
+    while (topo > 0) {
+        int k = pilha[--topo], suc[2], num_suc = 0;
+        const InstrMepa *i = &c->instrs[k];
+
+        if (mepa_op_usa_rotulo(i->op)) {
+            usos[i->a]++;
+            suc[num_suc++] = endereco[i->a];
+            if (i->op == MEPA_CHSR || i->op == MEPA_CTSR) entrada[endereco[i->a]] = 1;
+        }
+        if (i->op != MEPA_DSVS && i->op != MEPA_PARA && i->op != MEPA_RTSR && i->op != MEPA_RTPR
+            && i->op != MEPA_CTSR && k + 1 < n)
+            suc[num_suc++] = k + 1;
+
+        for (int j = 0; j < num_suc; j++) {
+            if (suc[j] < 0 || alcancavel[suc[j]]) continue;
+            alcancavel[suc[j]] = 1;
+            pilha[topo++] = suc[j];
+        }
+    }
+
+    // Uma sub-rotina que nunca retorna (laço infinito, chamada terminal)
+    // fica com o primeiro RTSR do seu código, mesmo inalcançável: é dele
+    // que o verificador tira o número de parâmetros
+    for (int ini = 0; ini < n; ) {
+        int fim = ini + 1, guardar = -1, retorna = 0;
+        while (fim < n && !entrada[fim]) fim++;
+        for (int k = ini; k < fim; k++) {
+            if (c->instrs[k].op != MEPA_RTSR) continue;
+            if (alcancavel[k]) retorna = 1;
+            else if (guardar < 0) guardar = k;
+        }
+        if (entrada[ini] && !retorna && guardar >= 0) alcancavel[guardar] = 1;
+        ini = fim;
+    }
+
+    for (int k = 0; k < n; k++) {
+        InstrMepa *i = &c->instrs[k];
+        if (!alcancavel[k] && (i->op != MEPA_NADA || i->rotulo >= 0)) {
+            anula(i);
+            i->rotulo = -1;
+            mudou = 1;
+        } else if (i->rotulo >= 0 && usos[i->rotulo] == 0) {
+            i->rotulo = -1;
+            mudou = 1;
+        }
+    }
+
+    free(endereco);
+    free(usos);
+    free(pilha);
+    free(alcancavel);
+    free(entrada);
+    return mudou;
+}
+
+// Remove os NADA passando o rótulo para a instrução seguinte; se ela já
+// tiver rótulo, os desvios para o rótulo do NADA passam a usar o dela
+static int remove_nada(CodigoMepa* c) {
+    int n = c->num_instrs, prox = n, mudou = 0;
+    int *sinonimo = otm_malloc(c->num_rotulos * sizeof(int));
+    char *removida = otm_malloc(n);
+
+    for (int r = 0; r < c->num_rotulos; r++) sinonimo[r] = r;
+
+    for (int k = n - 1; k >= 0; k--) {
+        InstrMepa *i = &c->instrs[k];
+        removida[k] = 0;
+        if (i->op != MEPA_NADA || prox == n) {
+            prox = k;
+            continue;
+        }
+
+        if (i->rotulo >= 0) {
+            if (c->instrs[prox].rotulo < 0)
+                c->instrs[prox].rotulo = i->rotulo;
+            else {
+                sinonimo[i->rotulo] = c->instrs[prox].rotulo;
+                // O nome da sub-rotina acompanha o rótulo que sobrevive
+                const char *nome = mepa_nome_rotulo(c, i->rotulo);
+                if (nome != NULL && mepa_nome_rotulo(c, c->instrs[prox].rotulo) == NULL)
+                    mepa_nomeia_rotulo(c, c->instrs[prox].rotulo, nome);
+            }
+        }
+        removida[k] = 1;
+        mudou = 1;
+    }
+
+    int m = 0;
+    for (int k = 0; k < n; k++) {
+        if (removida[k]) continue;
+        c->instrs[m] = c->instrs[k];
+        if (mepa_op_usa_rotulo(c->instrs[m].op))
+            c->instrs[m].a = sinonimo[c->instrs[m].a];
+        m++;
+    }
+    c->num_instrs = m;
+
+    free(sinonimo);
+    free(removida);
+    return mudou;
+}
+
+// ======================================================================
+// DESVIOS
+// ======================================================================
+
+static int encadeia_desvios(CodigoMepa* c) {
+    int *endereco = mapeia_rotulos(c);
+    int mudou = 0;
+
+    for (int k = 0; k < c->num_instrs; k++) {
+        InstrMepa *i = &c->instrs[k];
+        if (i->op != MEPA_DSVS && i->op != MEPA_DSVF) continue;
+
+        // Segue cadeias de DSVS (com limite, por causa de laços vazios)
+        int original = i->a, destino = endereco[i->a];
+        for (int passos = 0; passos < c->num_instrs && c->instrs[destino].op == MEPA_DSVS
+                             && c->instrs[destino].a != i->a; passos++) {
+            i->a = c->instrs[destino].a;
+            destino = endereco[i->a];
+        }
+        if (i->a != original) mudou = 1;
+
+        if (destino == k + 1) {
+            // Desvio para a instrução seguinte: só resta o desempilhamento
+            if (i->op == MEPA_DSVS)
+                anula(i);
+            else
+                i->op = MEPA_DMEM, i->a = 1;
+            mudou = 1;
+        } else if (i->op == MEPA_DSVS && (c->instrs[destino].op == MEPA_RTSR || c->instrs[destino].op == MEPA_PARA)) {
+            int rotulo = i->rotulo;
+            *i = c->instrs[destino];
+            i->rotulo = rotulo;
+            mudou = 1;
+        }
+    }
+
+    free(endereco);
+    return mudou;
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+int otimiza_mepa(CodigoMepa* c) {
+    int antes = c->num_instrs, mudou;
+
+    do {
+        mudou = remove_inalcancavel(c);
+        mudou |= remove_nada(c);
+        mudou |= encadeia_desvios(c);
+        mudou |= aplica_padroes(c);
+    } while (mudou);
+
+    return antes - c->num_instrs;
+}
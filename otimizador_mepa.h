@@ -0,0 +1,19 @@
+#ifndef OTIMIZADOR_MEPA_H
+#define OTIMIZADOR_MEPA_H
+
+#include "mepa.h"
+
+// Otimização peephole sobre o buffer gerado (rótulos ainda simbólicos).
+// Repete até não haver mudança:
+//   - remoção do código inalcançável (a partir do início e das entradas
+//     de sub-rotinas chamadas) e dos rótulos sem uso;
+//   - remoção dos NADA que só carregam rótulos, unindo rótulos encadeados;
+//   - encadeamento de desvios (desvio para DSVS vai direto ao destino
+//     final; DSVS para RTSR/PARA vira a própria instrução);
+//   - a tabela de padrões de padroes[] em otimizador_mepa.c.
+// Nenhuma regra aumenta a altura da pilha, então as profundidades
+// anotadas em INPP e CHSR continuam sendo limites válidos.
+// Retorna o número de instruções removidas.
+int otimiza_mepa(CodigoMepa* c);
+
+#endif
@@ -2,16 +2,38 @@
 #include <stdio.h>
 #include <string.h>
 #include "ast.h"
+#include "compilacao.h"
+#include "lexico_paralelo.h"
 
 int yylex(void);
 void yyerror(const char *);
 
 extern int yylineno;
 
+static Decl* compila_em_fluxo(Decl* d);
+
 %}
 
 %define parse.error verbose
 
+/* Além de yyparse (que chama yylex), um parser push (yypush_parse), que
+   recebe os tokens um a um (parser_incremental.h); puro, para que vários
+   possam estar abertos ao mesmo tempo */
+%define api.pure full
+%define api.push-pull both
+
+/* O scanner do flex continua escrevendo no yylval global */
+%code provides {
+extern YYSTYPE yylval;
+}
+
+%code {
+// Com tokens_entrada (lexico_paralelo.h) os tokens vêm do vetor ou do
+// scanner manual, não do scanner do flex
+static int proximo_token(YYSTYPE* lval);
+#define yylex proximo_token
+}
+
 /* Definição de Precedência e Associatividade (para a parte de expressões) */
 %left OR
 %left AND
@@ -57,6 +79,18 @@ extern int yylineno;
 %type <expr_no> expressao lista_exp expressao_simples termo fator id_ou_chamada_funcao
 %type <tipo_token> relacao // Usado para reter o token (IGUAL, DIF, etc)
 
+/* Valores descartados num erro sintático (a pilha e o token de
+   lookahead): o compilador pode seguir vivo depois (servidor.h). O
+   programa não entra: o Bison descarta o símbolo inicial também ao
+   aceitar, e ele continua em raiz_ast */
+%destructor { free($$); } <sval>
+%destructor { expr_free($$); } <expr_no>
+%destructor { cmd_free($$); } <cmd_no>
+%destructor { decl_free($$); } <decl_no>
+%destructor { idlist_free($$); } <id_lista>
+%destructor { paramdecl_free($$); } <param_decl_no>
+%destructor { bloco_free($$); } <bloco_no>
+
 %%
 
 /* ---------------------------------------------- */
@@ -67,10 +101,12 @@ programa
     : TK_PROGRAM ID ';' bloco '.' { $$ = criar_programa($2, $4); free($2); }
     ;
 
+// Só o programa tem bloco: $<sval>-1 é o seu nome, logo abaixo do ';'
 bloco         
     : secao_declaracao_var_opcional
+      { if (compilacao_em_fluxo) compilacao_cabecalho(compilacao_em_fluxo, $<sval>-1, $1); }
       secao_declaracao_subrotinas_opcional
-      comando_composto { $$ = criar_bloco($1, $2, $3); }
+      comando_composto { $$ = criar_bloco($1, $3, $4); }
     ;
 
 /* ---------------------------------------------- */
@@ -106,18 +142,21 @@ tipo_var
 /* ---------------------------------------------- */
 
 secao_declaracao_subrotinas_opcional   
-    : secao_declaracao_subrotinas { $$ = $1; }
+    : secao_declaracao_subrotinas { $$ = inverte_decls($1); }
     | /* vazio */ { $$ = NULL; }
     ;
 
+// Montada de trás para frente (adiciona_decl percorreria a lista a cada
+// sub-rotina) e invertida acima
 secao_declaracao_subrotinas 
     : declaracao_subrotina ';' { $$ = $1; }
-    | secao_declaracao_subrotinas declaracao_subrotina ';' { $$ = adiciona_decl($1, $2); }
+    | secao_declaracao_subrotinas declaracao_subrotina ';' { $$ = empilha_decl($1, $2); }
     ;
 
+// Em fluxo a sub-rotina é compilada e liberada aqui e não entra na lista
 declaracao_subrotina
-    : declaracao_procedimento { $$ = $1; }
-    | declaracao_funcao { $$ = $1; }
+    : declaracao_procedimento { $$ = compila_em_fluxo($1); }
+    | declaracao_funcao { $$ = compila_em_fluxo($1); }
     ;
 
 declaracao_procedimento
@@ -174,7 +213,9 @@ comando
     ;
 
 atribuicao
-    : ID ATRIB expressao { $$ = cmd_atrib($1, $3); free($1); }
+    // A linha é tomada no ATRIB: ao reduzir a regra o analisador léxico já
+    // pode ter lido o token seguinte, numa linha posterior
+    : ID ATRIB { $<ival>$ = yylineno; } expressao { $$ = cmd_atrib($1, $4); $$->linha = $<ival>3; free($1); }
     ;
 
 chamada_procedimento
@@ -253,6 +294,37 @@ id_ou_chamada_funcao
 
 %%
 
+#undef yylex
+
+YYSTYPE yylval;
+
+static int proximo_token(YYSTYPE* lval) {
+    if (tokens_entrada == NULL) {
+        int tipo = yylex();
+        *lval = yylval;
+        return tipo;
+    }
+
+    const Token *tk = lexico_proximo(tokens_entrada);
+    yylineno = tk->linha;
+    switch (tk->tipo) {
+        case NUM: lval->ival = tk->valor; break;
+        case ID: lval->sval = lexico_nome(tokens_entrada, tk); break;
+        case TOKEN_ILEGAL:
+            // Como a regra '.' de lexer.l
+            printf("ERRO LÉXICO na linha %d: símbolo ilegal %c\n", yylineno, tk->valor);
+            return 0;
+    }
+    return tk->tipo;
+}
+
+static Decl* compila_em_fluxo(Decl* d) {
+    if (compilacao_em_fluxo == NULL) return d;
+    compilacao_subrotina(compilacao_em_fluxo, d);
+    decl_free(d);
+    return NULL;
+}
+
 void yyerror(const char * msg){
     fprintf(stderr, "ERRO SINTÁTICO na linha %d: %s\n", yylineno, msg);
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "parser_incremental.h"
+#include "lexico_manual.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void yyerror(const char *);
+extern int yylineno;
+
+struct ParserIncremental {
+    yypstate* ps;
+    char* buf;              // Bytes recebidos e ainda não tokenizados
+    size_t tam, cap;
+    int linha;              // Linha do início de buf
+    EstadoParserInc estado;
+    Programa* programa;
+};
+
+ParserIncremental* parser_inc_cria(void) {
+    ParserIncremental *p = calloc(1, sizeof(ParserIncremental));
+    if (p == NULL || (p->ps = yypstate_new()) == NULL) {
+        perror("Erro ao alocar memória para o parser");
+        exit(EXIT_FAILURE);
+    }
+    p->linha = 1;
+    p->estado = PARSER_INC_CONTINUA;
+    return p;
+}
+
+void parser_inc_libera(ParserIncremental* p) {
+    if (p == NULL) return;
+    yypstate_delete(p->ps);
+    prog_free(p->programa);
+    free(p->buf);
+    free(p);
+}
+
+// Empurra um token ao parser. yylineno e raiz_ast são globais das ações da
+// gramática: valem para este parser só durante a chamada. A redução de
+// `programa` (que preenche raiz_ast) pode vir antes do fim, já no '.'.
+static void empurra(ParserIncremental* p, int tipo, const YYSTYPE* valor, int linha) {
+    Programa *raiz_anterior = raiz_ast;
+    raiz_ast = NULL;
+    yylineno = linha;
+
+    int r = yypush_parse(p->ps, tipo, valor);
+    if (raiz_ast != NULL) p->programa = raiz_ast;
+    if (r == 0) {
+        p->estado = PARSER_INC_ACEITO;
+    } else if (r != YYPUSH_MORE) {
+        p->estado = PARSER_INC_ERRO;
+    }
+    raiz_ast = raiz_anterior;
+}
+
+// Tokeniza e empurra buf[0, fim); o fim do fonte (token 0) só quando
+// `ultimo`
+static void processa(ParserIncremental* p, size_t fim, int ultimo) {
+    Scanner sc = { (const unsigned char*)p->buf, 0, fim, p->linha };
+    Token tk;
+    while (p->estado == PARSER_INC_CONTINUA) {
+        lexico_escaneia(&sc, &tk);
+        if (tk.tipo == 0 && !ultimo) break;
+
+        YYSTYPE valor;
+        int tipo = tk.tipo;
+        if (tipo == ID) {
+            valor.sval = malloc((size_t)tk.valor + 1);
+            if (valor.sval == NULL) {
+                perror("Erro ao alocar memória para o parser");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(valor.sval, p->buf + tk.desloc, (size_t)tk.valor);
+            valor.sval[tk.valor] = '\0';
+        } else if (tipo == NUM) {
+            valor.ival = tk.valor;
+        } else if (tipo == TOKEN_ILEGAL) {
+            // Como a regra '.' de lexer.l, que retorna o fim ao parser
+            printf("ERRO LÉXICO na linha %d: símbolo ilegal %c\n", tk.linha, tk.valor);
+            tipo = 0;
+        }
+        empurra(p, tipo, &valor, tk.linha);
+        if (tipo == 0 && p->estado == PARSER_INC_CONTINUA) p->estado = PARSER_INC_ERRO;
+    }
+
+    // O que foi tokenizado sai do buffer
+    memmove(p->buf, p->buf + fim, p->tam - fim);
+    p->tam -= fim;
+    p->linha = sc.linha;
+}
+
+static int espaco(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+EstadoParserInc parser_inc_alimenta(ParserIncremental* p, const char* dados, size_t tam) {
+    if (p->estado != PARSER_INC_CONTINUA) return p->estado;
+
+    if (p->tam + tam > p->cap) {
+        p->cap = p->tam + tam > 2 * p->cap ? p->tam + tam : 2 * p->cap;
+        p->buf = realloc(p->buf, p->cap);
+        if (p->buf == NULL) {
+            perror("Erro ao alocar memória para o parser");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(p->buf + p->tam, dados, tam);
+    size_t antes = p->tam;
+    p->tam += tam;
+
+    // Só o que vem até o último espaço está com os tokens completos; se o
+    // pedaço novo não tem espaço, nada muda
+    size_t fim = p->tam;
+    while (fim > antes && !espaco(p->buf[fim - 1])) fim--;
+    if (fim > antes) processa(p, fim - 1, 0);
+    return p->estado;
+}
+
+EstadoParserInc parser_inc_termina(ParserIncremental* p, Programa** programa) {
+    if (p->estado == PARSER_INC_CONTINUA) processa(p, p->tam, 1);
+    if (programa != NULL) {
+        *programa = p->estado == PARSER_INC_ACEITO ? p->programa : NULL;
+        if (*programa != NULL) p->programa = NULL;
+    }
+    return p->estado;
+}
@@ -0,0 +1,39 @@
+#ifndef PARSER_INCREMENTAL_H
+#define PARSER_INCREMENTAL_H
+
+#include <stddef.h>
+#include "ast.h"
+
+// Parsing incremental: o fonte chega em pedaços de qualquer tamanho (de um
+// pipe, de um socket, de um laço de eventos) e cada pedaço é tokenizado
+// pelo scanner manual (lexico_manual.h) e empurrado ao parser push do
+// Bison (yypush_parse) na hora, sem uma thread bloqueada em yyin por
+// fluxo. Rascal não tem comentários nem cadeias, então só os bytes depois
+// do último espaço em branco de um pedaço podem pertencer a um token
+// incompleto: eles esperam o pedaço seguinte.
+//
+// Vários parsers podem estar abertos ao mesmo tempo, alimentados pela
+// mesma thread; as ações da gramática (e a compilação em fluxo, se
+// compilacao_em_fluxo estiver ligada) rodam dentro de parser_inc_alimenta.
+// As mensagens de erro são as mesmas de yyparse.
+
+typedef struct ParserIncremental ParserIncremental;
+
+typedef enum {
+    PARSER_INC_CONTINUA,    // Espera mais entrada
+    PARSER_INC_ACEITO,      // Programa completo (só em parser_inc_termina)
+    PARSER_INC_ERRO,        // Erro léxico ou sintático; o resto é ignorado
+} EstadoParserInc;
+
+ParserIncremental* parser_inc_cria(void);
+
+// Entrega os próximos `tam` bytes do fonte
+EstadoParserInc parser_inc_alimenta(ParserIncremental* p, const char* dados, size_t tam);
+
+// Fim do fonte: processa o que restou; se aceito, *programa recebe a AST
+// (que passa a ser do chamador)
+EstadoParserInc parser_inc_termina(ParserIncremental* p, Programa** programa);
+
+void parser_inc_libera(ParserIncremental* p);
+
+#endif
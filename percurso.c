@@ -0,0 +1,241 @@
+#include "percurso.h"
+#include "semantico.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Um passe dentro de um percurso
+typedef struct {
+    const Passe* passe;
+    void* estado;
+    int ativo;              // Não parou por erros semânticos
+    const void* pulando;    // Nó cujos filhos este passe não visita
+} PasseAtivo;
+
+typedef struct {
+    PasseAtivo passes[PERCURSO_MAX_PASSES];
+    int num;
+    int exigentes;          // Passes com exige_sem_erros ainda ativos
+} Caminhada;
+
+void percurso_inicia(Percurso* p, ModoPercurso modo) {
+    p->modo = modo;
+    p->num_passes = 0;
+}
+
+void percurso_adiciona(Percurso* p, const Passe* passe, void* estado) {
+    if (p->num_passes == PERCURSO_MAX_PASSES) {
+        fprintf(stderr, "Erro interno: passes demais no percurso (%s)\n", passe->nome);
+        exit(EXIT_FAILURE);
+    }
+    p->passes[p->num_passes] = passe;
+    p->estados[p->num_passes] = estado;
+    p->num_passes++;
+}
+
+// ======================================================================
+// DESPACHO
+// ======================================================================
+
+// Só a análise encontra erros: depois de cada gancho de um passe que não
+// os exige ausentes, confere se os exigentes devem parar
+static void confere_erros(Caminhada* w, const PasseAtivo* p) {
+    if (w->exigentes == 0 || p->passe->exige_sem_erros || semantico_num_erros() == 0) return;
+    for (int k = 0; k < w->num; k++)
+        if (w->passes[k].passe->exige_sem_erros) w->passes[k].ativo = 0;
+    w->exigentes = 0;
+}
+
+static int chamavel(const PasseAtivo* p) {
+    return p->ativo && p->pulando == NULL;
+}
+
+static void pre_expr(Caminhada* w, Expr* e, TipoExpr t) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (!chamavel(p) || p->passe->pre_expr[t] == NULL) continue;
+        if (!p->passe->pre_expr[t](p->estado, e)) p->pulando = e;
+        confere_erros(w, p);
+    }
+}
+
+static void entre_expr(Caminhada* w, Expr* e, TipoExpr t, int k_filho, Expr* filho) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (!chamavel(p) || p->passe->entre_expr[t] == NULL) continue;
+        p->passe->entre_expr[t](p->estado, e, k_filho, filho);
+        confere_erros(w, p);
+    }
+}
+
+static void pos_expr(Caminhada* w, Expr* e, TipoExpr t) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (p->pulando == e) p->pulando = NULL;
+        if (!chamavel(p) || p->passe->pos_expr[t] == NULL) continue;
+        p->passe->pos_expr[t](p->estado, e);
+        confere_erros(w, p);
+    }
+}
+
+static void pre_cmd(Caminhada* w, Comando* c, TipoCmd t) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (!chamavel(p) || p->passe->pre_cmd[t] == NULL) continue;
+        if (!p->passe->pre_cmd[t](p->estado, c)) p->pulando = c;
+        confere_erros(w, p);
+    }
+}
+
+static void entre_cmd(Caminhada* w, Comando* c, TipoCmd t, int k_filho, Expr* filho) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (!chamavel(p) || p->passe->entre_cmd[t] == NULL) continue;
+        p->passe->entre_cmd[t](p->estado, c, k_filho, filho);
+        confere_erros(w, p);
+    }
+}
+
+static void pos_cmd(Caminhada* w, Comando* c, TipoCmd t) {
+    for (int k = 0; k < w->num; k++) {
+        PasseAtivo *p = &w->passes[k];
+        if (p->pulando == c) p->pulando = NULL;
+        if (!chamavel(p) || p->passe->pos_cmd[t] == NULL) continue;
+        p->passe->pos_cmd[t](p->estado, c);
+        confere_erros(w, p);
+    }
+}
+
+// ======================================================================
+// DESCIDA
+// ======================================================================
+
+// O tipo é lido na entrada: um passe pode reescrever o nó no pos
+static void visita_expr(Caminhada* w, Expr* e) {
+    TipoExpr t = e->tipo;
+    pre_expr(w, e, t);
+
+    switch (t) {
+        case EXPR_BIN:
+            visita_expr(w, e->u.bin.esq);
+            entre_expr(w, e, t, 0, e->u.bin.esq);
+            visita_expr(w, e->u.bin.dir);
+            break;
+        case EXPR_UN:
+            visita_expr(w, e->u.un.arg);
+            break;
+        case EXPR_CALL_FUNC: {
+            int k = 0;
+            for (Expr *a = e->u.func.args_lista; a != NULL; a = a->prox, k++) {
+                visita_expr(w, a);
+                entre_expr(w, e, t, k, a);
+            }
+        } break;
+        default:
+            break;
+    }
+
+    pos_expr(w, e, t);
+}
+
+static void visita_lista(Caminhada* w, Comando* c, TipoCmd t, Expr* lista) {
+    int k = 0;
+    for (Expr *e = lista; e != NULL; e = e->prox, k++) {
+        visita_expr(w, e);
+        entre_cmd(w, c, t, k, e);
+    }
+}
+
+static void visita_cmds(Caminhada* w, Comando* c) {
+    for (; c != NULL; c = c->prox) {
+        TipoCmd t = c->tipo;
+        pre_cmd(w, c, t);
+
+        switch (t) {
+            case CMD_ATRIB:
+                visita_lista(w, c, t, c->u.atrib.expr);
+                break;
+            case CMD_IF:
+                visita_lista(w, c, t, c->u.cond.cond);
+                visita_cmds(w, c->u.cond.then_cmd);
+                entre_cmd(w, c, t, 1, NULL);
+                visita_cmds(w, c->u.cond.else_cmd);
+                break;
+            case CMD_WHILE:
+                visita_lista(w, c, t, c->u.loop.cond);
+                visita_cmds(w, c->u.loop.body);
+                break;
+            case CMD_WRITE:
+                visita_lista(w, c, t, c->u.escrita.lista_exp);
+                break;
+            case CMD_CALL_PROC:
+                visita_lista(w, c, t, c->u.proc_call.args_lista);
+                break;
+            case CMD_COMPOSTO:
+                visita_cmds(w, c->u.composto->comandos);
+                break;
+            case CMD_READ:
+                break;
+        }
+
+        pos_cmd(w, c, t);
+    }
+}
+
+// ======================================================================
+// PERCURSOS
+// ======================================================================
+
+// Um percurso com os passes [de, ate) de `p`
+static int caminha(Percurso* p, int de, int ate, TabelaSimbolos* ts, Simbolo* s, Comando* comandos) {
+    Caminhada w = { .num = 0, .exigentes = 0 };
+    int sem_erros = semantico_num_erros() == 0;
+
+    for (int k = de; k < ate; k++) {
+        PasseAtivo *a = &w.passes[w.num++];
+        a->passe = p->passes[k];
+        a->estado = p->estados[k];
+        a->ativo = sem_erros || !a->passe->exige_sem_erros;
+        a->pulando = NULL;
+        if (a->ativo && a->passe->exige_sem_erros) w.exigentes++;
+    }
+
+    int ativos = 0;
+    for (int k = 0; k < w.num; k++) {
+        PasseAtivo *a = &w.passes[k];
+        ativos += a->ativo;
+        if (a->ativo && a->passe->inicio != NULL) a->passe->inicio(a->estado, ts, s);
+    }
+    if (ativos == 0) return 0;     // Nada a percorrer depois de erros
+    visita_cmds(&w, comandos);
+
+    int completo = 1;
+    for (int k = 0; k < w.num; k++) {
+        PasseAtivo *a = &w.passes[k];
+        if (a->ativo && a->passe->fim != NULL) {
+            a->passe->fim(a->estado, s);
+            confere_erros(&w, a);
+        }
+    }
+    for (int k = 0; k < w.num; k++) completo &= w.passes[k].ativo;
+    return completo;
+}
+
+static int percorre(Percurso* p, TabelaSimbolos* ts, Simbolo* s, Comando* comandos) {
+    if (p->modo == PERCURSO_FUNDIDO) return caminha(p, 0, p->num_passes, ts, s, comandos);
+
+    int completo = 1;
+    for (int k = 0; k < p->num_passes; k++)
+        completo &= caminha(p, k, k + 1, ts, s, comandos);
+    return completo;
+}
+
+int percorre_subrotina(Percurso* p, TabelaSimbolos* ts, Simbolo* s) {
+    ts_abre_local(ts, s);
+    int completo = percorre(p, ts, s, s->decl->u.subrot.bloco->comandos);
+    ts_fecha_local(ts);
+    return completo;
+}
+
+int percorre_principal(Percurso* p, TabelaSimbolos* ts, Comando* comandos) {
+    return percorre(p, ts, NULL, comandos);
+}
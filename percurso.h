@@ -0,0 +1,70 @@
+#ifndef PERCURSO_H
+#define PERCURSO_H
+
+#include "ast.h"
+#include "tabela_simbolos.h"
+
+// Percurso fundido dos comandos de uma sub-rotina (ou do principal) pelos
+// passes do compilador: análise semântica, avaliação parcial, ordenação
+// da avaliação e geração de código. Cada passe registra ganchos por tipo
+// de nó, chamados na entrada do nó (pre), depois de cada filho (entre) e
+// na saída (pos), e o percurso chama os de todos os passes numa só
+// descida pela árvore, na ordem em que foram adicionados: cada nó passa
+// por todos enquanto ainda está no cache. No modo separado (depuração,
+// calc --percursos-separados) cada passe tem o seu próprio percurso, um
+// depois do outro, como se fossem fases independentes.
+//
+// Num nó, o passe seguinte vê o que o anterior fez nele: a avaliação
+// parcial reescreve a chamada no pos, e os passes seguintes recebem o pos
+// do tipo visitado (EXPR_CALL_FUNC) com o nó já constante.
+//
+// As declarações de variáveis são instaladas na declaração da sub-rotina
+// (semantico.h) e não são percorridas; os ganchos da declaração da
+// sub-rotina (DECL_FUNCTION ou DECL_PROCEDURE) são `inicio` e `fim`, com
+// o símbolo dela (NULL no principal).
+
+#define PERCURSO_NUM_EXPR (EXPR_CALL_FUNC + 1)
+#define PERCURSO_NUM_CMD (CMD_COMPOSTO + 1)
+#define PERCURSO_MAX_PASSES 4
+
+typedef struct {
+    const char* nome;
+    // Só roda enquanto a análise semântica não encontrou erros: para no
+    // primeiro e não é mais chamado neste percurso
+    int exige_sem_erros;
+
+    void (*inicio)(void* estado, TabelaSimbolos* ts, Simbolo* s);
+    void (*fim)(void* estado, Simbolo* s);
+
+    // pre retorna 0 para que o passe não visite os filhos do nó (o pos
+    // dele ainda é chamado). entre é chamado depois do filho k: em BIN
+    // depois da esquerda (k = 0); em chamadas depois de cada argumento; em
+    // comandos depois de cada expressão filha e, no IF, também depois do
+    // then (k = 1, `filho` NULL).
+    int (*pre_expr[PERCURSO_NUM_EXPR])(void* estado, Expr* e);
+    void (*entre_expr[PERCURSO_NUM_EXPR])(void* estado, Expr* e, int k, Expr* filho);
+    void (*pos_expr[PERCURSO_NUM_EXPR])(void* estado, Expr* e);
+
+    int (*pre_cmd[PERCURSO_NUM_CMD])(void* estado, Comando* c);
+    void (*entre_cmd[PERCURSO_NUM_CMD])(void* estado, Comando* c, int k, Expr* filho);
+    void (*pos_cmd[PERCURSO_NUM_CMD])(void* estado, Comando* c);
+} Passe;
+
+typedef enum { PERCURSO_FUNDIDO, PERCURSO_SEPARADO } ModoPercurso;
+
+typedef struct {
+    ModoPercurso modo;
+    int num_passes;
+    const Passe* passes[PERCURSO_MAX_PASSES];
+    void* estados[PERCURSO_MAX_PASSES];
+} Percurso;
+
+void percurso_inicia(Percurso* p, ModoPercurso modo);
+void percurso_adiciona(Percurso* p, const Passe* passe, void* estado);
+
+// Percorrem os comandos de `s` (com o escopo local aberto) ou do
+// principal. Retornam 0 se algum passe parou por erros semânticos.
+int percorre_subrotina(Percurso* p, TabelaSimbolos* ts, Simbolo* s);
+int percorre_principal(Percurso* p, TabelaSimbolos* ts, Comando* comandos);
+
+#endif
@@ -0,0 +1,480 @@
+#include "semantico.h"
+#include "parser.tab.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int num_erros = 0;
+static _Thread_local MensagensSemantico* destino = NULL;
+static _Thread_local int silencio = 0;     // Compostos `copia` em análise (desenrolamento.h)
+
+static void guarda(MensagensSemantico* m, const char* fmt, va_list args) {
+    va_list copia;
+    va_copy(copia, args);
+    int n = vsnprintf(NULL, 0, fmt, copia);
+    va_end(copia);
+
+    if (m->tam + n + 1 > m->cap) {
+        m->cap = 2 * (m->tam + n + 1);
+        m->texto = realloc(m->texto, m->cap);
+        if (m->texto == NULL) {
+            perror("Erro ao alocar memória para as mensagens");
+            exit(EXIT_FAILURE);
+        }
+    }
+    vsnprintf(m->texto + m->tam, n + 1, fmt, args);
+    m->tam += n;
+}
+
+static void acrescenta(MensagensSemantico* m, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    guarda(m, fmt, args);
+    va_end(args);
+}
+
+static void mensagem(const char* tipo, int linha, const char* fmt, va_list args) {
+    if (destino == NULL) {
+        fprintf(stderr, "%s na linha %d: ", tipo, linha);
+        vfprintf(stderr, fmt, args);
+        fputc('\n', stderr);
+        return;
+    }
+    acrescenta(destino, "%s na linha %d: ", tipo, linha);
+    guarda(destino, fmt, args);
+    acrescenta(destino, "\n");
+}
+
+// Numa cópia do desenrolamento, o mesmo erro já foi informado (e contado)
+// na primeira cópia do corpo
+static void erro_semantico(int linha, const char* fmt, ...) {
+    if (silencio > 0) return;
+    va_list args;
+    va_start(args, fmt);
+    mensagem("ERRO SEMÂNTICO", linha, fmt, args);
+    va_end(args);
+    if (destino != NULL)
+        destino->erros++;
+    else
+        num_erros++;
+}
+
+static void alerta_semantico(int linha, const char* fmt, ...) {
+    if (silencio > 0) return;
+    va_list args;
+    va_start(args, fmt);
+    mensagem("ALERTA SEMÂNTICO", linha, fmt, args);
+    va_end(args);
+}
+
+// ======================================================================
+// DECLARAÇÕES
+// ======================================================================
+
+static void instala_vars(TabelaSimbolos* ts, Decl* d) {
+    Escopo *e = ts->local ? ts->local : ts->global;
+    int compartilhadas = 0;     // Posições usadas pelas locais com posição dada
+    for (; d != NULL; d = d->prox) {
+        for (IdList *id = d->u.var.ids; id != NULL; id = id->prox) {
+            Simbolo *s = ts_instala(ts, id->nome, CAT_VARIAVEL, d->u.var.tipo_var);
+            if (s == NULL) {
+                alerta_semantico(d->linha, "identificador '%s' já declarado neste escopo; declaração ignorada", id->nome);
+            } else if (id->morta) {
+                // Nunca lida: continua declarada (as atribuições a ela são
+                // verificadas), mas devolve a posição que acabou de receber
+                s->morta = 1;
+                s->deslocamento = -1;
+                e->prox_deslocamento--;
+            } else if (id->posicao >= 0) {
+                // Posição dada pelo compartilhamento (vivacidade.h), talvez
+                // a de outra local: também devolve a que recebeu
+                s->deslocamento = id->posicao;
+                e->prox_deslocamento--;
+                if (id->posicao >= compartilhadas) compartilhadas = id->posicao + 1;
+            }
+        }
+    }
+    if (e->prox_deslocamento < compartilhadas) e->prox_deslocamento = compartilhadas;
+}
+
+static void instala_params(TabelaSimbolos* ts, Simbolo* subrot, Decl* d) {
+    int n = 0;
+    for (ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox)
+        for (IdList *id = p->ids; id != NULL; id = id->prox) n++;
+
+    subrot->tipos_params = malloc((n > 0 ? n : 1) * sizeof(TipoSemantico));
+    subrot->num_params = n;
+
+    // Os parâmetros ficam abaixo da base do registro de ativação:
+    // o j-ésimo de n está em base - (n + 2) + j
+    int j = 0;
+    for (ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox) {
+        for (IdList *id = p->ids; id != NULL; id = id->prox, j++) {
+            subrot->tipos_params[j] = p->tipo_param;
+            Simbolo *s = ts_instala(ts, id->nome, CAT_PARAMETRO, p->tipo_param);
+            if (s == NULL)
+                alerta_semantico(d->linha, "parâmetro '%s' já declarado em '%s'", id->nome, subrot->nome);
+            else
+                s->deslocamento = j - (n + 2);
+        }
+    }
+}
+
+Simbolo* declara_subrotina(TabelaSimbolos* ts, Decl* d) {
+    CategoriaSimbolo cat = (d->tipo == DECL_FUNCTION) ? CAT_FUNCAO : CAT_PROCEDIMENTO;
+    Simbolo *s = ts_instala(ts, d->u.subrot.nome, cat, d->u.subrot.tipo_retorno);
+
+    if (s == NULL) {
+        alerta_semantico(d->linha, "identificador '%s' já declarado neste escopo; declaração ignorada", d->u.subrot.nome);
+        return NULL;
+    }
+    s->decl = d;
+    s->morta = d->morta;
+
+    ts_abre_local(ts, s);
+    instala_params(ts, s, d);
+    instala_vars(ts, d->u.subrot.bloco->decls_var);
+    s->num_locais = ts->local->prox_deslocamento;
+    ts_fecha_local(ts);
+    return s;
+}
+
+// ======================================================================
+// PASSE DE ANÁLISE
+// ======================================================================
+
+struct AnaliseSemantica {
+    TabelaSimbolos* ts;
+    Simbolo* subrot;        // NULL no principal
+    int retorno;            // Algum comando atribui ao nome da função
+    Simbolo** chamados;     // Das chamadas em análise, de fora para dentro
+    int num_chamados, cap_chamados;
+};
+
+AnaliseSemantica* analise_cria(void) {
+    AnaliseSemantica *a = calloc(1, sizeof(AnaliseSemantica));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise semântica");
+        exit(EXIT_FAILURE);
+    }
+    return a;
+}
+
+void analise_libera(AnaliseSemantica* a) {
+    if (a == NULL) return;
+    free(a->chamados);
+    free(a);
+}
+
+static void an_inicio(void* estado, TabelaSimbolos* ts, Simbolo* s) {
+    AnaliseSemantica *a = estado;
+    a->ts = ts;
+    a->subrot = s;
+    a->retorno = 0;
+    a->num_chamados = 0;
+}
+
+static void an_fim(void* estado, Simbolo* s) {
+    AnaliseSemantica *a = estado;
+    if (s != NULL && s->categoria == CAT_FUNCAO && !a->retorno)
+        erro_semantico(s->decl->linha, "função '%s' não retorna valor", s->nome);
+}
+
+// O chamado de cada chamada fica empilhado enquanto os argumentos são
+// analisados (NULL se a chamada é inválida: os argumentos não são)
+static int empilha_chamado(AnaliseSemantica* a, Simbolo* s) {
+    if (a->num_chamados == a->cap_chamados) {
+        a->cap_chamados = a->cap_chamados ? 2 * a->cap_chamados : 16;
+        a->chamados = realloc(a->chamados, a->cap_chamados * sizeof(Simbolo*));
+        if (a->chamados == NULL) {
+            perror("Erro ao alocar memória para a análise semântica");
+            exit(EXIT_FAILURE);
+        }
+    }
+    a->chamados[a->num_chamados++] = s;
+    return s != NULL;
+}
+
+// Tipo do argumento k, já analisado
+static void verifica_arg(AnaliseSemantica* a, int k, const Expr* arg, int linha) {
+    Simbolo *s = a->chamados[a->num_chamados - 1];
+    TipoSemantico t = arg->tipo_semantico;
+    if (k < s->num_params && t != T_VOID && t != s->tipos_params[k])
+        erro_semantico(linha, "argumento %d de '%s' deveria ser %s, mas é %s",
+                       k + 1, s->nome, tipo_semantico_to_string(s->tipos_params[k]),
+                       tipo_semantico_to_string(t));
+}
+
+// Desempilha o chamado e, se a chamada é válida, confere o número de
+// argumentos
+static Simbolo* desempilha_chamado(AnaliseSemantica* a, const Expr* args, int linha) {
+    Simbolo *s = a->chamados[--a->num_chamados];
+    if (s == NULL) return NULL;
+    int n = 0;
+    for (const Expr *e = args; e != NULL; e = e->prox) n++;
+    if (n != s->num_params)
+        erro_semantico(linha, "'%s' espera %d argumento(s), mas recebeu %d", s->nome, s->num_params, n);
+    return s;
+}
+
+// ----------------------------------------------------------------------
+// Expressões: o tipo de cada uma sai no pos, dos tipos dos filhos
+// ----------------------------------------------------------------------
+
+static void an_pos_num(void* estado, Expr* e) {
+    (void)estado;
+    e->tipo_semantico = T_INT;
+}
+
+static void an_pos_bool(void* estado, Expr* e) {
+    (void)estado;
+    e->tipo_semantico = T_BOOL;
+}
+
+static void an_pos_var(void* estado, Expr* e) {
+    AnaliseSemantica *a = estado;
+    Simbolo *s = ts_busca(a->ts, e->u.id);
+    TipoSemantico t = T_VOID;
+
+    if (s == NULL) {
+        erro_semantico(e->linha, "identificador '%s' não declarado", e->u.id);
+    } else if (s->categoria == CAT_VARIAVEL || s->categoria == CAT_PARAMETRO) {
+        t = s->tipo;
+    } else if (s->categoria == CAT_FUNCAO && s->num_params == 0) {
+        t = s->tipo; // Chamada de função sem argumentos
+    } else {
+        erro_semantico(e->linha, "'%s' (%s) não pode ser usado como valor",
+                       e->u.id, categoria_to_string(s->categoria));
+    }
+    e->tipo_semantico = t;
+}
+
+static int an_pre_chamada(void* estado, Expr* e) {
+    AnaliseSemantica *a = estado;
+    Simbolo *s = ts_busca(a->ts, e->u.func.nome);
+    if (s == NULL) {
+        erro_semantico(e->linha, "função '%s' não declarada", e->u.func.nome);
+    } else if (s->categoria != CAT_FUNCAO) {
+        erro_semantico(e->linha, "'%s' (%s) não é uma função",
+                       e->u.func.nome, categoria_to_string(s->categoria));
+        s = NULL;
+    }
+    return empilha_chamado(a, s);
+}
+
+static void an_entre_chamada(void* estado, Expr* e, int k, Expr* arg) {
+    verifica_arg(estado, k, arg, e->linha);
+}
+
+static void an_pos_chamada(void* estado, Expr* e) {
+    Simbolo *s = desempilha_chamado(estado, e->u.func.args_lista, e->linha);
+    e->tipo_semantico = s != NULL ? s->tipo : T_VOID;
+}
+
+static void an_pos_bin(void* estado, Expr* e) {
+    (void)estado;
+    TipoSemantico te = e->u.bin.esq->tipo_semantico;
+    TipoSemantico td = e->u.bin.dir->tipo_semantico;
+    TipoSemantico operando, resultado;
+
+    switch (e->u.bin.op) {
+        case '+': case '-': case '*': case DIV:
+            operando = T_INT; resultado = T_INT; break;
+        case MENOR: case MENOR_IGUAL: case MAIOR: case MAIOR_IGUAL:
+            operando = T_INT; resultado = T_BOOL; break;
+        case AND: case OR:
+            operando = T_BOOL; resultado = T_BOOL; break;
+        case IGUAL: case DIF:
+            if (te != T_VOID && td != T_VOID && te != td)
+                erro_semantico(e->linha, "operandos de '%s' com tipos diferentes (%s e %s)",
+                               token_to_string(e->u.bin.op),
+                               tipo_semantico_to_string(te), tipo_semantico_to_string(td));
+            e->tipo_semantico = T_BOOL;
+            return;
+        default:
+            e->tipo_semantico = T_VOID;
+            return;
+    }
+
+    if ((te != T_VOID && te != operando) || (td != T_VOID && td != operando))
+        erro_semantico(e->linha, "operador '%s' exige operandos do tipo %s",
+                       token_to_string(e->u.bin.op), tipo_semantico_to_string(operando));
+    e->tipo_semantico = resultado;
+}
+
+static void an_pos_un(void* estado, Expr* e) {
+    (void)estado;
+    TipoSemantico ta = e->u.un.arg->tipo_semantico;
+    TipoSemantico esperado = (e->u.un.op == NOT) ? T_BOOL : T_INT;
+    if (ta != T_VOID && ta != esperado)
+        erro_semantico(e->linha, "operador '%s' exige operando do tipo %s",
+                       token_to_string(e->u.un.op), tipo_semantico_to_string(esperado));
+    e->tipo_semantico = esperado;
+}
+
+// ----------------------------------------------------------------------
+// Comandos
+// ----------------------------------------------------------------------
+
+static void an_pos_atrib(void* estado, Comando* c) {
+    AnaliseSemantica *a = estado;
+    const char *nome = c->u.atrib.nome_var;
+    Simbolo *s = ts_busca(a->ts, nome);
+    TipoSemantico t = c->u.atrib.expr->tipo_semantico;
+
+    if (a->subrot != NULL && strcmp(nome, a->subrot->nome) == 0) a->retorno = 1;
+
+    if (s == NULL) {
+        erro_semantico(c->linha, "variável '%s' não declarada", nome);
+        return;
+    }
+
+    // Retorno de função: atribuição ao próprio nome dentro do corpo
+    int retorno = s->categoria == CAT_FUNCAO && a->ts->local != NULL && a->ts->local->dono == s;
+
+    if (s->categoria != CAT_VARIAVEL && s->categoria != CAT_PARAMETRO && !retorno) {
+        erro_semantico(c->linha, "'%s' (%s) não pode receber atribuição", nome, categoria_to_string(s->categoria));
+        return;
+    }
+
+    if (t != T_VOID && t != s->tipo)
+        erro_semantico(c->linha, "atribuição de %s a '%s', que é %s",
+                       tipo_semantico_to_string(t), nome, tipo_semantico_to_string(s->tipo));
+}
+
+static void verifica_cond(const Expr* cond, const char* cmd, int linha) {
+    TipoSemantico t = cond->tipo_semantico;
+    if (t != T_VOID && t != T_BOOL)
+        erro_semantico(linha, "condição do '%s' deve ser boolean", cmd);
+}
+
+static void an_entre_if(void* estado, Comando* c, int k, Expr* cond) {
+    (void)estado;
+    if (k == 0) verifica_cond(cond, "if", c->linha);
+}
+
+static void an_entre_while(void* estado, Comando* c, int k, Expr* cond) {
+    (void)estado;
+    (void)k;
+    verifica_cond(cond, "while", c->linha);
+}
+
+static int an_pre_read(void* estado, Comando* c) {
+    AnaliseSemantica *a = estado;
+    for (IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox) {
+        Simbolo *s = ts_busca(a->ts, id->nome);
+        if (s == NULL)
+            erro_semantico(c->linha, "variável '%s' não declarada", id->nome);
+        else if (s->categoria != CAT_VARIAVEL && s->categoria != CAT_PARAMETRO)
+            erro_semantico(c->linha, "'%s' (%s) não pode ser lido", id->nome, categoria_to_string(s->categoria));
+    }
+    return 1;
+}
+
+static int an_pre_proc(void* estado, Comando* c) {
+    AnaliseSemantica *a = estado;
+    Simbolo *s = ts_busca(a->ts, c->u.proc_call.nome);
+    if (s == NULL) {
+        erro_semantico(c->linha, "procedimento '%s' não declarado", c->u.proc_call.nome);
+    } else if (s->categoria != CAT_PROCEDIMENTO) {
+        erro_semantico(c->linha, "'%s' (%s) não é um procedimento",
+                       c->u.proc_call.nome, categoria_to_string(s->categoria));
+        s = NULL;
+    }
+    return empilha_chamado(a, s);
+}
+
+static void an_entre_proc(void* estado, Comando* c, int k, Expr* arg) {
+    verifica_arg(estado, k, arg, c->linha);
+}
+
+static void an_pos_proc(void* estado, Comando* c) {
+    desempilha_chamado(estado, c->u.proc_call.args_lista, c->linha);
+}
+
+static int an_pre_composto(void* estado, Comando* c) {
+    (void)estado;
+    silencio += c->copia;
+    return 1;
+}
+
+static void an_pos_composto(void* estado, Comando* c) {
+    (void)estado;
+    silencio -= c->copia;
+}
+
+const Passe passe_analise = {
+    .nome = "análise semântica",
+    .exige_sem_erros = 0,
+    .inicio = an_inicio,
+    .fim = an_fim,
+    .pre_expr = { [EXPR_CALL_FUNC] = an_pre_chamada },
+    .entre_expr = { [EXPR_CALL_FUNC] = an_entre_chamada },
+    .pos_expr = {
+        [EXPR_NUM] = an_pos_num, [EXPR_BOOL] = an_pos_bool, [EXPR_VAR] = an_pos_var,
+        [EXPR_BIN] = an_pos_bin, [EXPR_UN] = an_pos_un, [EXPR_CALL_FUNC] = an_pos_chamada,
+    },
+    .pre_cmd = { [CMD_READ] = an_pre_read, [CMD_CALL_PROC] = an_pre_proc, [CMD_COMPOSTO] = an_pre_composto },
+    .entre_cmd = { [CMD_IF] = an_entre_if, [CMD_WHILE] = an_entre_while, [CMD_CALL_PROC] = an_entre_proc },
+    .pos_cmd = { [CMD_ATRIB] = an_pos_atrib, [CMD_CALL_PROC] = an_pos_proc, [CMD_COMPOSTO] = an_pos_composto },
+};
+
+// Um percurso só com a análise
+static void analisa_comandos(TabelaSimbolos* ts, Simbolo* s, Comando* comandos) {
+    AnaliseSemantica *a = analise_cria();
+    Percurso p;
+    percurso_inicia(&p, PERCURSO_SEPARADO);
+    percurso_adiciona(&p, &passe_analise, a);
+    if (s != NULL)
+        percorre_subrotina(&p, ts, s);
+    else
+        percorre_principal(&p, ts, comandos);
+    analise_libera(a);
+}
+
+void analisa_corpo_subrotina(TabelaSimbolos* ts, Simbolo* s) {
+    analisa_comandos(ts, s, NULL);
+}
+
+// ======================================================================
+// PROGRAMA
+// ======================================================================
+
+void analisa_cabecalho(TabelaSimbolos* ts, const char* nome, Decl* decls_var) {
+    num_erros = 0;
+    ts_instala(ts, nome, CAT_PROGRAMA, T_VOID);
+    instala_vars(ts, decls_var);
+}
+
+void analisa_principal(TabelaSimbolos* ts, Comando* comandos) {
+    analisa_comandos(ts, NULL, comandos);
+}
+
+int semantico_num_erros(void) {
+    return num_erros + (destino != NULL ? destino->erros : 0);
+}
+
+void semantico_redireciona(MensagensSemantico* m) {
+    destino = m;
+}
+
+void semantico_despeja(MensagensSemantico* m) {
+    if (m->tam > 0) fwrite(m->texto, 1, m->tam, stderr);
+    num_erros += m->erros;
+    free(m->texto);
+    memset(m, 0, sizeof(*m));
+}
+
+int analisa_semantica(Programa* p, TabelaSimbolos* ts) {
+    Bloco *b = p->bloco_principal;
+    analisa_cabecalho(ts, p->nome, b->decls_var);
+
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox) {
+        Simbolo *s = declara_subrotina(ts, d);
+        if (s != NULL) analisa_corpo_subrotina(ts, s);
+    }
+
+    analisa_principal(ts, b->comandos);
+    return num_erros;
+}
@@ -0,0 +1,52 @@
+#ifndef SEMANTICO_H
+#define SEMANTICO_H
+
+#include "ast.h"
+#include "tabela_simbolos.h"
+#include "percurso.h"
+
+// Percorre a AST instalando os símbolos em `ts` e anotando o tipo
+// semântico das expressões. Retorna o número de erros encontrados.
+int analisa_semantica(Programa* p, TabelaSimbolos* ts);
+
+// A mesma análise em partes, na ordem do programa, para quem processa uma
+// sub-rotina de cada vez (compilacao.h):
+//   analisa_cabecalho         instala o programa e as globais e zera a
+//                             contagem de erros
+//   declara_subrotina         instala a sub-rotina, os parâmetros e as
+//                             locais; NULL se a declaração foi ignorada
+//   analisa_corpo_subrotina   verifica os comandos da sub-rotina
+//   analisa_principal         verifica os comandos do programa principal
+void analisa_cabecalho(TabelaSimbolos* ts, const char* nome, Decl* decls_var);
+Simbolo* declara_subrotina(TabelaSimbolos* ts, Decl* d);
+void analisa_corpo_subrotina(TabelaSimbolos* ts, Simbolo* s);
+void analisa_principal(TabelaSimbolos* ts, Comando* comandos);
+int semantico_num_erros(void);
+
+// A análise como passe de um percurso (percurso.h), para ser fundida aos
+// que vêm depois; o estado guarda as chamadas em análise e pode ser
+// reaproveitado de uma sub-rotina para a outra.
+typedef struct AnaliseSemantica AnaliseSemantica;
+
+extern const Passe passe_analise;
+AnaliseSemantica* analise_cria(void);
+void analise_libera(AnaliseSemantica* a);
+
+// Mensagens (erros e alertas) guardadas em vez de impressas, para a
+// análise em paralelo: cada sub-rotina guarda as suas e elas são impressas
+// depois, na ordem do programa, como na análise sequencial.
+typedef struct {
+    char* texto;
+    size_t tam, cap;
+    int erros;
+} MensagensSemantico;
+
+// Passa a guardar em `m` as mensagens da thread corrente (NULL volta a
+// imprimi-las e a contar os erros no total). semantico_num_erros conta
+// também os guardados.
+void semantico_redireciona(MensagensSemantico* m);
+
+// Imprime as mensagens guardadas, soma os erros ao total e libera `m`
+void semantico_despeja(MensagensSemantico* m);
+
+#endif
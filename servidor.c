@@ -0,0 +1,365 @@
+#include "servidor.h"
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// ==========================================
+// E/S no socket
+// ==========================================
+
+static int escreve_tudo(int fd, const void* dados, size_t tam) {
+    const char *p = dados;
+    while (tam > 0) {
+        ssize_t n = write(fd, p, tam);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        tam -= (size_t)n;
+    }
+    return 0;
+}
+
+static int le_tudo(int fd, void* dados, size_t tam) {
+    char *p = dados;
+    while (tam > 0) {
+        ssize_t n = read(fd, p, tam);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        tam -= (size_t)n;
+    }
+    return 0;
+}
+
+static int endereco(const char* caminho, struct sockaddr_un* end) {
+    memset(end, 0, sizeof(*end));
+    end->sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(end->sun_path)) {
+        fprintf(stderr, "Caminho do socket longo demais: %s\n", caminho);
+        return -1;
+    }
+    strcpy(end->sun_path, caminho);
+    return 0;
+}
+
+static int conecta(const char* caminho) {
+    struct sockaddr_un end;
+    if (endereco(caminho, &end) != 0) return -1;
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s < 0) return -1;
+    if (connect(s, (struct sockaddr*)&end, sizeof(end)) != 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+// ==========================================
+// Cliente
+// ==========================================
+
+int servidor_pede(const char* caminho, int argc, char** argv, int* status) {
+    int s = conecta(caminho);
+    if (s < 0) return -1;
+
+    size_t tam = 0;
+    for (int k = 0; k < argc; k++) tam += strlen(argv[k]) + 1;
+    if (tam > SERVIDOR_MAX_ARGS) {
+        close(s);
+        return -1;
+    }
+    char *args = malloc(tam + 1);
+    if (args == NULL) {
+        perror("Erro ao alocar memória para o pedido");
+        exit(EXIT_FAILURE);
+    }
+    size_t pos = 0;
+    for (int k = 0; k < argc; k++) {
+        size_t n = strlen(argv[k]) + 1;
+        memcpy(args + pos, argv[k], n);
+        pos += n;
+    }
+
+    int dir = open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0) {
+        perror("Erro ao abrir o diretório corrente");
+        free(args);
+        close(s);
+        return -1;
+    }
+    int fds[SERVIDOR_NUM_FDS] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO, dir };
+
+    // O cabeçalho leva os descritores
+    PedidoServidor ped = { SERVIDOR_VERSAO, (uint32_t)tam };
+    struct iovec iov = { &ped, sizeof(ped) };
+    union {
+        char buf[CMSG_SPACE(sizeof(fds))];
+        struct cmsghdr alinhamento;
+    } controle;
+    struct msghdr msg = { 0 };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = controle.buf;
+    msg.msg_controllen = sizeof(controle.buf);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+
+    ssize_t n;
+    do n = sendmsg(s, &msg, MSG_NOSIGNAL); while (n < 0 && errno == EINTR);
+    close(dir);
+    if (n != (ssize_t)sizeof(ped) || escreve_tudo(s, args, tam) != 0) {
+        free(args);
+        close(s);
+        return -1;
+    }
+    free(args);
+
+    int32_t st;
+    int r = le_tudo(s, &st, sizeof(st));
+    close(s);
+    if (r != 0) return -2;
+    *status = st;
+    return 0;
+}
+
+// ==========================================
+// Trabalhadores
+// ==========================================
+
+// Recebe um pedido: os descritores em fds e os argumentos em *argv
+// (precedidos de "calc"); -1 se o pedido for inválido
+static int recebe_pedido(int con, int fds[SERVIDOR_NUM_FDS], int* argc, char*** argv, char** args) {
+    PedidoServidor ped;
+    struct iovec iov = { &ped, sizeof(ped) };
+    union {
+        char buf[CMSG_SPACE(SERVIDOR_NUM_FDS * sizeof(int))];
+        struct cmsghdr alinhamento;
+    } controle;
+    struct msghdr msg = { 0 };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = controle.buf;
+    msg.msg_controllen = sizeof(controle.buf);
+
+    ssize_t n;
+    do n = recvmsg(con, &msg, MSG_CMSG_CLOEXEC); while (n < 0 && errno == EINTR);
+    if (n <= 0) return -1;
+
+    int recebidos = 0;
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        int k = (int)((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int *dados = (int*)CMSG_DATA(cm);
+        for (int i = 0; i < k; i++) {
+            if (recebidos < SERVIDOR_NUM_FDS) fds[recebidos++] = dados[i];
+            else close(dados[i]);
+        }
+    }
+    int valido = recebidos == SERVIDOR_NUM_FDS && !(msg.msg_flags & MSG_CTRUNC);
+    if (valido && (size_t)n < sizeof(ped))
+        valido = le_tudo(con, (char*)&ped + n, sizeof(ped) - (size_t)n) == 0;
+    valido = valido && ped.versao == SERVIDOR_VERSAO && ped.tam_args <= SERVIDOR_MAX_ARGS;
+
+    if (valido) {
+        *args = malloc(ped.tam_args + 1);
+        valido = *args != NULL && le_tudo(con, *args, ped.tam_args) == 0;
+    } else {
+        *args = NULL;
+    }
+    if (!valido) {
+        for (int i = 0; i < recebidos; i++) close(fds[i]);
+        free(*args);
+        return -1;
+    }
+
+    // Divide os argumentos; um último sem '\0' também conta
+    (*args)[ped.tam_args] = '\0';
+    int total = 1;
+    for (uint32_t i = 0; i < ped.tam_args; i += (uint32_t)strlen(*args + i) + 1) total++;
+    *argv = malloc((total + 1) * sizeof(char*));
+    if (*argv == NULL) {
+        perror("Erro ao alocar memória para o pedido");
+        exit(EXIT_FAILURE);
+    }
+    *argc = 0;
+    (*argv)[(*argc)++] = "calc";
+    for (uint32_t i = 0; i < ped.tam_args; i += (uint32_t)strlen(*args + i) + 1)
+        (*argv)[(*argc)++] = *args + i;
+    (*argv)[*argc] = NULL;
+    return 0;
+}
+
+// Executa um pedido com os descritores do cliente no lugar da entrada,
+// saída e erro padrão; ao final eles voltam a /dev/null, para que o
+// cliente veja o fim dos seus pipes
+static void atende(int con, int nulo, int (*executa)(int argc, char** argv)) {
+    int fds[SERVIDOR_NUM_FDS], argc;
+    char **argv, *args;
+    if (recebe_pedido(con, fds, &argc, &argv, &args) != 0) return;
+
+    int32_t status = 1;
+    if (fchdir(fds[3]) != 0) {
+        perror("Erro ao mudar para o diretório do cliente");
+    } else {
+        dup2(fds[0], STDIN_FILENO);
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[2], STDERR_FILENO);
+        // Nada lido de um cliente anterior pode restar no buffer
+        __fpurge(stdin);
+        clearerr(stdin);
+        clearerr(stdout);
+
+        status = executa(argc, argv);
+
+        fflush(stdout);
+        fflush(stderr);
+        __fpurge(stdin);
+        dup2(nulo, STDIN_FILENO);
+        dup2(nulo, STDOUT_FILENO);
+        dup2(nulo, STDERR_FILENO);
+    }
+
+    // Depois de uma entrada muito grande, o que passa do retido volta ao
+    // sistema, mesmo no meio do heap
+    if (mallinfo2().fordblks > SERVIDOR_HEAP_RETIDO) malloc_trim(SERVIDOR_HEAP_RETIDO);
+    for (int i = 0; i < SERVIDOR_NUM_FDS; i++) close(fds[i]);
+    free(argv);
+    free(args);
+
+    escreve_tudo(con, &status, sizeof(status));
+}
+
+static void trabalhador(int escuta, int (*executa)(int argc, char** argv)) {
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+    // O heap fica de um pedido para o outro: até SERVIDOR_HEAP_RETIDO da
+    // memória liberada não volta ao sistema, então os nós da AST, os
+    // símbolos e os buffers do pedido seguinte reaproveitam páginas já
+    // mapeadas
+    mallopt(M_TRIM_THRESHOLD, SERVIDOR_HEAP_RETIDO);
+
+    int nulo = open("/dev/null", O_RDWR);
+    if (nulo < 0) {
+        perror("Erro ao abrir /dev/null");
+        _exit(EXIT_FAILURE);
+    }
+    dup2(nulo, STDIN_FILENO);
+
+    for (int atendidos = 0; atendidos < SERVIDOR_PEDIDOS_POR_TRABALHADOR; ) {
+        int con = accept(escuta, NULL, NULL);
+        if (con < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("Erro em accept");
+            _exit(EXIT_FAILURE);
+        }
+        atende(con, nulo, executa);
+        close(con);
+        atendidos++;
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+// ==========================================
+// Processo principal
+// ==========================================
+
+static volatile sig_atomic_t encerrar = 0;
+
+static void ao_encerrar(int sinal) {
+    (void)sinal;
+    encerrar = 1;
+}
+
+static pid_t inicia_trabalhador(int escuta, int (*executa)(int argc, char** argv)) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) trabalhador(escuta, executa);
+    if (pid < 0) perror("Erro ao criar trabalhador");
+    return pid;
+}
+
+int servidor_executa(const char* caminho, int trabalhadores, int (*executa)(int argc, char** argv)) {
+    struct sockaddr_un end;
+    if (endereco(caminho, &end) != 0) return 1;
+
+    // Um socket que sobrou de um servidor encerrado é removido; um que
+    // responde é de um servidor ativo
+    int outro = conecta(caminho);
+    if (outro >= 0) {
+        close(outro);
+        fprintf(stderr, "Já há um servidor em %s\n", caminho);
+        return 1;
+    }
+    unlink(caminho);
+
+    int escuta = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (escuta < 0) {
+        perror("Erro ao criar o socket");
+        return 1;
+    }
+    mode_t mascara = umask(077);    // Só o dono pode pedir compilações
+    int r = bind(escuta, (struct sockaddr*)&end, sizeof(end));
+    umask(mascara);
+    if (r != 0 || listen(escuta, 128) != 0) {
+        perror(caminho);
+        close(escuta);
+        return 1;
+    }
+
+    struct sigaction sa = { 0 };
+    sa.sa_handler = ao_encerrar;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    pid_t *pids = calloc((size_t)trabalhadores, sizeof(pid_t));
+    if (pids == NULL) {
+        perror("Erro ao alocar os trabalhadores");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < trabalhadores; t++) pids[t] = inicia_trabalhador(escuta, executa);
+    printf("Servidor de compilação em %s com %d trabalhador(es).\n", caminho, trabalhadores);
+    fflush(stdout);
+
+    // Repõe os trabalhadores que terminam
+    while (!encerrar) {
+        int st;
+        pid_t pid = wait(&st);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int t = 0; t < trabalhadores; t++) {
+            if (pids[t] != pid) continue;
+            if (WIFSIGNALED(st))
+                fprintf(stderr, "ALERTA: trabalhador %d terminou pelo sinal %d\n", (int)pid, WTERMSIG(st));
+            pids[t] = encerrar ? -1 : inicia_trabalhador(escuta, executa);
+        }
+    }
+
+    for (int t = 0; t < trabalhadores; t++)
+        if (pids[t] > 0) kill(pids[t], SIGTERM);
+    while (wait(NULL) > 0 || errno == EINTR) { }
+    free(pids);
+    close(escuta);
+    unlink(caminho);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <stdint.h>
+
+// Servidor de compilação: `calc --servidor CAMINHO` escuta num socket Unix
+// e atende os pedidos de `calcc`, que tem a mesma linha de comando do calc.
+// Os pedidos são distribuídos entre processos trabalhadores já iniciados,
+// cada um executando um pedido por vez com o compilador inteiro (o parser
+// e as ações da gramática usam estado global, então a concorrência é entre
+// processos, não threads). Cada trabalhador mantém o heap de um pedido para
+// o seguinte em vez de devolvê-lo ao sistema, e é trocado por um novo após
+// SERVIDOR_PEDIDOS_POR_TRABALHADOR pedidos ou se terminar com erro.
+//
+// O cliente envia os argumentos e, junto, os seus descritores de entrada,
+// saída e erro padrão e do diretório corrente (SCM_RIGHTS): o trabalhador
+// os assume durante o pedido, então os caminhos relativos, `-` como
+// entrada e as mensagens de diagnóstico funcionam como no calc local. A
+// resposta é o código de saída.
+
+#define SERVIDOR_VERSAO 1
+#define SERVIDOR_NUM_FDS 4              // Entrada, saída, erro e diretório
+#define SERVIDOR_MAX_ARGS (1 << 20)     // Bytes de argumentos num pedido
+#define SERVIDOR_PEDIDOS_POR_TRABALHADOR 1000
+#define SERVIDOR_HEAP_RETIDO (64 * 1024 * 1024)     // Por trabalhador
+
+typedef struct {
+    uint32_t versao;
+    uint32_t tam_args;      // Seguem os argumentos, cada um terminado em '\0'
+} PedidoServidor;
+
+// Escuta em `caminho` com `trabalhadores` processos, cada pedido executado
+// por `executa` (o main do calc, com argv[0] == "calc"); só retorna ao
+// receber SIGINT ou SIGTERM (0) ou se não puder criar o socket (1)
+int servidor_executa(const char* caminho, int trabalhadores, int (*executa)(int argc, char** argv));
+
+// Envia ao servidor em `caminho` o pedido `argv[0..argc)` (sem o nome do
+// programa) e espera o código de saída em *status. Retorna 0 se concluído,
+// -1 se não houver servidor (nada foi executado) e -2 se a conexão caiu
+// durante o pedido.
+int servidor_pede(const char* caminho, int argc, char** argv, int* status);
+
+#endif
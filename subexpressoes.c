@@ -0,0 +1,885 @@
+#include "subexpressoes.h"
+#include "grafo_chamadas.h"
+#include "parser.tab.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define K_NUM  (-1)     // Operadores das chaves das constantes
+#define K_BOOL (-2)
+
+static void* se_realloc(void* ptr, size_t n, size_t tam) {
+    ptr = realloc(ptr, (n > 0 ? n : 1) * tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o reaproveitamento de subexpressões");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static void* se_calloc(size_t n, size_t tam) {
+    void *ptr = calloc(n > 0 ? n : 1, tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o reaproveitamento de subexpressões");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// Garante espaço para mais um item em *v, com *num itens e *cap de capacidade
+#define CABE(v, num, cap) \
+    do { if ((num) == (cap)) { (cap) = (cap) ? 2 * (cap) : 16; (v) = se_realloc((v), (cap), sizeof(*(v))); } } while (0)
+
+// Uma variável ou parâmetro; o número do valor vale na geração em que foi dado
+typedef struct {
+    const char* nome;
+    const IdList* id;
+    TipoSemantico tipo;
+    int valor;
+    int geracao;
+} Variavel;
+
+typedef struct {
+    const char* nome;
+    int var;
+} Nome;
+
+// Tabela de endereçamento aberto, com a primeira declaração de cada nome
+typedef struct {
+    Nome* itens;
+    int cap, num;
+} Nomes;
+
+typedef struct {
+    int detentoras;     // Variáveis que receberam o valor (lista em Subexpressoes.detentoras); -1
+    int disponivel;     // Definição mais recente na pilha; -1
+} Valor;
+
+typedef struct {
+    int op, a, b;
+    int valor;          // 0: posição livre
+} Chave;
+
+enum { NENHUMA, DEFINE, USA_VARIAVEL, USA_DEFINICAO };
+
+// Que primeiros cálculos podem sair de um comando para antes dele
+enum { SAI_NENHUM, SAI_SEM_FALHA, SAI_TODOS };
+
+// Uma expressão numerada
+typedef struct {
+    const Expr* e;
+    int valor;
+    TipoSemantico tipo;
+    int custo;          // Instruções do cálculo: os nós da subárvore
+    int falha;          // Pode parar a execução: divide por algo que não é constante não nula
+    int acao, ref;      // Variável ou definição
+} Info;
+
+// Primeiro cálculo de um valor, que vira temporária se compensar
+typedef struct {
+    const Expr* e;
+    TipoSemantico tipo;
+    int economia;       // Instruções das repetições trocadas
+    char* temp;
+} Definicao;
+
+typedef struct {
+    int var, prox;
+} Detentora;
+
+typedef struct {
+    int valor, def, anterior;
+} Disponivel;
+
+typedef struct {
+    int var, valor;
+} Troca;
+
+typedef struct {
+    Programa* prog;
+    Bloco* bloco;
+    GrafoChamadas* grafo;   // Montado na primeira chamada
+    int** escritas;         // Globais que cada nó do grafo pode escrever, terminadas em -1
+
+    Nomes globais, locais;
+    Variavel* vars;         // As globais, depois as locais do bloco
+    int num_vars, cap_vars, num_globais;
+    int geracao;
+
+    Valor* valores;         // Por número; o 0 é "sem número"
+    int num_valores, cap_valores;
+    Chave* chaves;
+    int num_chaves, cap_chaves;
+    Info* infos;
+    int num_infos, cap_infos;
+
+    Definicao* defs;
+    int num_defs, cap_defs;
+    Detentora* detentoras;
+    int num_detentoras, cap_detentoras;
+    Disponivel* pilha;
+    int num_pilha, cap_pilha;
+    Troca* trocas;          // Desfazer: o valor anterior de cada variável atribuída
+    int num_trocas, cap_trocas;
+
+    int* selo;              // Junção dos ramos de um if, por variável
+    int* final;
+    int num_selos;
+
+    int ordem;              // Expressões visitadas na reescrita
+    uint64_t marca;
+    ReaproveitamentoSubexpressoes total;
+} Subexpressoes;
+
+// ======================================================================
+// NOMES
+// ======================================================================
+
+static unsigned hash_nome(const char* s) {
+    unsigned h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+static void nomes_inicia(Nomes* t) {
+    t->cap = 16;
+    t->num = 0;
+    t->itens = se_calloc(t->cap, sizeof(Nome));
+}
+
+static int nomes_busca(const Nomes* t, const char* nome) {
+    for (unsigned k = hash_nome(nome) & (t->cap - 1); t->itens[k].nome != NULL; k = (k + 1) & (t->cap - 1))
+        if (strcmp(t->itens[k].nome, nome) == 0) return t->itens[k].var;
+    return -1;
+}
+
+static void nomes_declara(Nomes* t, const char* nome, int var) {
+    if (nomes_busca(t, nome) >= 0) return;
+
+    if (2 * (t->num + 1) > t->cap) {
+        Nomes maior = { se_calloc(2 * t->cap, sizeof(Nome)), 2 * t->cap, t->num };
+        for (int i = 0; i < t->cap; i++) {
+            if (t->itens[i].nome == NULL) continue;
+            unsigned k = hash_nome(t->itens[i].nome) & (maior.cap - 1);
+            while (maior.itens[k].nome != NULL) k = (k + 1) & (maior.cap - 1);
+            maior.itens[k] = t->itens[i];
+        }
+        free(t->itens);
+        *t = maior;
+    }
+
+    unsigned k = hash_nome(nome) & (t->cap - 1);
+    while (t->itens[k].nome != NULL) k = (k + 1) & (t->cap - 1);
+    t->itens[k].nome = nome;
+    t->itens[k].var = var;
+    t->num++;
+}
+
+static void declara(Subexpressoes* s, Nomes* t, const IdList* id, TipoSemantico tipo) {
+    if (nomes_busca(t, id->nome) >= 0) return;
+    CABE(s->vars, s->num_vars, s->cap_vars);
+    s->vars[s->num_vars] = (Variavel){ id->nome, id, tipo, 0, 0 };
+    nomes_declara(t, id->nome, s->num_vars++);
+}
+
+static void declara_vars(Subexpressoes* s, Nomes* t, const Decl* d) {
+    for (; d != NULL; d = d->prox)
+        for (const IdList *id = d->u.var.ids; id != NULL; id = id->prox)
+            declara(s, t, id, d->u.var.tipo_var);
+}
+
+// A variável ou parâmetro `nome`, como na análise: parâmetros e locais
+// escondem as globais; -1 para sub-rotinas, o programa e os não declarados
+static int resolve(const Subexpressoes* s, const char* nome) {
+    int x = nomes_busca(&s->locais, nome);
+    if (x >= 0) return x;
+    if (strcmp(nome, s->prog->nome) == 0) return -1;
+    return nomes_busca(&s->globais, nome);
+}
+
+// ======================================================================
+// VALORES
+// ======================================================================
+
+static int novo_valor(Subexpressoes* s) {
+    CABE(s->valores, s->num_valores, s->cap_valores);
+    s->valores[s->num_valores] = (Valor){ -1, -1 };
+    return s->num_valores++;
+}
+
+// O número do valor de `x`; na primeira leitura do bloco, um novo
+static int valor_var(Subexpressoes* s, int x) {
+    Variavel *v = &s->vars[x];
+    if (v->geracao != s->geracao) {
+        v->geracao = s->geracao;
+        v->valor = novo_valor(s);
+    }
+    return v->valor;
+}
+
+static void atribui(Subexpressoes* s, int x, int valor) {
+    CABE(s->trocas, s->num_trocas, s->cap_trocas);
+    s->trocas[s->num_trocas++] = (Troca){ x, valor_var(s, x) };
+    s->vars[x].valor = valor;
+}
+
+static void detem(Subexpressoes* s, int x, int valor) {
+    CABE(s->detentoras, s->num_detentoras, s->cap_detentoras);
+    s->detentoras[s->num_detentoras] = (Detentora){ x, s->valores[valor].detentoras };
+    s->valores[valor].detentoras = s->num_detentoras++;
+}
+
+// Uma variável que ainda guarda `valor`, com o tipo dele; -1 se não há
+static int detentora(Subexpressoes* s, int valor, TipoSemantico tipo) {
+    for (int d = s->valores[valor].detentoras; d >= 0; d = s->detentoras[d].prox) {
+        int x = s->detentoras[d].var;
+        if (s->vars[x].tipo == tipo && valor_var(s, x) == valor) return x;
+    }
+    return -1;
+}
+
+// Volta as variáveis ao que eram na troca `marca` e tira da pilha as
+// definições acima de `base`
+static void desfaz(Subexpressoes* s, int marca, int base) {
+    while (s->num_trocas > marca) {
+        const Troca *t = &s->trocas[--s->num_trocas];
+        s->vars[t->var].valor = t->valor;
+    }
+    while (s->num_pilha > base) {
+        const Disponivel *d = &s->pilha[--s->num_pilha];
+        s->valores[d->valor].disponivel = d->anterior;
+    }
+}
+
+static unsigned hash_chave(int op, int a, int b) {
+    unsigned long long h = (unsigned)op * 0x9e3779b97f4a7c15ull;
+    h = (h ^ (unsigned)a) * 0xff51afd7ed558ccdull;
+    h = (h ^ (unsigned)b) * 0xc4ceb9fe1a85ec53ull;
+    return (unsigned)(h ^ (h >> 32));
+}
+
+// O número de `a op b` (hash-consing): o mesmo para as mesmas entradas
+static int chave(Subexpressoes* s, int op, int a, int b) {
+    if (2 * (s->num_chaves + 1) > s->cap_chaves) {
+        int cap = s->cap_chaves ? 2 * s->cap_chaves : 64;
+        Chave *maior = se_calloc(cap, sizeof(Chave));
+        for (int i = 0; i < s->cap_chaves; i++) {
+            const Chave *c = &s->chaves[i];
+            if (c->valor == 0) continue;
+            unsigned k = hash_chave(c->op, c->a, c->b) & (cap - 1);
+            while (maior[k].valor != 0) k = (k + 1) & (cap - 1);
+            maior[k] = *c;
+        }
+        free(s->chaves);
+        s->chaves = maior;
+        s->cap_chaves = cap;
+    }
+
+    unsigned k = hash_chave(op, a, b) & (s->cap_chaves - 1);
+    for (; s->chaves[k].valor != 0; k = (k + 1) & (s->cap_chaves - 1)) {
+        const Chave *c = &s->chaves[k];
+        if (c->op == op && c->a == a && c->b == b) return c->valor;
+    }
+    s->chaves[k] = (Chave){ op, a, b, novo_valor(s) };
+    s->num_chaves++;
+    return s->chaves[k].valor;
+}
+
+// ======================================================================
+// INFORMAÇÕES DAS EXPRESSÕES
+// ======================================================================
+
+static unsigned hash_expr(const Expr* e) {
+    unsigned long long h = (unsigned long long)(uintptr_t)e * 0x9e3779b97f4a7c15ull;
+    return (unsigned)(h >> 32);
+}
+
+static Info* info(const Subexpressoes* s, const Expr* e) {
+    if (s->cap_infos == 0) return NULL;
+    for (unsigned k = hash_expr(e) & (s->cap_infos - 1); s->infos[k].e != NULL; k = (k + 1) & (s->cap_infos - 1))
+        if (s->infos[k].e == e) return &s->infos[k];
+    return NULL;
+}
+
+static void guarda_info(Subexpressoes* s, const Expr* e, int valor, TipoSemantico tipo, int custo, int falha) {
+    if (2 * (s->num_infos + 1) > s->cap_infos) {
+        int cap = s->cap_infos ? 2 * s->cap_infos : 64;
+        Info *maior = se_calloc(cap, sizeof(Info));
+        for (int i = 0; i < s->cap_infos; i++) {
+            if (s->infos[i].e == NULL) continue;
+            unsigned k = hash_expr(s->infos[i].e) & (cap - 1);
+            while (maior[k].e != NULL) k = (k + 1) & (cap - 1);
+            maior[k] = s->infos[i];
+        }
+        free(s->infos);
+        s->infos = maior;
+        s->cap_infos = cap;
+    }
+
+    unsigned k = hash_expr(e) & (s->cap_infos - 1);
+    while (s->infos[k].e != NULL) k = (k + 1) & (s->cap_infos - 1);
+    s->infos[k] = (Info){ e, valor, tipo, custo, falha, NENHUMA, -1 };
+    s->num_infos++;
+}
+
+static int pode_falhar(const Subexpressoes* s, const Expr* e) {
+    const Info *i = (e->tipo == EXPR_BIN || e->tipo == EXPR_UN) ? info(s, e) : NULL;
+    return i != NULL && i->falha;
+}
+
+// ======================================================================
+// CHAMADAS
+// ======================================================================
+
+// Dá números novos às globais que uma chamada de `nome` pode escrever
+static void mata_chamada(Subexpressoes* s, const char* nome) {
+    if (s->grafo == NULL) {
+        s->grafo = grafo_constroi(s->prog);
+        s->escritas = se_calloc(grafo_num_nos(s->grafo), sizeof(int*));
+    }
+
+    int no = grafo_busca(s->grafo, nome);
+    if (no < 0) return;     // Erro, informado pela análise
+    if (s->escritas[no] == NULL) {
+        int num = 0, *lista = se_calloc(grafo_num_globais(s->grafo) + 1, sizeof(int));
+        for (int g = 0; g < grafo_num_globais(s->grafo); g++) {
+            if (!grafo_escreve_global(s->grafo, no, g)) continue;
+            int x = nomes_busca(&s->globais, grafo_nome_global(s->grafo, g));
+            if (x >= 0) lista[num++] = x;
+        }
+        lista[num] = -1;
+        s->escritas[no] = lista;
+    }
+    for (const int *x = s->escritas[no]; *x >= 0; x++)
+        atribui(s, *x, novo_valor(s));
+}
+
+// Aplica as chamadas da lista de expressões `e`; retorna quantas são
+static int chamadas(Subexpressoes* s, const Expr* e) {
+    int num = 0;
+    for (; e != NULL; e = e->prox) {
+        switch (e->tipo) {
+            case EXPR_VAR:
+                if (resolve(s, e->u.id) >= 0) break;
+                mata_chamada(s, e->u.id);       // Função sem argumentos (ou erro)
+                num++;
+                break;
+            case EXPR_CALL_FUNC:
+                num += chamadas(s, e->u.func.args_lista) + 1;
+                mata_chamada(s, e->u.func.nome);
+                break;
+            case EXPR_BIN:
+                num += chamadas(s, e->u.bin.esq) + chamadas(s, e->u.bin.dir);
+                break;
+            case EXPR_UN:
+                num += chamadas(s, e->u.un.arg);
+                break;
+            default:
+                break;
+        }
+    }
+    return num;
+}
+
+// Números novos para as variáveis que os comandos podem mudar
+static void modificadas(Subexpressoes* s, const Comando* c) {
+    for (; c != NULL; c = c->prox) {
+        int x;
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                chamadas(s, c->u.atrib.expr);
+                if ((x = resolve(s, c->u.atrib.nome_var)) >= 0) atribui(s, x, novo_valor(s));
+                break;
+            case CMD_IF:
+                chamadas(s, c->u.cond.cond);
+                modificadas(s, c->u.cond.then_cmd);
+                modificadas(s, c->u.cond.else_cmd);
+                break;
+            case CMD_WHILE:
+                chamadas(s, c->u.loop.cond);
+                modificadas(s, c->u.loop.body);
+                break;
+            case CMD_READ:
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    if ((x = resolve(s, id->nome)) >= 0) atribui(s, x, novo_valor(s));
+                break;
+            case CMD_WRITE:
+                chamadas(s, c->u.escrita.lista_exp);
+                break;
+            case CMD_CALL_PROC:
+                chamadas(s, c->u.proc_call.args_lista);
+                mata_chamada(s, c->u.proc_call.nome);
+                break;
+            case CMD_COMPOSTO:
+                modificadas(s, c->u.composto->comandos);
+                break;
+        }
+    }
+}
+
+// ======================================================================
+// NUMERAÇÃO
+// ======================================================================
+
+static int comutativo(int op) {
+    return op == '+' || op == '*' || op == IGUAL || op == DIF || op == AND || op == OR;
+}
+
+// O número do valor de `e` (0: sem número), com o tipo e o custo; guarda
+// as informações das operações numeradas
+static int numera(Subexpressoes* s, const Expr* e, TipoSemantico* tipo, int* custo) {
+    TipoSemantico te, td;
+    int ce, cd, a, b, op;
+    *custo = 1;
+    switch (e->tipo) {
+        case EXPR_NUM:
+            *tipo = T_INT;
+            return chave(s, K_NUM, e->u.ival, 0);
+        case EXPR_BOOL:
+            *tipo = T_BOOL;
+            return chave(s, K_BOOL, e->u.ival, 0);
+        case EXPR_VAR: {
+            int x = resolve(s, e->u.id);
+            if (x < 0) return 0;
+            *tipo = s->vars[x].tipo;
+            return valor_var(s, x);
+        }
+        case EXPR_CALL_FUNC:
+            for (const Expr *arg = e->u.func.args_lista; arg != NULL; arg = arg->prox)
+                numera(s, arg, &te, &ce);
+            return 0;
+        case EXPR_UN:
+            a = numera(s, e->u.un.arg, &te, &ce);
+            if (a == 0 || te != (e->u.un.op == NOT ? T_BOOL : T_INT)) return 0;
+            *tipo = te;
+            *custo = ce + 1;
+            b = chave(s, e->u.un.op, a, 0);
+            guarda_info(s, e, b, *tipo, *custo, pode_falhar(s, e->u.un.arg));
+            return b;
+        case EXPR_BIN:
+            break;
+    }
+
+    a = numera(s, e->u.bin.esq, &te, &ce);
+    b = numera(s, e->u.bin.dir, &td, &cd);
+    if (a == 0 || b == 0) return 0;
+
+    op = e->u.bin.op;
+    switch (op) {
+        case '+': case '-': case '*': case DIV:
+            if (te != T_INT || td != T_INT) return 0;
+            *tipo = T_INT;
+            break;
+        case MENOR: case MENOR_IGUAL: case MAIOR: case MAIOR_IGUAL:
+            if (te != T_INT || td != T_INT) return 0;
+            *tipo = T_BOOL;
+            break;
+        case AND: case OR:
+            if (te != T_BOOL || td != T_BOOL) return 0;
+            *tipo = T_BOOL;
+            break;
+        case IGUAL: case DIF:
+            if (te != td) return 0;
+            *tipo = T_BOOL;
+            break;
+        default:
+            return 0;
+    }
+
+    // `a > b` é `b < a`; nas comutativas, os operandos em ordem
+    int troca = op == MAIOR || op == MAIOR_IGUAL || (comutativo(op) && a > b);
+    if (op == MAIOR) op = MENOR;
+    if (op == MAIOR_IGUAL) op = MENOR_IGUAL;
+    *custo = ce + cd + 1;
+    int v = troca ? chave(s, op, b, a) : chave(s, op, a, b);
+    const Expr *dir = e->u.bin.dir;
+    int falha = pode_falhar(s, e->u.bin.esq) || pode_falhar(s, dir)
+                || (op == DIV && (dir->tipo != EXPR_NUM || dir->u.ival == 0));
+    guarda_info(s, e, v, *tipo, *custo, falha);
+    return v;
+}
+
+// Marca as repetições de valores disponíveis em `e`, as maiores primeiro;
+// os demais cálculos que podem sair do comando (`sai`) ficam disponíveis
+// como definições
+static void reaproveita(Subexpressoes* s, const Expr* e, int sai) {
+    Info *i = (e->tipo == EXPR_BIN || e->tipo == EXPR_UN) ? info(s, e) : NULL;
+    if (i != NULL) {
+        int x = detentora(s, i->valor, i->tipo);
+        int d = s->valores[i->valor].disponivel;
+        if (x >= 0) {
+            i->acao = USA_VARIAVEL;
+            i->ref = x;
+            return;
+        }
+        if (d >= 0) {
+            i->acao = USA_DEFINICAO;
+            i->ref = s->pilha[d].def;
+            s->defs[i->ref].economia += i->custo - 1;
+            return;
+        }
+    }
+
+    switch (e->tipo) {
+        case EXPR_BIN:
+            reaproveita(s, e->u.bin.esq, sai);
+            reaproveita(s, e->u.bin.dir, sai);
+            break;
+        case EXPR_UN:
+            reaproveita(s, e->u.un.arg, sai);
+            break;
+        case EXPR_CALL_FUNC:
+            for (const Expr *arg = e->u.func.args_lista; arg != NULL; arg = arg->prox)
+                reaproveita(s, arg, sai);
+            break;
+        default:
+            break;
+    }
+    if (i == NULL || sai == SAI_NENHUM || (sai == SAI_SEM_FALHA && i->falha)) return;
+
+    CABE(s->defs, s->num_defs, s->cap_defs);
+    s->defs[s->num_defs] = (Definicao){ e, i->tipo, 0, NULL };
+    i->acao = DEFINE;
+    i->ref = s->num_defs++;
+
+    CABE(s->pilha, s->num_pilha, s->cap_pilha);
+    s->pilha[s->num_pilha] = (Disponivel){ i->valor, i->ref, s->valores[i->valor].disponivel };
+    s->valores[i->valor].disponivel = s->num_pilha++;
+}
+
+// Numera e marca as expressões de uma lista. Os itens de um write são
+// impressos um a um: um cálculo que pode falhar não sai de um item para
+// antes da impressão dos anteriores
+static void expressoes(Subexpressoes* s, const Expr* e, int sai) {
+    for (; e != NULL; e = e->prox) {
+        TipoSemantico tipo;
+        int custo;
+        numera(s, e, &tipo, &custo);
+        reaproveita(s, e, sai);
+        if (sai == SAI_TODOS) sai = SAI_SEM_FALHA;
+    }
+}
+
+// As variáveis atribuídas desde a troca `marca`, com os valores finais
+static Troca* finais(Subexpressoes* s, int marca, int* num) {
+    Troca *lista = se_calloc(s->num_trocas - marca, sizeof(Troca));
+    int selo = ++s->num_selos;
+    *num = 0;
+    for (int t = s->num_trocas - 1; t >= marca; t--) {
+        int x = s->trocas[t].var;
+        if (s->selo[x] == selo) continue;
+        s->selo[x] = selo;
+        lista[(*num)++] = (Troca){ x, s->vars[x].valor };
+    }
+    return lista;
+}
+
+// Depois de um if: cada variável atribuída num ramo fica com o número dos
+// dois, se for o mesmo, ou com um novo
+static void junta(Subexpressoes* s, const Troca* entao, int num_entao, const Troca* senao, int num_senao) {
+    int selo = ++s->num_selos;
+    for (int k = 0; k < num_senao; k++) {
+        s->selo[senao[k].var] = selo;
+        s->final[senao[k].var] = senao[k].valor;
+    }
+    for (int k = 0; k < num_entao; k++) {
+        int x = entao[k].var;
+        int outro = s->selo[x] == selo ? s->final[x] : valor_var(s, x);
+        s->selo[x] = -selo;     // Já juntada
+        atribui(s, x, outro == entao[k].valor ? outro : novo_valor(s));
+    }
+    for (int k = 0; k < num_senao; k++) {
+        int x = senao[k].var;
+        if (s->selo[x] != selo) continue;
+        atribui(s, x, valor_var(s, x) == senao[k].valor ? senao[k].valor : novo_valor(s));
+    }
+}
+
+static void numera_cmds(Subexpressoes* s, const Comando* c) {
+    for (; c != NULL; c = c->prox) {
+        int x, n, marca, base;
+        switch (c->tipo) {
+            case CMD_ATRIB: {
+                x = resolve(s, c->u.atrib.nome_var);
+                if (x >= 0 && s->vars[x].id->morta) break;      // Não é gerada (eliminacao.h)
+
+                TipoSemantico tipo;
+                int custo;
+                n = chamadas(s, c->u.atrib.expr);
+                int v = numera(s, c->u.atrib.expr, &tipo, &custo);
+                reaproveita(s, c->u.atrib.expr, n == 0 ? SAI_TODOS : SAI_NENHUM);
+                if (x < 0) break;
+                if (v != 0 && n == 0 && tipo == s->vars[x].tipo) {
+                    atribui(s, x, v);
+                    detem(s, x, v);
+                } else {
+                    atribui(s, x, novo_valor(s));
+                }
+            } break;
+            case CMD_IF: {
+                n = chamadas(s, c->u.cond.cond);
+                expressoes(s, c->u.cond.cond, n == 0 ? SAI_TODOS : SAI_NENHUM);
+                marca = s->num_trocas;
+                base = s->num_pilha;
+
+                int num_entao, num_senao;
+                numera_cmds(s, c->u.cond.then_cmd);
+                Troca *entao = finais(s, marca, &num_entao);
+                desfaz(s, marca, base);
+                numera_cmds(s, c->u.cond.else_cmd);
+                Troca *senao = finais(s, marca, &num_senao);
+                desfaz(s, marca, base);
+                junta(s, entao, num_entao, senao, num_senao);
+                free(entao);
+                free(senao);
+            } break;
+            case CMD_WHILE:
+                // O teste vê as variáveis que o laço muda com números novos,
+                // e depois do laço elas continuam assim
+                chamadas(s, c->u.loop.cond);
+                modificadas(s, c->u.loop.body);
+                expressoes(s, c->u.loop.cond, SAI_NENHUM);
+                marca = s->num_trocas;
+                base = s->num_pilha;
+                numera_cmds(s, c->u.loop.body);
+                desfaz(s, marca, base);
+                break;
+            case CMD_READ:
+                for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox)
+                    if ((x = resolve(s, id->nome)) >= 0) atribui(s, x, novo_valor(s));
+                break;
+            case CMD_WRITE:
+                n = chamadas(s, c->u.escrita.lista_exp);
+                expressoes(s, c->u.escrita.lista_exp, n == 0 ? SAI_TODOS : SAI_NENHUM);
+                break;
+            case CMD_CALL_PROC:
+                chamadas(s, c->u.proc_call.args_lista);
+                mata_chamada(s, c->u.proc_call.nome);
+                expressoes(s, c->u.proc_call.args_lista, SAI_NENHUM);
+                break;
+            case CMD_COMPOSTO:
+                numera_cmds(s, c->u.composto->comandos);
+                break;
+        }
+    }
+}
+
+// ======================================================================
+// REESCRITA
+// ======================================================================
+
+static uint64_t mistura(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+// Os construtores dão aos nós a linha corrente do scanner: os novos
+// recebem a do cálculo que substituem
+static Expr* leitura(const char* nome, int linha) {
+    Expr *e = expr_id((char*)nome);
+    e->linha = linha;
+    return e;
+}
+
+static Comando* composto(Comando* cmds, int linha) {
+    Comando *c = cmd_composto(criar_bloco(NULL, NULL, cmds));
+    c->linha = linha;
+    return c;
+}
+
+// Troca *pos, um item de lista, por `novo`
+static Expr* substitui(Expr** pos, Expr* novo) {
+    Expr *e = *pos;
+    novo->prox = e->prox;
+    e->prox = NULL;
+    *pos = novo;
+    return e;
+}
+
+// Reescreve a expressão *pos; os primeiros cálculos que viram temporárias
+// são acrescentados a **antes, na ordem em que devem ser feitos
+static void reescreve(Subexpressoes* s, Expr** pos, Comando*** antes) {
+    Expr *e = *pos;
+    const Info *i = (e->tipo == EXPR_BIN || e->tipo == EXPR_UN) ? info(s, e) : NULL;
+    int ordem = s->ordem++;
+    const char *nome = NULL;
+
+    if (i != NULL && i->acao == USA_VARIAVEL) {
+        nome = s->vars[i->ref].nome;
+        s->total.variaveis++;
+    } else if (i != NULL && i->acao == USA_DEFINICAO && s->defs[i->ref].temp != NULL) {
+        nome = s->defs[i->ref].temp;
+        s->total.repeticoes++;
+    }
+    if (nome != NULL) {
+        expr_free(substitui(pos, leitura(nome, e->linha)));
+        s->marca = mistura(mistura(mistura(s->marca, ordem), i->acao), hash_nome(nome));
+        return;
+    }
+
+    switch (e->tipo) {
+        case EXPR_BIN:
+            reescreve(s, &e->u.bin.esq, antes);
+            reescreve(s, &e->u.bin.dir, antes);
+            break;
+        case EXPR_UN:
+            reescreve(s, &e->u.un.arg, antes);
+            break;
+        case EXPR_CALL_FUNC:
+            for (Expr **arg = &e->u.func.args_lista; *arg != NULL; arg = &(*arg)->prox)
+                reescreve(s, arg, antes);
+            break;
+        default:
+            break;
+    }
+
+    if (i != NULL && i->acao == DEFINE && s->defs[i->ref].temp != NULL) {
+        const char *temp = s->defs[i->ref].temp;
+        substitui(pos, leitura(temp, e->linha));
+        **antes = cmd_atrib((char*)temp, e);
+        (**antes)->linha = e->linha;
+        *antes = &(**antes)->prox;
+        s->marca = mistura(mistura(mistura(s->marca, ordem), i->acao), hash_nome(temp));
+    }
+}
+
+static void reescreve_exprs(Subexpressoes* s, Expr** pos, Comando*** antes) {
+    for (; *pos != NULL; pos = &(*pos)->prox) reescreve(s, pos, antes);
+}
+
+// Reescreve os comandos a partir de *pos; fora de uma lista (o ramo de um
+// if, o corpo de um while), o comando que ganha atribuições antes dele
+// vira um composto com elas
+static void reescreve_cmds(Subexpressoes* s, Comando** pos, int lista) {
+    for (; *pos != NULL; pos = &(*pos)->prox) {
+        Comando *c = *pos, *antes = NULL, **fim = &antes;
+        switch (c->tipo) {
+            case CMD_ATRIB:
+                reescreve(s, &c->u.atrib.expr, &fim);
+                break;
+            case CMD_IF:
+                reescreve(s, &c->u.cond.cond, &fim);
+                reescreve_cmds(s, &c->u.cond.then_cmd, 0);
+                reescreve_cmds(s, &c->u.cond.else_cmd, 0);
+                break;
+            case CMD_WHILE:
+                reescreve(s, &c->u.loop.cond, &fim);
+                reescreve_cmds(s, &c->u.loop.body, 0);
+                break;
+            case CMD_WRITE:
+                reescreve_exprs(s, &c->u.escrita.lista_exp, &fim);
+                break;
+            case CMD_CALL_PROC:
+                reescreve_exprs(s, &c->u.proc_call.args_lista, &fim);
+                break;
+            case CMD_COMPOSTO:
+                reescreve_cmds(s, &c->u.composto->comandos, 1);
+                break;
+            case CMD_READ:
+                break;
+        }
+        if (antes == NULL) continue;
+
+        if (lista) {
+            *pos = antes;
+            *fim = c;
+            pos = fim;
+        } else {
+            Comando *novo = composto(antes, c->linha);
+            novo->prox = c->prox;
+            c->prox = NULL;
+            *fim = c;
+            *pos = novo;
+        }
+    }
+}
+
+// ======================================================================
+// BLOCOS
+// ======================================================================
+
+// As definições que compensam viram temporárias do bloco
+static void temporarias(Subexpressoes* s) {
+    int num = 0;
+    for (int d = 0; d < s->num_defs; d++) {
+        Definicao *def = &s->defs[d];
+        if (def->economia <= CUSTO_TEMPORARIA) continue;
+
+        char nome[32];
+        snprintf(nome, sizeof(nome), "#%d", ++num);
+        Decl *nova = decl_var(adiciona_id(NULL, nome), def->tipo);
+        nova->linha = def->e->linha;
+        s->bloco->decls_var = adiciona_decl(s->bloco->decls_var, nova);
+        def->temp = nova->u.var.ids->nome;
+    }
+    s->total.temporarias += num;
+}
+
+static void reaproveita_bloco(Subexpressoes* s, Decl* subrot, Bloco* b) {
+    s->bloco = b;
+    s->geracao++;
+    s->num_vars = s->num_globais;
+    free(s->locais.itens);
+    nomes_inicia(&s->locais);
+    if (subrot != NULL) {
+        for (const ParamDecl *p = subrot->u.subrot.params; p != NULL; p = p->prox)
+            for (const IdList *id = p->ids; id != NULL; id = id->prox)
+                declara(s, &s->locais, id, p->tipo_param);
+        declara_vars(s, &s->locais, b->decls_var);
+    }
+
+    s->num_valores = 0;
+    novo_valor(s);          // O 0 é "sem número"
+    s->num_chaves = s->num_infos = 0;
+    if (s->chaves != NULL) memset(s->chaves, 0, s->cap_chaves * sizeof(Chave));
+    free(s->infos);
+    s->infos = NULL;
+    s->cap_infos = 0;
+    s->num_defs = s->num_detentoras = s->num_pilha = s->num_trocas = 0;
+    s->selo = se_calloc(s->num_vars, sizeof(int));
+    s->final = se_calloc(s->num_vars, sizeof(int));
+    s->num_selos = 0;
+
+    numera_cmds(s, b->comandos);
+    temporarias(s);
+
+    s->ordem = 0;
+    s->marca = 0;
+    reescreve_cmds(s, &b->comandos, 1);
+    b->subexpressoes = s->marca;
+
+    free(s->selo);
+    free(s->final);
+}
+
+ReaproveitamentoSubexpressoes reaproveita_subexpressoes(Programa* p) {
+    Subexpressoes s = { .prog = p };
+    Bloco *b = p->bloco_principal;
+
+    nomes_inicia(&s.globais);
+    declara_vars(&s, &s.globais, b->decls_var);
+    s.num_globais = s.num_vars;
+
+    for (Decl *d = b->decls_subrotinas; d != NULL; d = d->prox)
+        if (!d->morta) reaproveita_bloco(&s, d, d->u.subrot.bloco);
+    reaproveita_bloco(&s, NULL, b);
+
+    if (s.grafo != NULL) {
+        for (int k = 0; k < grafo_num_nos(s.grafo); k++) free(s.escritas[k]);
+        free(s.escritas);
+        grafo_libera(s.grafo);
+    }
+    free(s.globais.itens);
+    free(s.locais.itens);
+    free(s.vars);
+    free(s.valores);
+    free(s.chaves);
+    free(s.infos);
+    free(s.defs);
+    free(s.detentoras);
+    free(s.pilha);
+    free(s.trocas);
+    return s.total;
+}
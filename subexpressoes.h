@@ -0,0 +1,53 @@
+#ifndef SUBEXPRESSOES_H
+#define SUBEXPRESSOES_H
+
+#include "ast.h"
+
+// Reaproveitamento de subexpressões comuns, feito na AST depois do
+// desenrolamento e antes do compartilhamento de posições. Cada sub-rotina
+// (e o principal) é numerada por valores: uma variável tem o número do
+// valor que guarda no ponto do programa, e uma expressão + - * div, de
+// comparação ou lógica, bem tipada, recebe o número associado ao operador
+// e aos números dos operandos (hash-consing; nas operações comutativas os
+// operandos são ordenados, e `a > b` é `b < a`). Duas expressões com o
+// mesmo número calculam o mesmo valor.
+//
+// Uma atribuição `x := e` dá a `x` o número de `e`; `read`, e as chamadas
+// que podem escrever uma global (grafo_chamadas.h), dão números novos às
+// variáveis que mudam. A numeração atravessa os comandos: o que é
+// calculado antes de um if vale nos dois ramos e depois dele, e o que um
+// ramo calcula vale só nele; na junção, uma variável fica com o número
+// dos dois ramos se for o mesmo, ou com um novo. Num while, as variáveis
+// que o laço pode mudar recebem números novos já no teste, e o que o
+// corpo calcula não sai dele.
+//
+// Quando um cálculo se repete, ele passa a ler o valor já calculado:
+//
+//   - de uma variável que ainda tem aquele número (`x := a * b + c; ...
+//     y := a * b + c` vira `y := x`), sem custo;
+//   - ou de uma temporária: o primeiro cálculo é feito antes do comando,
+//     `#1 := e`, e ele e os seguintes leem `#1`. A temporária custa uma
+//     gravação e uma leitura, então só é criada quando as repetições
+//     economizam mais do que isso (CUSTO_TEMPORARIA), medido em instruções
+//     de cada cálculo trocado; sozinho, `a * b + a * b` não compensa.
+//
+// O primeiro cálculo só sai do comando se este não tem chamadas (que
+// poderiam vir antes dele e mudar um operando) e não é o teste de um
+// while; de um item de write depois do primeiro, só se não divide (a
+// divisão por zero viria antes dos itens anteriores). Uma repetição pode
+// estar em qualquer comando. As temporárias são locais (globais no
+// principal) com nomes que não são identificadores. Como nas demais
+// etapas da AST, nada disso se aplica a --fluxo, e uma marca do que foi
+// trocado entra em Bloco.subexpressoes, e daí na chave do cache.
+
+#define CUSTO_TEMPORARIA 2      // Instruções: a gravação e a leitura da temporária
+
+typedef struct {
+    int variaveis;      // Cálculos trocados pela leitura de uma variável
+    int repeticoes;     // Cálculos trocados pela leitura de uma temporária
+    int temporarias;
+} ReaproveitamentoSubexpressoes;
+
+ReaproveitamentoSubexpressoes reaproveita_subexpressoes(Programa* p);
+
+#endif
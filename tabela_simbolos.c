@@ -0,0 +1,175 @@
+#include "tabela_simbolos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define BALDES_GLOBAL 211
+#define BALDES_LOCAL  31
+
+static void* ts_malloc(size_t size) {
+    void *ptr = calloc(1, size);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para a tabela de símbolos");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static unsigned hash_nome(const char* s) {
+    unsigned h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+// ======================================================================
+// ESCOPOS
+// ======================================================================
+
+static Escopo* escopo_cria(int num_baldes, Simbolo* dono) {
+    Escopo *e = ts_malloc(sizeof(Escopo));
+    e->baldes = ts_malloc(num_baldes * sizeof(Simbolo*));
+    e->num_baldes = num_baldes;
+    e->num_simbolos = 0;
+    e->prox_deslocamento = 0;
+    e->dono = dono;
+    return e;
+}
+
+// Dobra o número de baldes quando a carga passa de 2 símbolos por balde,
+// para que programas com milhares de sub-rotinas não tenham cadeias longas
+// no escopo global. Só é chamada ao instalar, o que nunca acontece no
+// global durante a análise em paralelo dos corpos.
+static void escopo_cresce(Escopo* e) {
+    int n = 2 * e->num_baldes + 1;
+    Simbolo **baldes = ts_malloc(n * sizeof(Simbolo*));
+    for (int i = 0; i < e->num_baldes; i++) {
+        Simbolo *s = e->baldes[i];
+        while (s != NULL) {
+            Simbolo *prox = s->prox;
+            unsigned h = hash_nome(s->nome) % n;
+            s->prox = baldes[h];
+            baldes[h] = s;
+            s = prox;
+        }
+    }
+    free(e->baldes);
+    e->baldes = baldes;
+    e->num_baldes = n;
+}
+
+static void simbolo_libera(Simbolo* s) {
+    cmd_free(s->corpo);
+    free(s->nome);
+    free(s->tipos_params);
+    free(s);
+}
+
+static void escopo_libera(Escopo* e) {
+    if (e == NULL) return;
+
+    for (int i = 0; i < e->num_baldes; i++) {
+        Simbolo *s = e->baldes[i];
+        while (s != NULL) {
+            Simbolo *prox = s->prox;
+            // O escopo local pertence à sub-rotina instalada no global
+            if (s->escopo != NULL) escopo_libera(s->escopo);
+            simbolo_libera(s);
+            s = prox;
+        }
+    }
+    free(e->baldes);
+    free(e);
+}
+
+Simbolo* ts_busca_escopo(Escopo* e, const char* nome) {
+    if (e == NULL) return NULL;
+
+    Simbolo *s = e->baldes[hash_nome(nome) % e->num_baldes];
+    while (s != NULL) {
+        if (strcmp(s->nome, nome) == 0) return s;
+        s = s->prox;
+    }
+    return NULL;
+}
+
+// ======================================================================
+// TABELA
+// ======================================================================
+
+TabelaSimbolos* ts_cria(void) {
+    TabelaSimbolos *ts = ts_malloc(sizeof(TabelaSimbolos));
+    ts->global = escopo_cria(BALDES_GLOBAL, NULL);
+    ts->local = NULL;
+    ts->visiveis = INT_MAX;
+    return ts;
+}
+
+TabelaSimbolos ts_visao(const TabelaSimbolos* ts, const Simbolo* ultimo) {
+    TabelaSimbolos v = { ts->global, NULL, ultimo->ordem };
+    return v;
+}
+
+void ts_libera(TabelaSimbolos* ts) {
+    if (ts == NULL) return;
+    escopo_libera(ts->global);
+    free(ts);
+}
+
+void ts_abre_local(TabelaSimbolos* ts, Simbolo* subrot) {
+    if (subrot->escopo == NULL)
+        subrot->escopo = escopo_cria(BALDES_LOCAL, subrot);
+    ts->local = subrot->escopo;
+}
+
+void ts_fecha_local(TabelaSimbolos* ts) {
+    ts->local = NULL;
+}
+
+Simbolo* ts_instala(TabelaSimbolos* ts, const char* nome, CategoriaSimbolo cat, TipoSemantico tipo) {
+    Escopo *e = ts->local ? ts->local : ts->global;
+
+    if (ts_busca_escopo(e, nome) != NULL) return NULL;
+
+    Simbolo *s = ts_malloc(sizeof(Simbolo));
+    s->nome = strdup(nome);
+    s->categoria = cat;
+    s->tipo = tipo;
+    s->nivel = ts->local ? NIVEL_LOCAL : NIVEL_GLOBAL;
+    s->ordem = e->num_simbolos;
+    s->rotulo = -1;
+
+    // Variáveis recebem a próxima posição livre do escopo; o deslocamento
+    // (negativo) dos parâmetros só é conhecido após contá-los todos.
+    if (cat == CAT_VARIAVEL) s->deslocamento = e->prox_deslocamento++;
+
+    if (e->num_simbolos >= 2 * e->num_baldes) escopo_cresce(e);
+    unsigned h = hash_nome(nome) % e->num_baldes;
+    s->prox = e->baldes[h];
+    e->baldes[h] = s;
+    e->num_simbolos++;
+    return s;
+}
+
+Simbolo* ts_busca(TabelaSimbolos* ts, const char* nome) {
+    Simbolo *s = ts_busca_escopo(ts->local, nome);
+    if (s != NULL) return s;
+    s = ts_busca_escopo(ts->global, nome);
+    return s != NULL && s->ordem <= ts->visiveis ? s : NULL;
+}
+
+int ts_deslocamento_retorno(const Simbolo* funcao) {
+    // Registro de ativação: [retorno][params...][end. retorno][base antiga][locais...]
+    return -(funcao->num_params + 3);
+}
+
+const char* categoria_to_string(CategoriaSimbolo cat) {
+    switch (cat) {
+        case CAT_PROGRAMA: return "programa";
+        case CAT_VARIAVEL: return "variável";
+        case CAT_PARAMETRO: return "parâmetro";
+        case CAT_PROCEDIMENTO: return "procedimento";
+        case CAT_FUNCAO: return "função";
+        default: return "desconhecida";
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef TABELA_SIMBOLOS_H
+#define TABELA_SIMBOLOS_H
+
+#include "ast.h"
+
+// ----------------------------------------------------------------------
+// 1. Símbolos
+// ----------------------------------------------------------------------
+
+typedef enum {
+    CAT_PROGRAMA,
+    CAT_VARIAVEL,
+    CAT_PARAMETRO,
+    CAT_PROCEDIMENTO,
+    CAT_FUNCAO
+} CategoriaSimbolo;
+
+// Rascal não permite sub-rotinas aninhadas (bloco_subrot não possui
+// seção de sub-rotinas), portanto existem exatamente dois níveis léxicos.
+typedef enum {
+    NIVEL_GLOBAL = 0,
+    NIVEL_LOCAL = 1
+} NivelEscopo;
+
+typedef struct Escopo Escopo;
+
+typedef struct Simbolo {
+    char* nome;
+    CategoriaSimbolo categoria;
+    TipoSemantico tipo;       // Variável/parâmetro: seu tipo; função: tipo de retorno
+    NivelEscopo nivel;
+    int deslocamento;         // Global: endereço absoluto; local: relativo à base do registro
+    int ordem;                // Posição de instalação no escopo (0, 1, ...)
+
+    // Apenas para sub-rotinas
+    int rotulo;               // Rótulo MEPA do ponto de entrada
+    int num_params;
+    TipoSemantico* tipos_params;
+    int num_locais;           // Variáveis locais (AMEM do registro de ativação)
+    int pilha_max;            // Profundidade máxima de operandos no corpo
+    int pilha_total;          // Posições do registro mais as chamadas feitas (-1: recursão)
+    Escopo* escopo;           // Escopo local (mantido para as fases seguintes)
+    Decl* decl;
+    int pura;                 // Sem efeitos: pode ser avaliada na compilação (avaliacao_parcial.h)
+    uint64_t hash_avaliacao;  // Pura: hash do corpo e dos corpos que ele pode chamar
+    Comando* corpo;           // Pura: os comandos, tirados da declaração ao fim da compilação
+    int morta;                // Eliminada (eliminacao.h): variável sem posição, sub-rotina sem código
+
+    struct Simbolo* prox;     // Encadeamento no balde da tabela hash
+} Simbolo;
+
+// ----------------------------------------------------------------------
+// 2. Escopos e Tabela
+// ----------------------------------------------------------------------
+
+struct Escopo {
+    Simbolo** baldes;
+    int num_baldes;
+    int num_simbolos;
+    int prox_deslocamento;    // Próxima posição livre para variáveis
+    Simbolo* dono;            // Sub-rotina dona do escopo (NULL no global)
+};
+
+typedef struct {
+    Escopo* global;
+    Escopo* local;            // Escopo da sub-rotina corrente (NULL no corpo principal)
+    int visiveis;             // Globais de ordem maior que esta não são achadas por ts_busca
+} TabelaSimbolos;
+
+TabelaSimbolos* ts_cria(void);
+void ts_libera(TabelaSimbolos* ts);
+
+// Visão da tabela `ts` que só acha as globais instaladas até `ultimo`
+// (inclusive), como se as seguintes ainda não existissem. Compartilha os
+// escopos com `ts` e tem o seu próprio escopo local corrente, então cada
+// thread da compilação em paralelo usa a sua.
+TabelaSimbolos ts_visao(const TabelaSimbolos* ts, const Simbolo* ultimo);
+
+// Abre o escopo local de uma sub-rotina (criando-o na primeira vez)
+void ts_abre_local(TabelaSimbolos* ts, Simbolo* subrot);
+void ts_fecha_local(TabelaSimbolos* ts);
+
+// Instala no escopo corrente; retorna NULL se o nome já existe nele
+Simbolo* ts_instala(TabelaSimbolos* ts, const char* nome, CategoriaSimbolo cat, TipoSemantico tipo);
+
+Simbolo* ts_busca(TabelaSimbolos* ts, const char* nome);
+Simbolo* ts_busca_escopo(Escopo* e, const char* nome);
+
+// Deslocamento da posição de retorno de uma função (abaixo dos parâmetros)
+int ts_deslocamento_retorno(const Simbolo* funcao);
+
+const char* categoria_to_string(CategoriaSimbolo cat);
+
+#endif
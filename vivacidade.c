@@ -0,0 +1,347 @@
+#include "vivacidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* vi_calloc(size_t n, size_t tam) {
+    void *ptr = calloc(n > 0 ? n : 1, tam);
+    if (ptr == NULL) {
+        perror("Erro ao alocar memória para o compartilhamento de posições");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// ======================================================================
+// NOMES
+// ======================================================================
+
+// Um parâmetro (indice -1) ou uma local; só as locais com posição têm
+// índice, na ordem de declaração
+typedef struct {
+    const char* nome;
+    int indice;
+} Nome;
+
+typedef struct {
+    Nome* itens;        // Endereçamento aberto, com a primeira declaração de cada nome
+    int cap;
+    IdList** locais;    // Por índice
+    int num_locais;
+    int palavras;       // uint64_t por conjunto de locais
+    uint64_t* interf;   // Matriz de interferência, uma linha por local
+} Vivacidade;
+
+static unsigned hash_nome(const char* s) {
+    unsigned h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+// Declara `nome`; 0 se já foi declarado (a declaração é ignorada)
+static int declara(Vivacidade* v, const char* nome, int indice) {
+    unsigned k = hash_nome(nome) & (v->cap - 1);
+    for (; v->itens[k].nome != NULL; k = (k + 1) & (v->cap - 1))
+        if (strcmp(v->itens[k].nome, nome) == 0) return 0;
+    v->itens[k].nome = nome;
+    v->itens[k].indice = indice;
+    return 1;
+}
+
+// Índice da local `nome` (-1: parâmetro, global ou sub-rotina)
+static int indice(const Vivacidade* v, const char* nome) {
+    for (unsigned k = hash_nome(nome) & (v->cap - 1); v->itens[k].nome != NULL; k = (k + 1) & (v->cap - 1))
+        if (strcmp(v->itens[k].nome, nome) == 0) return v->itens[k].indice;
+    return -1;
+}
+
+// ======================================================================
+// CONJUNTOS
+// ======================================================================
+
+static uint64_t* conj_novo(const Vivacidade* v) {
+    return vi_calloc(v->palavras, sizeof(uint64_t));
+}
+
+static uint64_t* conj_copia(const Vivacidade* v, const uint64_t* c) {
+    uint64_t *n = conj_novo(v);
+    memcpy(n, c, v->palavras * sizeof(uint64_t));
+    return n;
+}
+
+static void conj_poe(uint64_t* c, int k) {
+    c[k / 64] |= (uint64_t)1 << (k % 64);
+}
+
+static void conj_tira(uint64_t* c, int k) {
+    c[k / 64] &= ~((uint64_t)1 << (k % 64));
+}
+
+static int conj_tem(const uint64_t* c, int k) {
+    return (c[k / 64] >> (k % 64)) & 1;
+}
+
+// ======================================================================
+// VIVACIDADE
+// ======================================================================
+
+// Acrescenta a `c` as locais lidas pelas expressões da lista `e`
+static void usos(const Vivacidade* v, const Expr* e, uint64_t* c) {
+    for (; e != NULL; e = e->prox) {
+        switch (e->tipo) {
+            case EXPR_NUM:
+            case EXPR_BOOL:
+                break;
+            case EXPR_VAR: {
+                int x = indice(v, e->u.id);
+                if (x >= 0) conj_poe(c, x);
+            } break;
+            case EXPR_CALL_FUNC:
+                usos(v, e->u.func.args_lista, c);
+                break;
+            case EXPR_BIN:
+                usos(v, e->u.bin.esq, c);
+                usos(v, e->u.bin.dir, c);
+                break;
+            case EXPR_UN:
+                usos(v, e->u.un.arg, c);
+                break;
+        }
+    }
+}
+
+static void resume_cmds(const Vivacidade* v, const Comando* c, uint64_t* lidas, uint64_t* atribuidas);
+
+// Resumo de um comando: as locais que ele pode ler antes de atribuir e as
+// que ele atribui em todos os caminhos
+static void resume(const Vivacidade* v, const Comando* c, uint64_t* lidas, uint64_t* atribuidas) {
+    switch (c->tipo) {
+        case CMD_ATRIB: {
+            usos(v, c->u.atrib.expr, lidas);
+            int x = indice(v, c->u.atrib.nome_var);
+            if (x >= 0) conj_poe(atribuidas, x);
+        } break;
+
+        case CMD_READ:
+            for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox) {
+                int x = indice(v, id->nome);
+                if (x >= 0) conj_poe(atribuidas, x);
+            }
+            break;
+
+        case CMD_WRITE:
+            usos(v, c->u.escrita.lista_exp, lidas);
+            break;
+
+        case CMD_CALL_PROC:
+            usos(v, c->u.proc_call.args_lista, lidas);
+            break;
+
+        case CMD_IF: {
+            uint64_t *at = conj_novo(v), *ae = conj_novo(v);
+            usos(v, c->u.cond.cond, lidas);
+            resume_cmds(v, c->u.cond.then_cmd, lidas, at);
+            resume_cmds(v, c->u.cond.else_cmd, lidas, ae);
+            for (int k = 0; k < v->palavras; k++) atribuidas[k] |= at[k] & ae[k];
+            free(at);
+            free(ae);
+        } break;
+
+        case CMD_WHILE: {
+            // O corpo pode não executar: não atribui nada com certeza
+            uint64_t *a = conj_novo(v);
+            usos(v, c->u.loop.cond, lidas);
+            resume_cmds(v, c->u.loop.body, lidas, a);
+            free(a);
+        } break;
+
+        case CMD_COMPOSTO:
+            resume_cmds(v, c->u.composto->comandos, lidas, atribuidas);
+            break;
+    }
+}
+
+// O mesmo para uma sequência: lê o que cada comando lê e os anteriores
+// não atribuíram
+static void resume_cmds(const Vivacidade* v, const Comando* c, uint64_t* lidas, uint64_t* atribuidas) {
+    uint64_t *l = conj_novo(v), *a = conj_copia(v, atribuidas);
+    for (; c != NULL; c = c->prox) {
+        memset(l, 0, v->palavras * sizeof(uint64_t));
+        resume(v, c, l, a);
+        for (int k = 0; k < v->palavras; k++) lidas[k] |= l[k] & ~atribuidas[k];
+        memcpy(atribuidas, a, v->palavras * sizeof(uint64_t));
+    }
+    free(l);
+    free(a);
+}
+
+// A local `x` é escrita onde as de `vivas` estão vivas
+static void interfere(Vivacidade* v, int x, const uint64_t* vivas) {
+    uint64_t *linha = &v->interf[(size_t)x * v->palavras];
+    for (int k = 0; k < v->palavras; k++) linha[k] |= vivas[k];
+    for (int y = 0; y < v->num_locais; y++)
+        if (conj_tem(vivas, y)) conj_poe(&v->interf[(size_t)y * v->palavras], x);
+}
+
+static void percorre_cmds(Vivacidade* v, Comando* c, uint64_t* vivas);
+
+// Recebe em `vivas` o que está vivo depois de `c` e deixa o que está vivo
+// antes, registrando as interferências das atribuições
+static void percorre(Vivacidade* v, Comando* c, uint64_t* vivas) {
+    switch (c->tipo) {
+        case CMD_ATRIB: {
+            int x = indice(v, c->u.atrib.nome_var);
+            if (x >= 0) {
+                interfere(v, x, vivas);
+                conj_tira(vivas, x);
+            }
+            usos(v, c->u.atrib.expr, vivas);
+        } break;
+
+        case CMD_READ:
+            for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox) {
+                int x = indice(v, id->nome);
+                if (x >= 0) interfere(v, x, vivas);
+            }
+            for (const IdList *id = c->u.leitura.lista_id; id != NULL; id = id->prox) {
+                int x = indice(v, id->nome);
+                if (x >= 0) conj_tira(vivas, x);
+            }
+            break;
+
+        case CMD_WRITE:
+            usos(v, c->u.escrita.lista_exp, vivas);
+            break;
+
+        case CMD_CALL_PROC:
+            usos(v, c->u.proc_call.args_lista, vivas);
+            break;
+
+        case CMD_IF: {
+            uint64_t *senao = conj_copia(v, vivas);
+            percorre_cmds(v, c->u.cond.then_cmd, vivas);
+            percorre_cmds(v, c->u.cond.else_cmd, senao);
+            for (int k = 0; k < v->palavras; k++) vivas[k] |= senao[k];
+            usos(v, c->u.cond.cond, vivas);
+            free(senao);
+        } break;
+
+        case CMD_WHILE: {
+            // Vivo no teste: o que está vivo depois do laço e o que o teste
+            // e o corpo leem antes de atribuir; é também o que está vivo
+            // no fim do corpo
+            uint64_t *a = conj_novo(v);
+            usos(v, c->u.loop.cond, vivas);
+            resume_cmds(v, c->u.loop.body, vivas, a);
+            uint64_t *corpo = conj_copia(v, vivas);
+            percorre_cmds(v, c->u.loop.body, corpo);
+            free(corpo);
+            free(a);
+        } break;
+
+        case CMD_COMPOSTO:
+            percorre_cmds(v, c->u.composto->comandos, vivas);
+            break;
+    }
+}
+
+static void percorre_cmds(Vivacidade* v, Comando* c, uint64_t* vivas) {
+    int n = 0;
+    for (Comando *k = c; k != NULL; k = k->prox) n++;
+    if (n == 0) return;
+
+    Comando **cmds = vi_calloc(n, sizeof(Comando*));
+    n = 0;
+    for (; c != NULL; c = c->prox) cmds[n++] = c;
+    while (n > 0) percorre(v, cmds[--n], vivas);
+    free(cmds);
+}
+
+// ======================================================================
+// ALOCAÇÃO
+// ======================================================================
+
+// Cor de cada local: a menor posição que nenhuma vizinha já colorida usa;
+// retorna o número de posições
+static int colore(const Vivacidade* v, int* cor) {
+    int posicoes = 0;
+    char *ocupada = vi_calloc(v->num_locais, 1);
+    for (int x = 0; x < v->num_locais; x++) {
+        memset(ocupada, 0, v->num_locais);
+        const uint64_t *linha = &v->interf[(size_t)x * v->palavras];
+        for (int y = 0; y < x; y++)
+            if (conj_tem(linha, y)) ocupada[cor[y]] = 1;
+        cor[x] = 0;
+        while (ocupada[cor[x]]) cor[x]++;
+        if (cor[x] + 1 > posicoes) posicoes = cor[x] + 1;
+    }
+    free(ocupada);
+    return posicoes;
+}
+
+static void compartilha_subrotina(Decl* d, CompartilhamentoPosicoes* total) {
+    Bloco *b = d->u.subrot.bloco;
+    Vivacidade v = { .num_locais = 0 };
+
+    int nomes = 0;
+    for (ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox)
+        for (IdList *id = p->ids; id != NULL; id = id->prox) nomes++;
+    for (Decl *dv = b->decls_var; dv != NULL; dv = dv->prox)
+        for (IdList *id = dv->u.var.ids; id != NULL; id = id->prox) nomes++;
+    for (v.cap = 16; v.cap < 2 * nomes; v.cap *= 2) {}
+    v.itens = vi_calloc(v.cap, sizeof(Nome));
+    v.locais = vi_calloc(nomes, sizeof(IdList*));
+
+    // Parâmetros antes das locais, como na instalação
+    for (ParamDecl *p = d->u.subrot.params; p != NULL; p = p->prox)
+        for (IdList *id = p->ids; id != NULL; id = id->prox) declara(&v, id->nome, -1);
+    for (Decl *dv = b->decls_var; dv != NULL; dv = dv->prox) {
+        for (IdList *id = dv->u.var.ids; id != NULL; id = id->prox) {
+            if (!declara(&v, id->nome, id->morta ? -1 : v.num_locais) || id->morta) continue;
+            v.locais[v.num_locais++] = id;
+        }
+    }
+
+    if (v.num_locais > 0) {
+        v.palavras = (v.num_locais + 63) / 64;
+        v.interf = vi_calloc((size_t)v.num_locais * v.palavras, sizeof(uint64_t));
+
+        uint64_t *vivas = conj_novo(&v);
+        percorre_cmds(&v, b->comandos, vivas);
+
+        // As lidas antes de atribuídas interferem com todas as outras
+        uint64_t *todas = conj_novo(&v);
+        for (int x = 0; x < v.num_locais; x++) conj_poe(todas, x);
+        for (int x = 0; x < v.num_locais; x++)
+            if (conj_tem(vivas, x)) interfere(&v, x, todas);
+
+        int *cor = vi_calloc(v.num_locais, sizeof(int));
+        int posicoes = colore(&v, cor);
+        for (int x = 0; x < v.num_locais; x++) v.locais[x]->posicao = cor[x];
+
+        total->antes += v.num_locais;
+        total->depois += posicoes;
+        if (posicoes < v.num_locais) total->subrotinas++;
+        if (v.num_locais > total->maior_antes) total->maior_antes = v.num_locais;
+        if (posicoes > total->maior_depois) total->maior_depois = posicoes;
+
+        free(cor);
+        free(todas);
+        free(vivas);
+        free(v.interf);
+    }
+
+    free(v.locais);
+    free(v.itens);
+}
+
+// ======================================================================
+// ENTRADA
+// ======================================================================
+
+CompartilhamentoPosicoes compartilha_posicoes(Programa* p) {
+    CompartilhamentoPosicoes total = { 0, 0, 0, 0, 0 };
+    for (Decl *d = p->bloco_principal->decls_subrotinas; d != NULL; d = d->prox)
+        if (!d->morta) compartilha_subrotina(d, &total);
+    return total;
+}
@@ -0,0 +1,40 @@
+#ifndef VIVACIDADE_H
+#define VIVACIDADE_H
+
+#include "ast.h"
+
+// Compartilhamento de posições no registro de ativação, feito na AST
+// depois da eliminação de código morto e antes da análise semântica. Uma
+// análise de vivacidade sobre o corpo de cada sub-rotina diz em que
+// pontos cada local ainda pode ser lida; duas locais interferem se uma é
+// atribuída (ou lida por read) onde a outra está viva, e as que não
+// interferem recebem a mesma posição (coloração gulosa, na ordem de
+// declaração). A posição fica em IdList.posicao e é a que a análise dá à
+// variável; o AMEM da sub-rotina passa a ser o número de posições.
+//
+// Uma local que pode ser lida antes de atribuída (viva na entrada) fica
+// com uma posição só dela, para que o valor lido continue sendo o que
+// estava na pilha e não o de outra variável. Parâmetros, globais e as
+// locais eliminadas (sem posição) não entram; o programa principal também
+// não, já que as suas variáveis são globais.
+//
+// Como o if e o while da linguagem são estruturados, a vivacidade sai de
+// um percurso de trás para frente, sem iterar até um ponto fixo: no
+// while, o que está vivo no teste é o que está vivo depois dele, mais o
+// que o teste e o corpo leem antes de atribuir. Os nomes são resolvidos
+// como na análise (locais e parâmetros escondem as globais; num nome
+// declarado duas vezes vale a primeira declaração).
+//
+// Precisa das declarações das locais antes do corpo, mas não do programa
+// inteiro; como a eliminação, não se aplica a --fluxo.
+
+typedef struct {
+    int subrotinas;     // Com o registro reduzido
+    int antes, depois;  // Posições de locais, somadas nas sub-rotinas
+    int maior_antes;    // O maior número de posições de locais de uma sub-rotina
+    int maior_depois;
+} CompartilhamentoPosicoes;
+
+CompartilhamentoPosicoes compartilha_posicoes(Programa* p);
+
+#endif